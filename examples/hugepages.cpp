@@ -46,4 +46,10 @@ int main(int argc, char** argv){
 	if ( mapped ) mm::unmap_hp();
 	do_something(csa); // after it is unmapped 
 	util::clear(csa);
+
+	mm::set_policy(MM_HUGEPAGE); // allocate the int_vectors directly in hugepages
+	construct_csa(string(argv[1]), csa);
+	mm::set_policy(MM_MALLOC);
+	do_something(csa); // constructed in hugepages
+	util::clear(csa);
 }
@@ -0,0 +1,36 @@
+#include <sdsl/csa_wt.hpp>
+#include <sdsl/wavelet_trees.hpp>
+#include <string>
+#include <iostream>
+
+using namespace sdsl;
+using namespace std;
+
+int main(int argc, char **argv){
+	if( argc <  2 ){
+		cout << "Usage " << argv[0] << " text_file" << endl;
+		cout << "      This program constructs an FM-index and stores it in" << endl;
+		cout << "      an aligned file. Later runs map the index into memory" << endl;
+		cout << "      instead of copying it. Processes which map the same" << endl;
+		cout << "      index share the page cache." << endl;
+		return 1;
+	}
+	string index_file   = string(argv[1])+".fm9mm";
+	csa_wt<wt_huff<rrr_vector<255> >, 512, 1024> fm_index;
+
+	stop_watch sw;
+	sw.start();
+	if( !util::load_from_mmap_file(fm_index, index_file.c_str()) ){
+		cout << "No index "<<index_file<< " located. Building index now." << endl;
+		construct_csa(argv[1], fm_index); // generate index
+		util::store_to_mmap_file(fm_index, index_file.c_str()); // save it with aligned payloads
+	}
+	sw.stop();
+	cout << "Index is ready after " << sw.get_real_time() << " ms." << endl;
+	cout << "Index requires " << util::get_size_in_mega_bytes(fm_index) << " MiB." << endl;
+	string query;
+	while ( getline(cin, query) ){
+		size_t occs = algorithm::count(fm_index, (const unsigned char*)query.c_str(), query.size());
+		cout << "# of occurrences: " << occs << endl;
+	}
+}
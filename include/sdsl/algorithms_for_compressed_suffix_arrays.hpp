@@ -23,6 +23,7 @@
 
 #include "int_vector.hpp" // for bit_vector
 #include <stack> // for calculate_supercartesian_tree_bp
+#include <utility> // for std::pair
 
 #ifdef SDSL_DEBUG_ALGORITHMS_FOR_COMPRESSED_SUFFIX_ARRAYS
 #include "testutils.hpp"
@@ -142,39 +143,80 @@ bool char_occures_in_text_of_csa(const Csa& csa, typename Csa::char_type c)
     return (csa.char2comp[c] > 0) or (csa.char2comp[c]==c);
 }
 
+// The SA samples of csa_uncompressed are stored in an int_vector, the SA samples of csa_wt
+// and csa_sada in a class of csa_sampling.hpp, which is filled by init, add and finish.
 template<class Csa, uint8_t int_width, class size_type_class>
-void set_sa_and_isa_samples(int_vector_file_buffer<int_width, size_type_class>& sa_buf, typename Csa::sa_sample_type& sa_sample, typename Csa::isa_sample_type& isa_sample)
+void sa_sample_init(int_vector<int_width, size_type_class>& sa_sample, int_vector<>::size_type n, const int_vector<>*)
+{
+    sa_sample.set_int_width(bit_magic::l1BP(n)+1);
+    util::check_int_width(sa_sample, n-(n>0), "sa_sample");
+    sa_sample.resize((n+Csa::sa_sample_dens-1)/Csa::sa_sample_dens);
+    util::set_one_bits(sa_sample);
+}
+
+template<class Csa, class SaSample>
+void sa_sample_init(SaSample& sa_sample, int_vector<>::size_type n, const int_vector<>* weights)
+{
+    sa_sample.init(n, weights);
+}
+
+template<class Csa, uint8_t int_width, class size_type_class>
+void sa_sample_add(int_vector<int_width, size_type_class>& sa_sample, int_vector<>::size_type i, int_vector<>::size_type sa)
+{
+    if ((i % Csa::sa_sample_dens) == 0) {
+        sa_sample[i/Csa::sa_sample_dens] = sa;
+    }
+}
+
+template<class Csa, class SaSample>
+void sa_sample_add(SaSample& sa_sample, int_vector<>::size_type i, int_vector<>::size_type sa)
+{
+    sa_sample.add(i, sa);
+}
+
+template<class Csa, uint8_t int_width, class size_type_class>
+void sa_sample_finish(int_vector<int_width, size_type_class>&) {}
+
+template<class Csa, class SaSample>
+void sa_sample_finish(SaSample& sa_sample)
+{
+    sa_sample.finish();
+}
+
+//! Calculates the SA and ISA samples of a CSA from the suffix array.
+/*! \param weights If not NULL, the weights of the text positions, which are passed to the SA samples (see weighted_sa_sample).
+ */
+template<class Csa, uint8_t int_width, class size_type_class>
+void set_sa_and_isa_samples(int_vector_file_buffer<int_width, size_type_class>& sa_buf, typename Csa::sa_sample_type& sa_sample, typename Csa::isa_sample_type& isa_sample,
+                            const int_vector<>* weights=NULL)
 {
     typedef typename Csa::size_type size_type;
     size_type  n = sa_buf.int_vector_size;
 
-    sa_sample.set_int_width(bit_magic::l1BP(n)+1);
-    sa_sample.resize((n+Csa::sa_sample_dens-1)/Csa::sa_sample_dens);
+    sa_sample_init<Csa>(sa_sample, n, weights);
 
     isa_sample.set_int_width(bit_magic::l1BP(n)+1);
+    util::check_int_width(isa_sample, n-(n>0), "isa_sample");
     if (n >= 1) { // so n+Csa::isa_sample_dens >= 2
         isa_sample.resize((n-1+Csa::isa_sample_dens-1)/Csa::isa_sample_dens + 1);
     }
 
-    util::set_one_bits(sa_sample);
     util::set_one_bits(isa_sample);
 
     sa_buf.reset();
-    for (size_type i=0, r_sum = 0, r = sa_buf.load_next_block(), cnt_mod=Csa::sa_sample_dens, cnt_sum=0; r_sum < n;) {
-        for (; i < r_sum+r; ++i, ++cnt_mod) {
+    for (size_type i=0, r_sum = 0, r = sa_buf.load_next_block(); r_sum < n;) {
+        for (; i < r_sum+r; ++i) {
             size_type sa = sa_buf[i-r_sum];
             if ((sa % Csa::isa_sample_dens) == 0) {
                 isa_sample[sa/Csa::isa_sample_dens] = i;
             } else if (sa+1 == n) {
                 isa_sample[(sa+Csa::isa_sample_dens-1)/Csa::isa_sample_dens] = i;
             }
-            if (Csa::sa_sample_dens == cnt_mod) {
-                cnt_mod = 0;
-                sa_sample[cnt_sum++] = sa;
-            }
+            sa_sample_add<Csa>(sa_sample, i, sa);
         }
         r_sum += r; r = sa_buf.load_next_block();
     }
+    sa_sample_finish<Csa>(sa_sample);
     /*	if(isa_sample.size() < 20 ){
     		std::cerr<<"isa_samples = ";
     		for(int_vector<>::size_type i=0;i<isa_sample.size(); ++i)
@@ -187,6 +229,53 @@ void set_sa_and_isa_samples(int_vector_file_buffer<int_width, size_type_class>&
     */
 }
 
+//! Calculates the SA and ISA samples of a CSA from the BWT of the text.
+/*! The text is traversed backwards with the LF function of a temporary wavelet tree of the
+ *  BWT (e.g. a wt_huff<>, which is faster than a compressed one), so the suffix array is not needed.
+ *  \param weights If not NULL, the weights of the text positions, which are passed to the SA samples (see weighted_sa_sample).
+ *  \par Time complexity
+ *      \f$ \Order{n \log \sigma} \f$
+ */
+template<class Csa, class WaveletTree, class size_type_class>
+void set_sa_and_isa_samples_by_lf(int_vector_file_buffer<8, size_type_class>& bwt_buf, typename Csa::sa_sample_type& sa_sample, typename Csa::isa_sample_type& isa_sample,
+                                  const int_vector<>* weights=NULL)
+{
+    typedef typename Csa::size_type size_type;
+    size_type  n = bwt_buf.int_vector_size;
+
+    sa_sample_init<Csa>(sa_sample, n, weights);
+
+    isa_sample.set_int_width(bit_magic::l1BP(n)+1);
+    util::check_int_width(isa_sample, n-(n>0), "isa_sample");
+    if (n >= 1) { // so n+Csa::isa_sample_dens >= 2
+        isa_sample.resize((n-1+Csa::isa_sample_dens-1)/Csa::isa_sample_dens + 1);
+    }
+
+    util::set_one_bits(isa_sample);
+
+    bwt_buf.reset();
+    WaveletTree wt(bwt_buf, n);
+    size_type C[257] = {0};
+    for (size_type c=0; c < 256; ++c) {
+        C[c+1] = C[c] + wt.rank(n, (unsigned char)c);
+    }
+    // row 0 contains the last suffix, which consists of the 0-byte
+    for (size_type sa = n, i = 0; sa > 0;) {
+        --sa;
+        if ((sa % Csa::isa_sample_dens) == 0) {
+            isa_sample[sa/Csa::isa_sample_dens] = i;
+        } else if (sa+1 == n) {
+            isa_sample[(sa+Csa::isa_sample_dens-1)/Csa::isa_sample_dens] = i;
+        }
+        sa_sample_add<Csa>(sa_sample, i, sa);
+        if (sa > 0) {
+            std::pair<size_type, unsigned char> rc = inverse_select(wt, i);
+            i = C[rc.second] + rc.first; // LF
+        }
+    }
+    sa_sample_finish<Csa>(sa_sample);
+}
+
 //template<class Csa>
 //bool char_at_char_pos_equals_char(const Csa &csa, typename Csa::size_type char_pos, typename Csa::char_type c){
 //	typename Csa::
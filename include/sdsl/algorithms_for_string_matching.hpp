@@ -29,11 +29,20 @@
 #include <cassert>
 #include <stack>
 #include <utility>
+#include <algorithm>
+#include <string>
+#include <vector>
 
 
 namespace sdsl
 {
 
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+class csa_wt; // forward declaration
+
+template<class BitVector, class RankSupport, class SelectSupport, class SelectSupportZero, bool dfs_shape>
+class wt_huff; // forward declaration
+
 /*!
 	\author Simon Gog
  */
@@ -125,6 +134,46 @@ static typename Csa::csa_size_type count(const Csa& csa, typename Csa::pattern_t
     return backward_search(csa, 0, csa.size()-1, pat, len, t1, t2);
 }
 
+//! Writes the suffix array values SA[lb..lb+cnt-1] of the compressed suffix array csa to sa[0..cnt-1].
+/*!
+ * \param csa The compressed suffix array.
+ * \param lb  The first position in the suffix array.
+ * \param cnt The number of suffix array values.
+ * \param sa  A random access container with at least cnt elements.
+ * \par Time complexity
+ *		\f$ \Order{ cnt \cdot t_{SA} } \f$
+ */
+template<class Csa, class RandomAccessContainer>
+static void sa_values(const Csa& csa, typename Csa::size_type lb, typename Csa::size_type cnt, RandomAccessContainer& sa)
+{
+    for (typename Csa::size_type i=0; i < cnt; ++i) {
+        sa[i] = csa[lb+i];
+    }
+}
+
+//! Writes the suffix array values SA[lb..lb+cnt-1] of a csa_wt based on a wt_huff to sa[0..cnt-1].
+/*!
+ * The values are calculated by csa_wt::sa_interval, which walks all positions together to
+ * their sampled positions and overlaps their cache misses.
+ * \sa sa_values
+ */
+template<class BitVector, class RankSupport, class SelectSupport, class SelectSupportZero, bool dfs_shape,
+         uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport, class RandomAccessContainer>
+static void sa_values(const csa_wt<wt_huff<BitVector, RankSupport, SelectSupport, SelectSupportZero, dfs_shape>, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>& csa,
+                      typename csa_wt<wt_huff<BitVector, RankSupport, SelectSupport, SelectSupportZero, dfs_shape>, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type lb,
+                      typename csa_wt<wt_huff<BitVector, RankSupport, SelectSupport, SelectSupportZero, dfs_shape>, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type cnt,
+                      RandomAccessContainer& sa)
+{
+    typedef csa_wt<wt_huff<BitVector, RankSupport, SelectSupport, SelectSupportZero, dfs_shape>, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport> tCsa;
+    if (cnt > 0) {
+        std::vector<typename tCsa::value_type> values(cnt);
+        csa.sa_interval(lb, lb+cnt-1, &values[0]);
+        for (typename tCsa::size_type i=0; i < cnt; ++i) {
+            sa[i] = values[i];
+        }
+    }
+}
+
 //! Calculates all occurences of pattern pat in the string of the compressed suffix array csa.
 /*!
  * \param csa The compressed suffix array.
@@ -144,12 +193,145 @@ static typename Csa::csa_size_type locate(const Csa&  csa, typename Csa::pattern
     typename Csa::size_type occ_begin, occ_end, occs;
     occs = backward_search(csa, 0, csa.size()-1, pattern, pattern_len, occ_begin, occ_end);
     occ.resize(occs);
-    for (typename Csa::size_type i=0; i < occs; ++i) {
-        occ[i] = csa[occ_begin+i];
-    }
+    sa_values(csa, occ_begin, occs, occ);
     return occs;
 }
 
+//! A range order[begin..end-1] of patterns which share a suffix of length depth with interval [l..r].
+/*!
+ *  If node is true, the range contains all patterns of the trie node of the suffix. Otherwise
+ *  the range is a part of the node, which still has to be partitioned by the (depth+1)th last character.
+ */
+template<class size_type>
+struct backward_search_trie_range {
+    size_type begin, end, depth, l, r;
+    bool node;
+    backward_search_trie_range(size_type begin, size_type end, size_type depth, size_type l, size_type r, bool node):
+        begin(begin), end(end), depth(depth), l(l), r(r), node(node) {}
+};
+
+//! Calculates the intervals of the patterns order[begin..end-1] in a depth-first traversal of the trie of the reversed patterns.
+/*!
+ *  The children of a node are found by partitioning the patterns like in a multikey quicksort, so only
+ *  single characters are compared. The traversal uses an explicit stack, since the depth of the trie
+ *  is the length of the longest pattern.
+ */
+template<class Csa>
+static void backward_search_trie(const Csa& csa, const std::vector<std::string>& patterns,
+                                 typename Csa::size_type* order, typename Csa::size_type begin, typename Csa::size_type end,
+                                 std::vector<std::pair<typename Csa::size_type, typename Csa::size_type> >& intervals)
+{
+    typedef typename Csa::size_type size_type;
+    typedef backward_search_trie_range<size_type> range_type;
+    std::vector<range_type> stack;
+    stack.push_back(range_type(begin, end, 0, 0, csa.size()-1, true));
+    while (!stack.empty()) {
+        range_type x = stack.back();
+        stack.pop_back();
+        if (x.node) {
+            size_type b = x.begin;
+            for (size_type k=x.begin; k < x.end; ++k) {
+                if (patterns[order[k]].size() == x.depth) { // the pattern ends at this node
+                    intervals[order[k]] = std::make_pair(x.l, x.r);
+                    std::swap(order[k], order[b++]);
+                }
+            }
+            if (x.r+1 == x.l) { // the suffix does not occur and neither do the longer patterns
+                for (size_type k=b; k < x.end; ++k)
+                    intervals[order[k]] = std::make_pair(x.l, x.r);
+            } else if (b < x.end) {
+                stack.push_back(range_type(b, x.end, x.depth, x.l, x.r, false));
+            }
+        } else {
+            const std::string& pivot = patterns[order[x.begin+(x.end-x.begin)/2]];
+            unsigned char v = pivot[pivot.size()-1-x.depth];
+            size_type lt = x.begin, i = x.begin, gt = x.end; // [begin..lt-1] < v, [lt..gt-1] == v, [gt..end-1] > v
+            while (i < gt) {
+                const std::string& pat = patterns[order[i]];
+                unsigned char c = pat[pat.size()-1-x.depth];
+                if (c < v)
+                    std::swap(order[lt++], order[i++]);
+                else if (c > v)
+                    std::swap(order[i], order[--gt]);
+                else
+                    ++i;
+            }
+            // push in reverse order, so that the children are visited in increasing character order
+            if (gt < x.end)
+                stack.push_back(range_type(gt, x.end, x.depth, x.l, x.r, false));
+            size_type l_res = 0, r_res = 0;
+            backward_search(csa, x.l, x.r, (typename Csa::char_type)v, l_res, r_res);
+            stack.push_back(range_type(lt, gt, x.depth+1, l_res, r_res, true));
+            if (x.begin < lt)
+                stack.push_back(range_type(x.begin, lt, x.depth, x.l, x.r, false));
+        }
+    }
+}
+
+//! Calculates the suffix array intervals of several patterns.
+/*!
+ * \param csa       The compressed suffix array.
+ * \param patterns  The patterns.
+ * \param intervals intervals[k] is set to the interval [l..r] of patterns[k] in the suffix array.
+ *                  The interval is empty (r+1 == l) if patterns[k] does not occur.
+ *
+ * The patterns are processed in a depth-first traversal of the trie of the reversed patterns.
+ * The interval of each node of the trie, i.e. of each distinct suffix of the patterns, is
+ * calculated only once by a backward search step from the interval of its parent.
+ * \par Time complexity
+ *		\f$ \Order{ m \cdot \ell \cdot \log |\Sigma| + t \cdot t_{rank\_bwt} } \f$, where \f$m\f$ is the number of
+ *		patterns, \f$\ell\f$ their maximal length and \f$t\f$ the number of nodes of the trie.
+ */
+template<class Csa>
+static void backward_search_many(const Csa& csa, const std::vector<std::string>& patterns,
+                                 std::vector<std::pair<typename Csa::size_type, typename Csa::size_type> >& intervals)
+{
+    intervals.resize(patterns.size());
+    if (patterns.empty())
+        return;
+    std::vector<typename Csa::size_type> order(patterns.size());
+    for (typename Csa::size_type k=0; k < patterns.size(); ++k)
+        order[k] = k;
+    backward_search_trie(csa, patterns, &order[0], 0, order.size(), intervals);
+}
+
+//! Counts the occurrences of several patterns in the string of the compressed suffix array csa.
+/*!
+ * \param csa      The compressed suffix array.
+ * \param patterns The patterns.
+ * \param counts   counts[k] is set to the number of occurrences of patterns[k].
+ * \sa backward_search_many
+ */
+template<class Csa>
+static void count_many(const Csa& csa, const std::vector<std::string>& patterns, std::vector<typename Csa::size_type>& counts)
+{
+    std::vector<std::pair<typename Csa::size_type, typename Csa::size_type> > intervals;
+    backward_search_many(csa, patterns, intervals);
+    counts.resize(patterns.size());
+    for (typename Csa::size_type k=0; k < patterns.size(); ++k) {
+        counts[k] = intervals[k].second+1-intervals[k].first;
+    }
+}
+
+//! Calculates the occurrences of several patterns in the string of the compressed suffix array csa.
+/*!
+ * \param csa      The compressed suffix array.
+ * \param patterns The patterns.
+ * \param occ      occ[k] is set to the occurrences of patterns[k] in the order of the suffix array.
+ * \sa backward_search_many, locate
+ */
+template<class Csa>
+static void locate_many(const Csa& csa, const std::vector<std::string>& patterns, std::vector<std::vector<typename Csa::size_type> >& occ)
+{
+    std::vector<std::pair<typename Csa::size_type, typename Csa::size_type> > intervals;
+    backward_search_many(csa, patterns, intervals);
+    occ.resize(patterns.size());
+    for (typename Csa::size_type k=0; k < patterns.size(); ++k) {
+        occ[k].resize(intervals[k].second+1-intervals[k].first);
+        sa_values(csa, intervals[k].first, occ[k].size(), occ[k]);
+    }
+}
+
 //! Returns the substring T[begin..end] of the original text T from the corresponding compressed suffix array.
 /*!
  * \param csa The compressed suffix array.
@@ -161,8 +343,7 @@ static typename Csa::csa_size_type locate(const Csa&  csa, typename Csa::pattern
  * \par Time complexity
  *		\f$ \Order{ (end-begin+1) \cdot t_{\Psi} + t_{SA^{-1}} } \f$
  */
-// Is it cheaper to call T[i] = BWT[iSA[i+1]]??? Additional ranks but H_0 average access
-// TODO: extract backward!!! is faster in most cases!
+// For csa_wt the text is extracted backwards, see the overload below.
 template<class Csa>
 static void extract(const Csa& csa, typename Csa::size_type begin, typename Csa::size_type end, unsigned char* text)
 {
@@ -184,6 +365,91 @@ static void extract(const Csa& csa, typename Csa::size_type begin, typename Csa:
         text[end-begin+1] = 0; // set terminal character
 }
 
+//! Returns the sample of the inverse suffix array of a csa_wt at the first sampled position pos >= i.
+/*!
+ * The last text position \f$ n-1 \f$ is also sampled. If the SA samples also contain ISA
+ * samples (like weighted_sa_sample), the nearer one of both samples is returned.
+ */
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type
+isa_sample_at_or_after(const csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>& csa,
+                       typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type i,
+                       typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type& pos)
+{
+    typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type ii = (i+InvSampleDens-1)/InvSampleDens;
+    pos = ii*InvSampleDens;
+    if (pos >= csa.size())
+        pos = csa.size()-1;
+    typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type spos, sisa;
+    if (csa.sa_sample.isa_sample_at_or_after(i, spos, sisa) and spos < pos) {
+        pos = spos;
+        return sisa;
+    }
+    return csa.isa_sample[ii];
+}
+
+//! Writes T[begin..end] to text[0..end-begin] by applying LF to \f$ ISA[pos] \f$.
+/*!
+ * \param csa   A csa_wt.
+ * \param pos   A text position with \f$ pos > end \f$, or \f$ pos = end = n-1 \f$.
+ * \param isa   The value \f$ ISA[pos] \f$.
+ * \return      The value \f$ ISA[begin] \f$.
+ * \par Time complexity
+ *		\f$ \Order{ (pos-begin) \cdot t_{inverse\_select} } \f$, since the character \f$ BWT[i] \f$ and
+ *      the rank needed for \f$ LF[i] \f$ are determined by one traversal of the wavelet tree.
+ */
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type
+extract_lf(const csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>& csa,
+           typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type pos,
+           typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type isa,
+           typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type begin,
+           typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type end,
+           unsigned char* text)
+{
+    typedef typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type size_type;
+    assert(begin <= end and end <= pos);
+    if (pos == end) { // only the character T[n-1] has to be determined with the first row
+        text[end-begin] = get_ith_character_of_the_first_row(isa, csa);
+    }
+    for (; pos > begin; --pos) { // invariant: isa = ISA[pos] and BWT[isa] = T[pos-1]
+        std::pair<size_type, typename WaveletTree::value_type> rc = inverse_select(csa.wavelet_tree, isa);
+        if (pos <= end+1)
+            text[pos-1-begin] = rc.second;
+        isa = csa.C[csa.char2comp[rc.second]] + rc.first;
+    }
+    return isa;
+}
+
+//! Returns the substring T[begin..end] of the original text T from a csa_wt.
+/*!
+ * The text is extracted backwards with the LF function starting at the first sampled
+ * position of the inverse suffix array after end.
+ * \param csa   The compressed suffix array.
+ * \param begin Index of the starting position (inclusive) of the substring in the original text.
+ * \param end   Index of the end position (inclusive) of the substring in the original text.
+ * \param text	A pointer to the extracted text.
+ * \pre text has to be initialized with enough memory (end-begin+2 bytes) to hold the extracted text.
+ * \pre \f$begin <= end\f$ and \f$ end < csa.size() \f$
+ * \par Time complexity
+ *		\f$ \Order{ (end-begin+s_{SA^{-1}}) \cdot t_{inverse\_select} } \f$
+ */
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+static void extract(const csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>& csa,
+                    typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type begin,
+                    typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type end,
+                    unsigned char* text)
+{
+    typedef typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type size_type;
+    assert(end < csa.size());
+    assert(begin <= end);
+    size_type pos;
+    size_type isa = isa_sample_at_or_after(csa, std::min(end+1, csa.size()-1), pos);
+    extract_lf(csa, pos, isa, begin, end, text);
+    if (text[end-begin]!=0)
+        text[end-begin+1] = 0; // set terminal character
+}
+
 //! Reconstructs the text from position \f$begin\f$ to position \f$end\f$ (inclusive) from the compressed suffix array.
 /*!
  * \param csa The compressed suffix array.
@@ -194,26 +460,82 @@ static void extract(const Csa& csa, typename Csa::size_type begin, typename Csa:
  * \par Time complexity
  *		\f$ \Order{ (end-begin+1) \cdot t_{\Psi} + t_{SA^{-1}} } \f$
  */
-// TODO: use extract with four parameters to implement this method
 template<class Csa>
 static std::string extract(const Csa& csa, typename Csa::size_type begin, typename Csa::size_type end)
 {
     assert(end <= csa.size());
     assert(begin <= end);
-    std::string result(end-begin+1,' ');
-    for (typename Csa::size_type i=begin, order = csa(begin); i<=end; ++i, order =  csa.psi[order]) {
-        uint16_t c_begin = 1, c_end = 257, mid;
-        while (c_begin < c_end) {
-            mid = (c_begin+c_end)>>1;
-            if (csa.C[mid] <= order) {
-                c_begin = mid+1;
-            } else {
-                c_end = mid;
-            }
+    std::vector<unsigned char> text(end-begin+2);
+    extract(csa, begin, end, &text[0]);
+    return std::string((const char*)&text[0], end-begin+1);
+}
+
+//! Reconstructs several substrings of the original text from the compressed suffix array.
+/*!
+ * \param csa      The compressed suffix array.
+ * \param snippets Pairs (begin, end) of the positions (inclusive) of the substrings.
+ * \param result   result[i] will hold the substring of snippets[i].
+ * \pre \f$begin <= end\f$ and \f$ end < csa.size() \f$ for all snippets.
+ * \sa extract
+ */
+template<class Csa>
+static void extract_many(const Csa& csa,
+                         const std::vector<std::pair<typename Csa::size_type, typename Csa::size_type> >& snippets,
+                         std::vector<std::string>& result)
+{
+    result.resize(snippets.size());
+    for (typename Csa::size_type i=0; i < snippets.size(); ++i) {
+        result[i] = extract(csa, snippets[i].first, snippets[i].second);
+    }
+}
+
+// Orders snippets by decreasing end position.
+template<class size_type>
+struct snippet_end_greater {
+    const std::vector<std::pair<size_type, size_type> >* snippets;
+    snippet_end_greater(const std::vector<std::pair<size_type, size_type> >* snippets):snippets(snippets) {}
+    bool operator()(size_type i, size_type j)const {
+        return (*snippets)[i].second > (*snippets)[j].second;
+    }
+};
+
+//! Reconstructs several substrings of the original text from a csa_wt.
+/*!
+ * The snippets are extracted by decreasing end position. If the ISA value at the begin of the
+ * previous snippet is not farther away than the next ISA sample, the LF walk continues from there,
+ * i.e. close snippets share one lookup of the inverse suffix array.
+ * \param csa      The compressed suffix array.
+ * \param snippets Pairs (begin, end) of the positions (inclusive) of the substrings.
+ * \param result   result[i] will hold the substring of snippets[i].
+ * \pre \f$begin <= end\f$ and \f$ end < csa.size() \f$ for all snippets.
+ */
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+static void extract_many(const csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>& csa,
+                         const std::vector<std::pair<typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type,
+                         typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type> >& snippets,
+                         std::vector<std::string>& result)
+{
+    typedef typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type size_type;
+    result.resize(snippets.size());
+    std::vector<size_type> order(snippets.size());
+    for (size_type i=0; i < order.size(); ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), snippet_end_greater<size_type>(&snippets));
+    std::vector<unsigned char> text;
+    size_type cur_pos = csa.size(), cur_isa = 0; // ISA[cur_pos] of the last LF walk
+    for (size_type k=0; k < order.size(); ++k) {
+        size_type begin = snippets[order[k]].first, end = snippets[order[k]].second;
+        assert(begin <= end and end < csa.size());
+        size_type pos, isa = isa_sample_at_or_after(csa, std::min(end+1, csa.size()-1), pos);
+        if (cur_pos > end and cur_pos <= pos) { // continue the last walk
+            pos = cur_pos;
+            isa = cur_isa;
         }
-        result[i-begin] = csa.comp2char[c_begin-1];
+        text.resize(end-begin+1);
+        cur_isa = extract_lf(csa, pos, isa, begin, end, &text[0]);
+        cur_pos = begin;
+        result[order[k]].assign((const char*)&text[0], text.size());
     }
-    return result;
 }
 
 //! Forward search for a character c on the path on depth \f$d\f$ to node \f$v\f$.
@@ -57,6 +57,18 @@ static void calculate_sa(const unsigned char *c, typename RandomAccessContainer:
 template<uint8_t fixedIntWidth>
 static void calculate_sa(const unsigned char *c, typename int_vector<fixedIntWidth>::size_type len, int_vector<fixedIntWidth> &sa);
 
+//! Calculates the Suffix Array for a text with several threads.
+/*!
+ * \param c Text (c-string) to calculate the suffix array. The lex. order is given by the ascii-codes of the characters.
+ * \param len Length of the text.
+ * \param sa Reference to an int_vector which will contain the result of the calculation.
+ * \param threads Number of threads. For threads <= 1 the sequential algorithm is used.
+ * The result is equal to the result of the sequential algorithm. 
+ * \sa _calcSuffixArrayParallel
+ */
+template<uint8_t fixedIntWidth>
+static void calculate_sa(const unsigned char *c, typename int_vector<fixedIntWidth>::size_type len, int_vector<fixedIntWidth> &sa, uint32_t threads);
+
 /* _radixPass stable sorts the sequence a of length n  according 
    to the ordering given by r. The result is written in
    b. K is the size of the alphabet of r. 
@@ -67,6 +79,15 @@ static void _radixPass(I *a, I *b, I *r, I n, I K);
 template<typename I>
 static void _calcSuffixArrayDC3(I *s, I *sa, I n, I K);	
 
+//! Parallel prefix doubling algorithm for the suffix array of c[0..n-1].
+/*! The suffixes are sorted by the first characters which fit into a 64-bit word and then the groups
+ *  of suffixes with equal prefix are refined by prefix doubling; the groups of
+ *  each round are sorted by different threads. Besides sa the algorithm uses 2n 
+ *  integers of the size of sa's integers.
+ */
+void _calcSuffixArrayParallel(const unsigned char *c, uint32_t n, uint32_t *sa, uint32_t threads);
+void _calcSuffixArrayParallel(const unsigned char *c, uint64_t n, uint64_t *sa, uint32_t threads);
+
 //
 // Implementation
 //----------------------------------------------------------
@@ -84,7 +105,7 @@ void calculate_sa(const unsigned char *c, typename RandomAccessContainer::size_t
 		#ifdef divsufsort_FOUND
 			divss = true;
 		#endif
-		#ifdef divsufsort_FOUND64
+		#ifdef divsufsort64_FOUND
 			divss64 = true;
 		#endif
 		uint8_t K=0; // size of the alphabet without zero
@@ -182,6 +203,29 @@ void calculate_sa(const unsigned char *c, typename int_vector<fixedIntWidth>::si
 	}
 }
 
+template<uint8_t fixedIntWidth>
+void calculate_sa(const unsigned char *c, typename int_vector<fixedIntWidth>::size_type len, int_vector<fixedIntWidth> &sa, uint32_t threads){
+	typedef typename int_vector<fixedIntWidth>::size_type size_type;
+	if(threads <= 1 or len <= 1){
+		calculate_sa(c, len, sa);
+		return;
+	}
+	if( sa.get_int_width() < bit_magic::l1BP(len)+1 ){
+		throw std::logic_error( "width of int_vector is to small for the text!!!" ); 
+	}
+	sa.resize(len);
+	if( len < 0xFFFFFFFFULL ){
+		uint32_t *sufarray = new uint32_t[len];
+		_calcSuffixArrayParallel(c, (uint32_t)len, sufarray, threads);
+		for(size_type i=0; i<len; ++i) { sa[i] = sufarray[i]; }
+		delete [] sufarray;
+	}else{
+		uint64_t *sufarray = new uint64_t[len];
+		_calcSuffixArrayParallel(c, (uint64_t)len, sufarray, threads);
+		for(size_type i=0; i<len; ++i) { sa[i] = sufarray[i]; }
+		delete [] sufarray;
+	}
+}
 
 // The following code (function _radixPass and _calcSuffixArrayDC3) was originally written by Juha Kärkkainen.
 // 
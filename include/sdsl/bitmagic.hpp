@@ -27,6 +27,19 @@
 #ifdef __SSE4_2__
 #include <xmmintrin.h>
 #endif
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+// On x86-64 with GCC the bulk popcount b1Cnt(data, n) uses popcnt and AVX2
+// if the CPU supports them, even if they are not enabled at compile time.
+// The CPU features are detected at run time (see bit_magic::detect_cpu).
+// The single word primitives (b1Cnt, i1BP, l1BP, r1BP) are chosen at compile
+// time (CMake adds -msse4.2 if the build machine supports popcnt), so that
+// they stay inlined and without a branch on the CPU features.
+#if defined(__GNUC__) && defined(__x86_64__)
+#define SDSL_CPU_DISPATCH
+#endif
 
 //! Namespace for the succinct data structure library.
 namespace sdsl
@@ -55,6 +68,21 @@ class bit_magic
         //! 64bit mask with all bits set to 1.
         static const int64_t  All1Mask = -1LL;
 
+        //! Indicates if the CPU supports the popcnt instruction (detected at run time).
+        static bool cpu_popcnt;
+        //! Indicates if the CPU supports a fast pdep instruction (detected at run time).
+        /*! The flag is not set on AMD CPUs before Zen 3, which support BMI2
+            but execute pdep in microcode.
+         */
+        static bool cpu_bmi2;
+        //! Indicates if the CPU and the OS support AVX2 (detected at run time).
+        static bool cpu_avx2;
+
+        //! Detect the features of the CPU and set the cpu_* flags.
+        /*! The method is called during the static initialization of the library.
+         */
+        static bool detect_cpu();
+
         //! This constant represents a de Bruijn sequence B(k,n) for k=2 and n=6.
         /*! Details for de Bruijn sequences see
            http://en.wikipedia.org/wiki/De_bruijn_sequence
@@ -251,6 +279,20 @@ class bit_magic
         //! Naive implementation of the b1Cnt function.
         static uint32_t b1CntNaive(uint64_t x);
 
+        //! Implementation of b1Cnt with arithmetic operations only.
+        static uint64_t b1CntSwar(uint64_t x);
+
+        //! Implementation of b1Cnt with the popcnt instruction (used by the benchmark).
+        /*! \pre cpu_popcnt is true or the library was compiled for a CPU with popcnt.
+         */
+        static uint64_t b1CntPopcnt(uint64_t x);
+
+        //! Counts the number of 1-bits in the words data[0..n-1].
+        /*! The method uses AVX2 or popcnt if the CPU supports them. The variant
+            is selected at the first call and then called through a function pointer.
+         */
+        static uint64_t b1Cnt(const uint64_t* data, uint64_t n);
+
         //! Count the number of consecutive and distinct 11 in the 64bit integer x.
         /*!
           	\param x 64bit integer to count the terminating sequence 11 of a fibonacci code.
@@ -315,6 +357,13 @@ class bit_magic
          */
         static uint32_t k1BP(uint64_t x, uint32_t j);
 
+        //! i1BP implementation using the pdep instruction of BMI2.
+        /*! i1BP uses it if BMI2 is enabled at compile time.
+            \pre cpu_bmi2 is true or the library was compiled for a CPU with BMI2.
+            \sa i1BP
+         */
+        static uint32_t i1BPPdep(uint64_t x, uint32_t i);
+
 
 
         //! Naive implementation of i1BP.
@@ -331,6 +380,9 @@ class bit_magic
         //! Naive implementation of l1BP.
         static uint32_t l1BPNaive(uint64_t x);
 
+        //! Implementation of l1BP with lookup tables.
+        static uint32_t l1BPTable(uint64_t x);
+
         //! Calculates the position of the rightmost 1-bit in the 64bit integer x if it exists
         /*! This method is e.g. used in the getUnaryBit method.
         	\param x 64 bit integer.
@@ -343,6 +395,9 @@ class bit_magic
         //! Naive implementation of r1BP.
         static uint32_t r1BPNaive(uint64_t x);
 
+        //! Implementation of r1BP with lookup tables and a De Bruijn sequence.
+        static uint32_t r1BPTable(uint64_t x);
+
         //! Calcluates the position of the i-th rightmost 11-bit-pattern which terminates a fibonacci coded integer in x.
         /*!	\param x 64 bit integer.
             \param i Index of 11-bit-pattern. \f$i \in [1..b11Cnt(x)]\f$
@@ -906,7 +961,7 @@ inline uint16_t bit_magic::max_excess3(uint64_t x, uint16_t& b1Cnt)
 // see page 11, Knuth TAOCP Vol 4 F1A
 inline uint64_t bit_magic::b1Cnt(uint64_t x)
 {
-#ifdef __SSE4_2__
+#if defined(__SSE4_2__) || defined(__POPCNT__)
     return __builtin_popcountll(x);
 #else
 #ifdef POPCOUNT_TL
@@ -915,11 +970,29 @@ inline uint64_t bit_magic::b1Cnt(uint64_t x)
            B1CntBytes[(x>>32)&0xFFULL] + B1CntBytes[(x>>40)&0xFFULL] +
            B1CntBytes[(x>>48)&0xFFULL] + B1CntBytes[(x>>56)&0xFFULL];
 #else
+    return b1CntSwar(x);
+#endif
+#endif
+}
+
+inline uint64_t bit_magic::b1CntSwar(uint64_t x)
+{
     x = x-((x>>1) & 0x5555555555555555ull);
     x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
     x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
     return (0x0101010101010101ull*x >> 56);
-#endif
+}
+
+inline uint64_t bit_magic::b1CntPopcnt(uint64_t x)
+{
+#if defined(__SSE4_2__) || defined(__POPCNT__)
+    return __builtin_popcountll(x);
+#elif defined(SDSL_CPU_DISPATCH)
+    uint64_t res;
+    __asm__("popcntq %1, %0" : "=r"(res) : "r"(x));
+    return res;
+#else
+    return b1CntSwar(x);
 #endif
 }
 
@@ -1100,8 +1173,25 @@ inline uint32_t bit_magic::k1BP(uint64_t x, uint32_t i)
 }
 
 
+inline uint32_t bit_magic::i1BPPdep(uint64_t x, uint32_t i)
+{
+#ifdef __BMI2__
+    return __builtin_ctzll(_pdep_u64(1ULL << (i-1), x));
+#elif defined(SDSL_CPU_DISPATCH)
+    uint64_t res;
+    // deposit the single bit 1<<(i-1) at the position of the i-th 1-bit of x
+    __asm__("pdepq %2, %1, %0" : "=r"(res) : "r"(1ULL << (i-1)), "r"(x));
+    return __builtin_ctzll(res);
+#else
+    return i1BP2(x, i);
+#endif
+}
+
 inline uint32_t bit_magic::i1BP(uint64_t x, uint32_t i)
 {
+#if defined(__BMI2__)
+    return i1BPPdep(x, i);
+#else
 #ifdef __SSE4_2__
 //__m64 v;
 //v = (__m64)x;
@@ -1132,6 +1222,7 @@ inline uint32_t bit_magic::i1BP(uint64_t x, uint32_t i)
     return (byte_nr << 3) + Select256[((i-1) << 8) + ((x>>(byte_nr<<3))&0xFFULL) ];
 #endif
     return i1BP2(x, i);
+#endif
 }
 
 
@@ -1204,12 +1295,19 @@ inline uint32_t bit_magic::i1BPNaive(uint64_t x, uint32_t i)
 // http://www-graphics.stanford.edu/~seander/bithacks.html
 inline uint32_t bit_magic::l1BP(uint64_t x)
 {
-#ifdef __SSE4_2__
+#if defined(__SSE4_2__) || defined(SDSL_CPU_DISPATCH)
+    // bsr is available on all x86-64 CPUs, GCC uses lzcnt if it is enabled at compile time
     if (x == 0)
         return 0;
     return 63 - __builtin_clzll(x);
 #else
-    register uint64_t t,tt; // temporaries
+    return l1BPTable(x);
+#endif
+}
+
+inline uint32_t bit_magic::l1BPTable(uint64_t x)
+{
+    uint64_t t,tt; // temporaries
     if ((tt = x >> 32)) { // l1BP >= 32
         if ((t = tt >> 16)) { // l1BP >= 48
             return (tt = t >> 8) ? 56 + L1BP[tt] : 48 + L1BP[t];
@@ -1223,7 +1321,6 @@ inline uint32_t bit_magic::l1BP(uint64_t x)
             return (tt = x >> 8) ?  8 + L1BP[tt] : L1BP[x];
         }
     }
-#endif
 }
 
 inline uint32_t bit_magic::l1BPNaive(uint64_t x)
@@ -1243,11 +1340,18 @@ inline uint32_t bit_magic::l1BPNaive(uint64_t x)
 // or page 10, Knuth TAOCP Vol 4 F1A
 inline uint32_t bit_magic::r1BP(uint64_t x)
 {
-#ifdef __SSE4_2__
+#if defined(__SSE4_2__) || defined(SDSL_CPU_DISPATCH)
+    // bsf is available on all x86-64 CPUs, GCC uses tzcnt if it is enabled at compile time
     if (x==0)
         return 0;
     return __builtin_ctzll(x);
 #else
+    return r1BPTable(x);
+#endif
+}
+
+inline uint32_t bit_magic::r1BPTable(uint64_t x)
+{
     if (x&1) return 0;
     if (x&3) return 1;
     if (x&7) return 2;
@@ -1258,7 +1362,6 @@ inline uint32_t bit_magic::r1BP(uint64_t x)
     // x&-x equals x with only the lsb set
     //default:
     return DeBruijn64ToIndex[((x&-x)*DeBruijn64)>>58];
-#endif
 }
 
 inline uint32_t bit_magic::r1BPNaive(uint64_t x)
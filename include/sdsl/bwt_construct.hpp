@@ -52,6 +52,22 @@ bool construct_bwt(tMSS& file_map, const std::string& dir, const std::string& id
  */
 bool construct_bwt2(tMSS& file_map, const std::string& dir, const std::string& id);
 
+//! Constructs the Burrows and Wheeler Transform (BWT) from the text without the suffix array
+/*! The suffixes are processed in blocks from right to left. The suffixes of a block are ranked
+ *  among the already processed suffixes by backward search in the partial BWT, sorted with DC3
+ *  and merged into the partial BWT in place (Ferragina et al., Algorithmica 2012, ,,Lightweight
+ *  data indexing and compression in external memory'').
+ * \param file_map   A map, which contains the path of the text, which ends with a unique 0-byte.
+ * \param dir        Directory in which the result should be written on disk.
+ * \param id         Id which should be used to build a file name for the calculated BWT.
+ * \param block_size Number of suffixes which are sorted at once; if 0, n/16 is used.
+ * \par Space complexity:
+ *        \f$n\f$ bytes for the BWT plus a wavelet tree of it plus about \f$25\cdot block\_size\f$ bytes.
+ * \par Time complexity:
+ *        \f$\Order{\frac{n^2}{block\_size} + n\log n}\f$
+ */
+bool construct_bwt_blockwise(tMSS& file_map, const std::string& dir, const std::string& id, uint64_t block_size=0);
+
 
 /*
 	bool construct_bwt( tMSS &file_map, const std::string &dir, const std::string &id){
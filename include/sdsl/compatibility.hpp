@@ -4,3 +4,18 @@
 
 // Things for Microsoft Visual C++
 #include <ciso646>  // this enables the use of logical operators ,,and'', ,,or'', ,,not''
+
+// Software prefetching; a no-op for compilers without __builtin_prefetch
+#ifndef SDSL_PREFETCH
+#ifdef __GNUC__
+#define SDSL_PREFETCH(addr) __builtin_prefetch((const void*)(addr))
+#else
+#define SDSL_PREFETCH(addr)
+#endif
+#endif
+
+// Number of queries between the prefetch for a query and its evaluation in
+// the batched query methods (e.g. rank_support_v::rank(idx, n, out))
+#ifndef SDSL_PREFETCH_DISTANCE
+#define SDSL_PREFETCH_DISTANCE 16
+#endif
@@ -29,15 +29,75 @@
 #include "testutils.hpp"
 #include "suffixarrays.hpp"
 #include "bwt_construct.hpp"
+#include "sa_construct.hpp"
 
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <stdexcept>
+#include <cstring> // for strlen
 
 namespace sdsl
 {
 
+//! Constructs csa from the files in file_map; threads is only used by csa_wt.
+template<class Csa>
+void construct_csa_from_files(Csa& csa, tMSS& file_map, const std::string& dir, const std::string& id, uint32_t threads)
+{
+    util::assign(csa, Csa(file_map, dir, id));
+}
+
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+void construct_csa_from_files(csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>& csa, tMSS& file_map,
+                              const std::string& dir, const std::string& id, uint32_t threads)
+{
+    util::assign(csa, csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>(file_map, dir, id, threads));
+}
+
+//! Stores the text of a file as int_vector<8> in dir+"text_"+id and registers it as file_map["text"].
+/*! A 0-byte is appended to the text; 0-bytes in the file are replaced (see algorithm::shift_text).
+ *  If id is empty, it is set to a unique identifier.
+ *  \return false if the file can not be read.
+ */
+inline bool store_text_for_construction(const std::string& file_name, tMSS& file_map, const std::string& dir, std::string& id)
+{
+    char* text = NULL;
+    uint64_t fs = file::read_text(file_name.c_str(), text);
+    if (fs == 0)
+        return false;
+    uint64_t n = strlen(text);
+    if (id == "")
+        id =  util::to_string(util::get_pid())+"_"+util::to_string(util::get_id()).c_str();
+    if (fs != n + 1) {
+        std::cerr << "# WARNING: file \"" << file_name << "\" contains 0-bytes." << std::endl;
+        algorithm::shift_text(text, fs, true);
+        n = fs-1;
+    }
+    bool stored = util::store_to_file(char_array_serialize_wrapper<>((unsigned char*)text, n+1), (dir+"text_"+id).c_str());
+    delete [] text;
+    if (!stored)
+        throw std::ios_base::failure("#csa_construct: Cannot store text to file system!");
+    file_map["text"] = dir+"text_"+id;
+    return true;
+}
+
+//! Deletes the temporary files of the construction in file_map.
+/*! file_map["sample_weights"] is an input of the caller; the file and its entry are kept.
+ */
+inline void delete_construction_files(tMSS& file_map)
+{
+    tMSS::iterator it = file_map.find("sample_weights");
+    std::string weights_file;
+    bool has_weights = (it != file_map.end());
+    if (has_weights) {
+        weights_file = it->second;
+        file_map.erase(it);
+    }
+    util::delete_all_files(file_map);
+    if (has_weights)
+        file_map["sample_weights"] = weights_file;
+}
+
 template<class Csa>
 static bool construct_csa(std::string file_name, Csa& csa)
 {
@@ -45,36 +105,35 @@ static bool construct_csa(std::string file_name, Csa& csa)
     return construct_csa(file_name, csa, file_map, true, "./","");
 }
 
+//! Constructs a compressed suffix array for the text in a file.
+/*!
+ * \param file_name    Name of the text file.
+ * \param csa          The constructed compressed suffix array.
+ * \param file_map     Map of the names of the temporary files.
+ * \param delete_files Indicates if the temporary files are deleted after the construction.
+ * \param dir          Directory for the temporary files.
+ * \param id           Identifier which is appended to the names of the temporary files.
+ * \param threads      Number of threads for the construction of the suffix array and of the wavelet tree of a csa_wt.
+ * \param ram_budget   If ram_budget > 0, the suffix array and the BWT are constructed in external
+ *                     memory with at most ram_budget bytes of main memory (see construct_sa_extern
+ *                     and construct_bwt_extern).
+ */
 template<class Csa>
-static bool construct_csa(std::string file_name, Csa& csa, tMSS& file_map, bool delete_files=true, std::string dir="./", std::string id="")
+static bool construct_csa(std::string file_name, Csa& csa, tMSS& file_map, bool delete_files=true, std::string dir="./", std::string id="", uint32_t threads=1, uint64_t ram_budget=0)
 {
-    uint64_t fs = 0;
-    char* ccc = NULL;
-    if ((fs=file::read_text((const char*)file_name.c_str(), ccc))>0) {
-        typename Csa::size_type n = strlen((const char*)ccc);
-        if (id == "")
-            id =  util::to_string(util::get_pid())+"_"+util::to_string(util::get_id()).c_str();
-        if (fs != n + 1) {
-            std::cerr << "# WARNING: file \"" << file_name << "\" contains 0-bytes." << std::endl;
-            algorithm::shift_text((char*)ccc, fs, true);
-            n = fs-1;
-        }
-
-        if (!util::store_to_file(char_array_serialize_wrapper<>((unsigned char*)ccc,n+1), (dir+"text_"+id).c_str())) {
-            throw std::ios_base::failure("#csa_construct: Cannot store text to file system!");
-            delete [] ccc;
-            return false;
-        } else {
-            file_map["text"] = (dir+"text_"+id).c_str();
-        }
-        delete [] ccc;
-        return construct_csa(csa, file_map, delete_files, dir, id);
-    }
-    return false;
+    if (!store_text_for_construction(file_name, file_map, dir, id))
+        return false;
+    return construct_csa(csa, file_map, delete_files, dir, id, threads, ram_budget);
 }
 
+//! Constructs a compressed suffix array for the text file_map["text"].
+/*! If ram_budget > 0, the suffix array and the BWT are constructed in external memory and
+ *  the text is never loaded into main memory. The csa itself is then constructed from the
+ *  files as usual, i.e. its memory is not limited by ram_budget.
+ *  \sa construct_csa(std::string, Csa&, tMSS&, bool, std::string, std::string, uint32_t, uint64_t)
+ */
 template<class Csa>
-static bool construct_csa(Csa& csa, tMSS& file_map, bool delete_files=true, std::string dir="./", std::string id="")
+static bool construct_csa(Csa& csa, tMSS& file_map, bool delete_files=true, std::string dir="./", std::string id="", uint32_t threads=1, uint64_t ram_budget=0)
 {
     write_R_output("csa", "construct CSA", "begin", 1, 0);
     int_vector_file_buffer<8> text_buf(file_map["text"].c_str());
@@ -87,7 +146,10 @@ static bool construct_csa(Csa& csa, tMSS& file_map, bool delete_files=true, std:
     std::string sa_file_name = dir+"sa_"+id;
     // if sa file already exists
     std::ifstream in(sa_file_name.c_str());
-    if (!in) {
+    if (!in and ram_budget > 0) {
+        construct_sa_extern(file_map, dir, id, ram_budget);
+        construct_bwt_extern(file_map, dir, id, ram_budget);
+    } else if (!in) {
         unsigned char* text = NULL;
         util::load_from_int_vector_buffer(text, text_buf);
 
@@ -99,7 +161,7 @@ static bool construct_csa(Csa& csa, tMSS& file_map, bool delete_files=true, std:
 
         write_R_output("csa", "construct SA", "begin", 1, 0);
         int_vector<> sa = int_vector<>(n, 0, bit_magic::l1BP(n+1)+1);
-        algorithm::calculate_sa(text,n, sa);	 // calculate the suffix array sa of str
+        algorithm::calculate_sa(text,n, sa, threads);	 // calculate the suffix array sa of str
         delete [] text;
 
         assert(sa.size() == n);
@@ -109,10 +171,8 @@ static bool construct_csa(Csa& csa, tMSS& file_map, bool delete_files=true, std:
 
         if (!util::store_to_file(sa, sa_file_name.c_str())) {
             throw std::ios_base::failure("#csa_construct: Cannot store SA to file system!");
-            return false;
-        } else {
-            file_map["sa"] = sa_file_name;
         }
+        file_map["sa"] = sa_file_name;
         write_R_output("csa", "store SA", "end", 1, 0);
         {
             sa.resize(0);
@@ -126,11 +186,37 @@ static bool construct_csa(Csa& csa, tMSS& file_map, bool delete_files=true, std:
 
 
     write_R_output("csa", "encode CSA", "begin", 1, 0);
-    util::assign(csa, Csa(file_map, dir, id));
+    construct_csa_from_files(csa, file_map, dir, id, threads);
     write_R_output("csa", "encode CSA", "end", 1, 0);
 
     if (delete_files) {
-        util::delete_all_files(file_map);
+        delete_construction_files(file_map);
+    }
+    write_R_output("csa", "construct CSA", "end", 1, 0);
+    return true;
+}
+
+//! Constructs a csa_wt for the text in a file without calculating the suffix array.
+/*! The BWT is calculated by construct_bwt_blockwise and the SA and ISA samples by the LF
+ *  function. The peak memory is about the size of the text plus the size of the csa_wt.
+ * \param file_name    Name of the text file.
+ * \param csa          The constructed compressed suffix array; has to be a csa_wt.
+ * \param file_map     Map of the names of the temporary files.
+ * \param delete_files Indicates if the temporary files are deleted after the construction.
+ * \param dir          Directory for the temporary files.
+ * \param id           Identifier which is appended to the names of the temporary files.
+ */
+template<class Csa>
+static bool construct_csa_without_sa(std::string file_name, Csa& csa, tMSS& file_map, bool delete_files=true, std::string dir="./", std::string id="")
+{
+    if (!store_text_for_construction(file_name, file_map, dir, id))
+        return false;
+    write_R_output("csa", "construct CSA", "begin", 1, 0);
+    write_R_output("csa", "encode CSA", "begin", 1, 0);
+    util::assign(csa, Csa(file_map, dir, id));
+    write_R_output("csa", "encode CSA", "end", 1, 0);
+    if (delete_files) {
+        delete_construction_files(file_map);
     }
     write_R_output("csa", "construct CSA", "end", 1, 0);
     return true;
@@ -177,7 +263,7 @@ static bool construct_csa_of_reversed_text(std::string file_name, Csa& csa, tMSS
     }
     bool res = construct_csa(tmp_rev_file_name, csa, file_map, delete_files, dir, id);
     if (delete_files) {
-        util::delete_all_files(file_map);
+        delete_construction_files(file_map);
     }
     return res;
 }
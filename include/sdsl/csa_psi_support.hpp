@@ -0,0 +1,135 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2012 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file csa_psi_support.hpp
+    \brief csa_psi_support.hpp contains the classes which calculate the \f$\Psi\f$ function of sdsl::csa_wt.
+	\author Simon Gog
+*/
+#ifndef INCLUDED_SDSL_CSA_PSI_SUPPORT
+#define INCLUDED_SDSL_CSA_PSI_SUPPORT
+
+#include "int_vector.hpp"
+#include "algorithms.hpp"
+#include "enc_vector.hpp"
+#include "coder.hpp"
+#include <string>
+
+namespace sdsl
+{
+
+//! Calculates \f$\Psi\f$ of csa_wt by a select query on the wavelet tree; nothing is stored.
+/*! This is the psi support of csa_wt if no other support is selected.
+ *
+ *  A psi support provides construct(csa), which is called after the wavelet tree, C and char2comp
+ *  of the csa are constructed, the calculation of \f$\Psi(i)\f$ by operator()(csa, i), and the
+ *  serialization. The serialization of this class is empty.
+ */
+class psi_select_support
+{
+    public:
+        typedef int_vector<>::size_type size_type;
+        enum { sample_dens = 0 };
+
+        template<class t_csa>
+        void construct(const t_csa&) {}
+
+        //! Calculates \f$\Psi(i)\f$ in \f$\Order{\log |\Sigma|}\f$ time.
+        template<class t_csa>
+        size_type operator()(const t_csa& csa, size_type i)const {
+            typename t_csa::char_type c = algorithm::get_ith_character_of_the_first_row(i, csa);
+            return csa.wavelet_tree.select(i - csa.C[csa.char2comp[c]] + 1 , c);
+        }
+
+        bool operator==(const psi_select_support&)const {
+            return true;
+        }
+
+        bool operator!=(const psi_select_support& s)const {
+            return !(*this == s);
+        }
+
+        void swap(psi_select_support&) {}
+
+        size_type serialize(std::ostream&, structure_tree_node* =NULL, std::string="")const {
+            return 0;
+        }
+
+        void load(std::istream&) {}
+};
+
+//! Stores the \f$\Psi\f$ function of csa_wt in an enc_vector.
+/*! Every t_dens-th \f$\Psi\f$ value is stored explicitly; the other values are the sums of the
+ *  self-delimiting encoded differences to the preceding sample. So \f$\Psi(i)\f$ is decoded
+ *  by a scan of at most t_dens-1 codes instead of a select query on the wavelet tree,
+ *  which speeds up algorithms that follow \f$\Psi\f$ (e.g. the suffix links of cst_sct3 or
+ *  the forward search). Since \f$\Psi\f$ is increasing in each interval of suffixes which start
+ *  with the same character, the differences are small for compressible texts.
+ *
+ *  \tparam t_dens  The sample density of the \f$\Psi\f$ values.
+ *  \tparam t_coder The self-delimiting code of the differences, e.g. coder::elias_delta or coder::fibonacci.
+ */
+template<uint32_t t_dens = 16, class t_coder = coder::elias_delta>
+class psi_sample_support
+{
+    public:
+        typedef int_vector<>::size_type size_type;
+        typedef enc_vector<t_coder, t_dens> enc_vector_type;
+        enum { sample_dens = t_dens };
+    private:
+        enc_vector_type m_psi;
+    public:
+        //! Calculates \f$\Psi\f$ by one scan over the BWT of csa: \f$\Psi(C[c]+rank_c(BWT,i))=i\f$ for c=BWT[i].
+        template<class t_csa>
+        void construct(const t_csa& csa) {
+            size_type n = csa.size();
+            int_vector<64> cnt(csa.C);
+            int_vector<> psi(n, 0, bit_magic::l1BP(n)+1);
+            for (size_type i=0; i < n; ++i) {
+                psi[cnt[csa.char2comp[csa.bwt[i]]]++] = i;
+            }
+            util::assign(m_psi, enc_vector_type(psi));
+        }
+
+        //! Calculates \f$\Psi(i)\f$ in \f$\Order{t\_dens}\f$ time.
+        template<class t_csa>
+        size_type operator()(const t_csa&, size_type i)const {
+            return m_psi[i];
+        }
+
+        bool operator==(const psi_sample_support& s)const {
+            return m_psi == s.m_psi;
+        }
+
+        bool operator!=(const psi_sample_support& s)const {
+            return !(*this == s);
+        }
+
+        void swap(psi_sample_support& s) {
+            m_psi.swap(s.m_psi);
+        }
+
+        size_type serialize(std::ostream& out, structure_tree_node* v=NULL, std::string name="")const {
+            return m_psi.serialize(out, v, name);
+        }
+
+        void load(std::istream& in) {
+            m_psi.load(in);
+        }
+};
+
+} // end namespace sdsl
+
+#endif
@@ -30,6 +30,8 @@
 #include "util.hpp"
 #include "testutils.hpp"
 #include "bwt_construct.hpp"
+#include "fast_cache.hpp"
+#include "csa_sampling.hpp"
 #include <iostream>
 #include <algorithm>
 #include <cassert>
@@ -40,7 +42,7 @@
 namespace sdsl
 {
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens,  uint8_t fixedIntWidth>
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens,  uint8_t fixedIntWidth, class SaSampling>
 class csa_sada;
 
 template<uint8_t fixedIntWidth>
@@ -62,13 +64,17 @@ struct csa_sada_trait<64> {
 //! A class for the Compressed Suffix Array (CSA) proposed by Sadakane for practical implementation.
 /*! The CSA is parameterized with an EncVector and the sample density SampleDens (\f$s_{SA}\f$).
   * I.e. every \f$s_{SA}th\f$ value from the original suffix array is explicitely stored with \f$\log n\f$ bits.
+  * With fixedIntWidth=32 the samples are stored in an int_vector<32>, so the construction throws
+  * std::length_error for texts with more than \f$2^{32}\f$ characters; use fixedIntWidth 0 or 64 for such texts.
+  * SaSampling selects SA-order (sa_order_sampling, default) or text-order (text_order_sampling<>) sampling.
   *
   * The EncVector (default is sdsl::enc_vector) holds the \f$\Psi\f$-function and can be parametrized with \f$s_{\Psi}\f$.
+  * If USE_CSA_CACHE is defined, SA and ISA values are cached (see csa_cache_type).
   * \todo example, code example
   *  \sa csa_sada_theo
   * @ingroup csa
  */
-template<class EncVector = enc_vector<>, uint32_t SampleDens = 32, uint32_t InvSampleDens = 64,  uint8_t fixedIntWidth = 0>
+template<class EncVector = enc_vector<>, uint32_t SampleDens = 32, uint32_t InvSampleDens = 64,  uint8_t fixedIntWidth = 0, class SaSampling = sa_order_sampling>
 class csa_sada
 {
     public:
@@ -87,7 +93,7 @@ class csa_sada
         typedef bwt_of_csa_psi<csa_sada>						 	      bwt_type;
         typedef const unsigned char*						 		      pattern_type;
         typedef unsigned char										      char_type;
-        typedef typename csa_sada_trait<fixedIntWidth>::int_vector_type   sa_sample_type;
+        typedef typename SaSampling::template sample<SampleDens, typename csa_sada_trait<fixedIntWidth>::int_vector_type>::type sa_sample_type;
         typedef typename csa_sada_trait<fixedIntWidth>::int_vector_type   isa_sample_type;
 
         typedef csa_tag													  index_category;
@@ -114,6 +120,10 @@ class csa_sada
         uint16_t		m_sigma;
 
         uint64_t *m_psi_buf; //[SampleDens+1]; // buffer for decoded psi values
+#ifdef USE_CSA_CACHE
+        mutable csa_cache_type m_sa_cache;  // cache for SA values
+        mutable csa_cache_type m_isa_cache; // cache for ISA values
+#endif
 
         template<typename RandomAccessContainer>
         void construct(const RandomAccessContainer& sa, const unsigned char* str);
@@ -124,7 +134,16 @@ class csa_sada
         template<typename RandomAccessContainer>
         void construct_samples(const RandomAccessContainer& sa, const unsigned char* str);
 
+        //! Removes the cached SA and ISA values, which belong to the previous content.
+        void clear_caches() {
+#ifdef USE_CSA_CACHE
+            m_sa_cache.clear();
+            m_isa_cache.clear();
+#endif
+        }
+
         void copy(const csa_sada& csa) {
+            clear_caches();
             m_psi = csa.m_psi;
             m_sa_sample = csa.m_sa_sample;
             m_isa_sample = csa.m_isa_sample;
@@ -175,7 +194,7 @@ class csa_sada
 		}
 
         //! Copy constructor
-        csa_sada(const csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>& csa):char2comp(m_char2comp), comp2char(m_comp2char), C(m_C), sigma(m_sigma), psi(m_psi_wrapper), bwt(m_bwt), sa_sample(m_sa_sample), isa_sample(m_isa_sample) {
+        csa_sada(const csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>& csa):char2comp(m_char2comp), comp2char(m_comp2char), C(m_C), sigma(m_sigma), psi(m_psi_wrapper), bwt(m_bwt), sa_sample(m_sa_sample), isa_sample(m_isa_sample) {
 			create_buffer();
             copy(csa);
         }
@@ -243,7 +262,7 @@ class csa_sada
 
         	Required for the Assignable Conecpt of the STL.
           */
-        void swap(csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>& csa);
+        void swap(csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>& csa);
 
         //! Returns a const_iterator to the first element.
         /*! Required for the STL Container Concept.
@@ -274,6 +293,18 @@ class csa_sada
          */
         inline value_type operator()(size_type i)const;
 
+#ifdef USE_CSA_CACHE
+        //! Returns the cache of the SA values, e.g. to read its hit and miss counters.
+        const csa_cache_type& sa_cache()const {
+            return m_sa_cache;
+        }
+
+        //! Returns the cache of the ISA values.
+        const csa_cache_type& isa_cache()const {
+            return m_isa_cache;
+        }
+#endif
+
         //! Assignment Operator.
         /*!
          *	Required for the Assignable Concept of the STL.
@@ -414,8 +445,8 @@ finish:
 
 // == template functions ==
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
-csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::csa_sada(const unsigned char* str):char2comp(m_char2comp), comp2char(m_comp2char), C(m_C), sigma(m_sigma), psi(m_psi_wrapper), bwt(m_bwt), sa_sample(m_sa_sample), isa_sample(m_isa_sample)
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
+csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::csa_sada(const unsigned char* str):char2comp(m_char2comp), comp2char(m_comp2char), C(m_C), sigma(m_sigma), psi(m_psi_wrapper), bwt(m_bwt), sa_sample(m_sa_sample), isa_sample(m_isa_sample)
 {
 	create_buffer();
     csa_uncompressed sa(str);
@@ -429,9 +460,9 @@ csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::csa_sada(const un
 //		throw std::logic_error("csa_sada: text size differ with sa size!");
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
 template<typename RandomAccessContainer>
-csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::csa_sada(const RandomAccessContainer& sa, const unsigned char* str):char2comp(m_char2comp), comp2char(m_comp2char),C(m_C), sigma(m_sigma), psi(m_psi_wrapper), bwt(m_bwt), sa_sample(m_sa_sample), isa_sample(m_isa_sample)
+csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::csa_sada(const RandomAccessContainer& sa, const unsigned char* str):char2comp(m_char2comp), comp2char(m_comp2char),C(m_C), sigma(m_sigma), psi(m_psi_wrapper), bwt(m_bwt), sa_sample(m_sa_sample), isa_sample(m_isa_sample)
 {
 	create_buffer();
     size_type n = 1;
@@ -445,9 +476,9 @@ csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::csa_sada(const Ra
         throw std::logic_error(util::demangle(typeid(this).name())+": text size differ with sa size!");
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
 template<typename RandomAccessContainer>
-csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::csa_sada(RandomAccessContainer& sa, const unsigned char* str):char2comp(m_char2comp), comp2char(m_comp2char),C(m_C), sigma(m_sigma), psi(m_psi_wrapper), bwt(m_bwt), sa_sample(m_sa_sample), isa_sample(m_isa_sample)
+csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::csa_sada(RandomAccessContainer& sa, const unsigned char* str):char2comp(m_char2comp), comp2char(m_comp2char),C(m_C), sigma(m_sigma), psi(m_psi_wrapper), bwt(m_bwt), sa_sample(m_sa_sample), isa_sample(m_isa_sample)
 {
 	create_buffer();
     size_type n = 1;
@@ -461,9 +492,9 @@ csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::csa_sada(RandomAc
         throw std::logic_error("csa_sada: text size differ with sa size!");
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
 template<class size_type_class, uint8_t int_width, class size_type_class_1>
-csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::csa_sada(int_vector_file_buffer<8, size_type_class>& bwt_buf,
+csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::csa_sada(int_vector_file_buffer<8, size_type_class>& bwt_buf,
         int_vector_file_buffer<int_width, size_type_class_1>& sa_buf):
     char2comp(m_char2comp), comp2char(m_comp2char),C(m_C), sigma(m_sigma), psi(m_psi_wrapper), bwt(m_bwt), sa_sample(m_sa_sample), isa_sample(m_isa_sample)
 {
@@ -501,17 +532,18 @@ csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::csa_sada(int_vect
     m_bwt = bwt_type(this);
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
-csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::csa_sada(tMSS& file_map, const std::string& dir, const std::string& id):
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
+csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::csa_sada(tMSS& file_map, const std::string& dir, const std::string& id):
     char2comp(m_char2comp), comp2char(m_comp2char),C(m_C), sigma(m_sigma), psi(m_psi_wrapper), bwt(m_bwt), sa_sample(m_sa_sample), isa_sample(m_isa_sample)
 {
 	create_buffer();
     construct(file_map, dir, id);
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
-void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::construct(tMSS& file_map, const std::string& dir, const std::string& id)
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
+void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::construct(tMSS& file_map, const std::string& dir, const std::string& id)
 {
+    clear_caches();
     if (file_map.find("bwt") == file_map.end()) { // if bwt is not already stored on disk => construct bwt
         construct_bwt(file_map, dir, id);
     }
@@ -551,49 +583,48 @@ void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::construct(tM
     m_bwt = bwt_type(this);
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
-uint32_t csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::get_sample_dens()const
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
+uint32_t csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::get_sample_dens()const
 {
     return SampleDens;
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
-uint32_t csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::get_psi_sample_dens()const
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
+uint32_t csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::get_psi_sample_dens()const
 {
     return m_psi.get_sample_dens();
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
-void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::set_psi_sample_dens(const uint32_t sample_dens)
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
+void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::set_psi_sample_dens(const uint32_t sample_dens)
 {
     m_psi.get_sample_dens();
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
 template<typename RandomAccessContainer>
-void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::construct_samples(const RandomAccessContainer& sa, const unsigned char* str)
+void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::construct_samples(const RandomAccessContainer& sa, const unsigned char* str)
 {
-    m_sa_sample.set_int_width(bit_magic::l1BP(sa.size())+1);
-    m_sa_sample.resize((sa.size()+get_sample_dens()-1)/get_sample_dens());
-    typename RandomAccessContainer::size_type i=0, idx=0;
-    for (typename RandomAccessContainer::const_iterator it = sa.begin(); i < sa.size(); it += (difference_type)get_sample_dens(), i += get_sample_dens(), ++idx) {
-        m_sa_sample[idx] = *it;
-    }
+    m_sa_sample.init(sa.size());
 //	const uint32_t SampleDens, uint32_t InvSampleDensISA = get_sample_dens()*16;
     m_isa_sample.set_int_width(bit_magic::l1BP(sa.size())+1);
+    util::check_int_width(m_isa_sample, sa.size()-(sa.size()>0), "isa_sample");
     m_isa_sample.resize((sa.size()+(InvSampleDens)-1)/(InvSampleDens));
-    i = 0;
+    typename RandomAccessContainer::size_type i = 0;
     for (typename RandomAccessContainer::const_iterator it = sa.begin(), end = sa.end(); it != end; ++it, ++i) {
+        m_sa_sample.add(i, *it);
         if ((*it % InvSampleDens) == 0) {
             m_isa_sample[*it/InvSampleDens] = i;
         }
     }
+    m_sa_sample.finish();
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
 template<typename RandomAccessContainer>
-void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::construct(const RandomAccessContainer& sa, const unsigned char* str)
+void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::construct(const RandomAccessContainer& sa, const unsigned char* str)
 {
+    clear_caches();
     construct_samples(sa, str);
 #ifdef SDSL_DEBUG
     std::cerr<<"create encoded psi"<<std::endl;
@@ -610,10 +641,11 @@ void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::construct(co
 #endif
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
 template<typename RandomAccessContainer>
-void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::construct(RandomAccessContainer& sa, const unsigned char* str)
+void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::construct(RandomAccessContainer& sa, const unsigned char* str)
 {
+    clear_caches();
     construct_samples(sa, str);
 #ifdef SDSL_DEBUG
     std::cerr<<"create encoded psi"<<std::endl;
@@ -635,47 +667,68 @@ void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::construct(Ra
 #endif
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
-typename csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::const_iterator csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::begin()const
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
+typename csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::const_iterator csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::begin()const
 {
     return const_iterator(this, 0);
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
-typename csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::const_iterator csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::end()const
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
+typename csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::const_iterator csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::end()const
 {
     return const_iterator(this, size());
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
-inline typename csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::value_type csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::operator[](size_type i)const
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
+inline typename csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::value_type csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::operator[](size_type i)const
 {
+#ifdef USE_CSA_CACHE
+    size_type r = 0;
+    if (m_sa_cache.exists(i, r)) {
+        return r;
+    }
+    const size_type j = i;
+#endif
     size_type off = 0;
-    while (i % SampleDens) {// while i mod SampleDens != 0 (SA[i] is not sampled)   SG: auf keinen Fall get_sample_dens nehmen, ist total langsam
+    while (!m_sa_sample.is_sampled(i)) {// while SA[i] is not sampled
         i = m_psi[i];       // go to the position where SA[i]+1 is located
         ++off;              // add 1 to the offset
     }
-    value_type result = m_sa_sample[i/SampleDens];
+    value_type result = m_sa_sample.sa_value(i);
     if (result < off) {
-        return m_psi.size()-(off-result);
+        result = m_psi.size()-(off-result);
     } else
-        return result-off;
+        result = result-off;
+#ifdef USE_CSA_CACHE
+    m_sa_cache.write(j, result);
+#endif
+    return result;
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
-inline typename csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::value_type csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::operator()(size_type i)const
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
+inline typename csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::value_type csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::operator()(size_type i)const
 {
+#ifdef USE_CSA_CACHE
+    size_type r = 0;
+    if (m_isa_cache.exists(i, r)) {
+        return r;
+    }
+    const size_type j = i;
+#endif
     value_type result = m_isa_sample[i/InvSampleDens]; // get the rightmost sampled isa value
     i = i % InvSampleDens;
     while (i--) {
         result = m_psi[result];
     }
 //	assert(((*this)[result])==j);
+#ifdef USE_CSA_CACHE
+    m_isa_cache.write(j, result);
+#endif
     return result;
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
-csa_sada<EncVector,SampleDens, InvSampleDens, fixedIntWidth>& csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::operator=(const csa_sada<EncVector,SampleDens, InvSampleDens, fixedIntWidth>& csa)
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
+csa_sada<EncVector,SampleDens, InvSampleDens, fixedIntWidth, SaSampling>& csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::operator=(const csa_sada<EncVector,SampleDens, InvSampleDens, fixedIntWidth, SaSampling>& csa)
 {
     if (this != &csa) {
         copy(csa);
@@ -684,8 +737,8 @@ csa_sada<EncVector,SampleDens, InvSampleDens, fixedIntWidth>& csa_sada<EncVector
 }
 
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
-typename csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::size_type csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::serialize(std::ostream& out, structure_tree_node* v, std::string name)const
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
+typename csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::size_type csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::serialize(std::ostream& out, structure_tree_node* v, std::string name)const
 {
     structure_tree_node* child = structure_tree::add_child(v, name, util::class_name(*this));
     size_type written_bytes = 0;
@@ -700,9 +753,10 @@ typename csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::size_typ
     return written_bytes;
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
-void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::load(std::istream& in)
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
+void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::load(std::istream& in)
 {
+    clear_caches();
     m_psi.load(in);
     m_sa_sample.load(in);
     m_isa_sample.load(in);
@@ -714,8 +768,8 @@ void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::load(std::is
     m_bwt = bwt_type(this);
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
-void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::swap(csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>& csa)
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
+void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::swap(csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>& csa)
 {
     if (this != &csa) {
         m_psi.swap(csa.m_psi);
@@ -729,11 +783,13 @@ void csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::swap(csa_sad
         csa.m_psi_wrapper = psi_type(&csa);
         m_bwt = bwt_type(this);
         csa.m_bwt = bwt_type(&csa);
+        clear_caches();
+        csa.clear_caches();
     }
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
-bool csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::operator==(const csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>& csa)const
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
+bool csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::operator==(const csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>& csa)const
 {
     for (uint16_t i=0; i<256; ++i)
         if (m_char2comp[i] != csa.m_char2comp[i] or m_comp2char[i] != csa.m_comp2char[i] or m_C[i] != csa.m_C[i])
@@ -741,8 +797,8 @@ bool csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::operator==(c
     return m_psi == csa.m_psi and m_sa_sample == csa.m_sa_sample and m_isa_sample == csa.m_isa_sample and m_C[256] == csa.m_C[256] and m_sigma == csa.m_sigma;
 }
 
-template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth>
-bool csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>::operator!=(const csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth>& csa)const
+template<class EncVector, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class SaSampling>
+bool csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>::operator!=(const csa_sada<EncVector, SampleDens, InvSampleDens, fixedIntWidth, SaSampling>& csa)const
 {
     return !(*this == csa);
 //	return m_psi != csa.m_psi or m_sa_sample != csa.m_sa_sample or m_isa_sample != csa.m_isa_sample;
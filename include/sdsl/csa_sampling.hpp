@@ -0,0 +1,550 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2012 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file csa_sampling.hpp
+    \brief csa_sampling.hpp contains the classes which store the suffix array samples of sdsl::csa_wt and sdsl::csa_sada.
+
+    The samples are accessed by a suffix array position i with is_sampled(i) and sa_value(i),
+    not by the index of a sample. There is no operator[], since the samples of csa_wt and
+    csa_sada were int_vectors indexed by i/SampleDens before.
+	\author Simon Gog
+*/
+#ifndef INCLUDED_SDSL_CSA_SAMPLING
+#define INCLUDED_SDSL_CSA_SAMPLING
+
+#include "int_vector.hpp"
+#include "rank_support.hpp"
+#include "sd_vector.hpp"
+#include "util.hpp"
+#include <stdexcept>
+#include <string>
+
+namespace sdsl
+{
+
+//! Stores the suffix array value of every t_dens-th suffix array position (SA-order sampling).
+/*! This is the sampling of csa_wt and csa_sada if no other sampling is selected.
+ *  \tparam t_dens       The sample density \f$s_{SA}\f$.
+ *  \tparam t_int_vector The type of the vector which stores the samples.
+ *
+ *  The samples are constructed by the calls init(n), add(i, SA[i]) for all \f$i\in[0..n-1]\f$ and finish().
+ *  The serialization equals the serialization of the sample vector. All sample classes provide
+ *  isa_sample_at_or_after, which returns false if the class does not store ISA samples.
+ */
+template<uint32_t t_dens, class t_int_vector = int_vector<> >
+class sa_order_sa_sample
+{
+    public:
+        typedef typename t_int_vector::size_type  size_type;
+        typedef typename t_int_vector::value_type value_type;
+        enum { sample_dens = t_dens };
+    private:
+        t_int_vector m_samples;
+    public:
+        //! Prepares the construction of the samples of a suffix array of size n; weights are not used.
+        void init(size_type n, const int_vector<>* weights=NULL) {
+            m_samples.set_int_width(bit_magic::l1BP(n)+1);
+            util::check_int_width(m_samples, n-(n>0), "sa_order_sa_sample");
+            m_samples.resize((n+t_dens-1)/t_dens);
+            util::set_one_bits(m_samples);
+        }
+
+        //! Adds the suffix array value sa of position i.
+        void add(size_type i, size_type sa) {
+            if ((i % t_dens) == 0) {
+                m_samples[i/t_dens] = sa;
+            }
+        }
+
+        //! Finishes the construction.
+        void finish() {}
+
+        //! Returns if the suffix array value of position i is sampled.
+        bool is_sampled(size_type i)const {
+            return (i % t_dens) == 0;
+        }
+
+        //! Returns the suffix array value of the sampled suffix array position i.
+        /*! \pre is_sampled(i)
+         */
+        value_type sa_value(size_type i)const {
+            return m_samples[i/t_dens];
+        }
+
+        //! Number of samples.
+        size_type size()const {
+            return m_samples.size();
+        }
+
+        //! The ISA values are not sampled by this class.
+        bool isa_sample_at_or_after(size_type, size_type&, size_type&)const {
+            return false;
+        }
+
+        bool operator==(const sa_order_sa_sample& s)const {
+            return m_samples == s.m_samples;
+        }
+
+        bool operator!=(const sa_order_sa_sample& s)const {
+            return !(*this == s);
+        }
+
+        void swap(sa_order_sa_sample& s) {
+            m_samples.swap(s.m_samples);
+        }
+
+        size_type serialize(std::ostream& out, structure_tree_node* v=NULL, std::string name="")const {
+            return m_samples.serialize(out, v, name);
+        }
+
+        void load(std::istream& in) {
+            m_samples.load(in);
+        }
+};
+
+//! Stores the suffix array value of every suffix array position whose suffix starts at a multiple of t_dens (text-order sampling).
+/*! The sampled suffix array positions are marked in a bit vector. The value of the k-th
+ *  marked position divided by t_dens is stored at index k of the sample vector.
+ *  Since each text position is at most t_dens-1 LF steps away from a sampled text position,
+ *  an access of a csa with this sampling takes at most \f$s_{SA}-1\f$ LF steps, while SA-order
+ *  sampling does not bound the number of steps. The samples need \f$\log(n/s_{SA})\f$ instead
+ *  of \f$\log n\f$ bits; a sparse bit vector like sd_vector adds about \f$2+\log s_{SA}\f$ bits per sample.
+ *
+ *  \tparam t_dens        The sample density \f$s_{SA}\f$.
+ *  \tparam t_int_vector  The type of the vector which stores the samples.
+ *  \tparam t_bit_vector  The type of the bit vector which marks the sampled positions, e.g. sd_vector<>, rrr_vector<> or bit_vector.
+ *  \tparam t_rank        The rank support for t_bit_vector.
+ */
+template<uint32_t t_dens,
+         class t_int_vector = int_vector<>,
+         class t_bit_vector = sd_vector<>,
+         class t_rank       = typename t_bit_vector::rank_1_type>
+class text_order_sa_sample
+{
+    public:
+        typedef typename t_int_vector::size_type  size_type;
+        typedef typename t_int_vector::value_type value_type;
+        typedef t_bit_vector                      bit_vector_type;
+        enum { sample_dens = t_dens };
+    private:
+        t_bit_vector m_marked;      // m_marked[i]=1 iff SA[i] mod t_dens = 0
+        t_rank       m_rank_marked; // rank support for m_marked
+        t_int_vector m_samples;     // SA values/t_dens of the marked positions
+        int_vector<> m_pos;         // only used during construction: suffix array position of text position k*t_dens
+        size_type    m_n;           // only used during construction: size of the suffix array
+
+        void copy(const text_order_sa_sample& s) {
+            m_marked  = s.m_marked;
+            m_rank_marked = s.m_rank_marked;
+            m_rank_marked.set_vector(&m_marked);
+            m_samples = s.m_samples;
+        }
+    public:
+        text_order_sa_sample():m_n(0) {}
+
+        text_order_sa_sample(const text_order_sa_sample& s):m_n(0) {
+            copy(s);
+        }
+
+        text_order_sa_sample& operator=(const text_order_sa_sample& s) {
+            if (this != &s) {
+                copy(s);
+            }
+            return *this;
+        }
+
+        //! Prepares the construction of the samples of a suffix array of size n; weights are not used.
+        void init(size_type n, const int_vector<>* weights=NULL) {
+            m_pos = int_vector<>((n+t_dens-1)/t_dens, 0, bit_magic::l1BP(n)+1);
+            m_marked = t_bit_vector();
+            util::clear(m_samples);
+            m_n = n;
+        }
+
+        //! Adds the suffix array value sa of position i.
+        void add(size_type i, size_type sa) {
+            if ((sa % t_dens) == 0) {
+                m_pos[sa/t_dens] = i;
+            }
+        }
+
+        //! Builds the bit vector and the samples from the added values.
+        void finish() {
+            bit_vector marked(m_n, 0);
+            for (size_type k=0; k < m_pos.size(); ++k) {
+                marked[m_pos[k]] = 1;
+            }
+            rank_support_v<> rank_marked(&marked);
+            m_samples.set_int_width(bit_magic::l1BP(m_pos.size())+1);
+            util::check_int_width(m_samples, m_pos.size()-(m_pos.size()>0), "text_order_sa_sample");
+            m_samples.resize(m_pos.size());
+            for (size_type k=0; k < m_pos.size(); ++k) {
+                m_samples[rank_marked(m_pos[k])] = k;
+            }
+            util::clear(m_pos);
+            t_bit_vector tmp(marked);
+            m_marked.swap(tmp);
+            util::init_support(m_rank_marked, &m_marked);
+        }
+
+        //! Returns if the suffix array value of position i is sampled.
+        bool is_sampled(size_type i)const {
+            return m_marked[i];
+        }
+
+        //! Returns the suffix array value of the sampled suffix array position i.
+        /*! \pre is_sampled(i)
+         */
+        value_type sa_value(size_type i)const {
+            return m_samples[m_rank_marked(i)] * t_dens;
+        }
+
+        //! Number of samples.
+        size_type size()const {
+            return m_samples.size();
+        }
+
+        //! The ISA values are not sampled by this class.
+        bool isa_sample_at_or_after(size_type, size_type&, size_type&)const {
+            return false;
+        }
+
+        bool operator==(const text_order_sa_sample& s)const {
+            if (m_samples != s.m_samples or m_marked.size() != s.m_marked.size())
+                return false;
+            for (size_type i=0; i < m_marked.size(); ++i) {
+                if (m_marked[i] != s.m_marked[i])
+                    return false;
+            }
+            return true;
+        }
+
+        bool operator!=(const text_order_sa_sample& s)const {
+            return !(*this == s);
+        }
+
+        void swap(text_order_sa_sample& s) {
+            if (this != &s) {
+                m_marked.swap(s.m_marked);
+                util::swap_support(m_rank_marked, s.m_rank_marked, &m_marked, &s.m_marked);
+                m_samples.swap(s.m_samples);
+            }
+        }
+
+        size_type serialize(std::ostream& out, structure_tree_node* v=NULL, std::string name="")const {
+            structure_tree_node* child = structure_tree::add_child(v, name, util::class_name(*this));
+            size_type written_bytes = 0;
+            written_bytes += m_marked.serialize(out, child, "marked");
+            written_bytes += m_rank_marked.serialize(out, child, "rank_marked");
+            written_bytes += m_samples.serialize(out, child, "samples");
+            structure_tree::add_size(child, written_bytes);
+            return written_bytes;
+        }
+
+        void load(std::istream& in) {
+            m_marked.load(in);
+            m_rank_marked.load(in, &m_marked);
+            m_samples.load(in);
+        }
+};
+
+//! Marks the text positions which are sampled by weighted_sa_sample.
+/*! Position 0 is always marked. Then the text is scanned from left to right and the next
+ *  position j is marked if the distance to the last marked position reaches max_gap or if the
+ *  costs \f$\sum_k weights[k]\cdot(k-last)\f$ of the positions k after the last marked position
+ *  up to j exceed a threshold. The threshold is the smallest one (found by binary search)
+ *  for which at most m positions are marked.
+ *  \param weights Weight of each text position, e.g. the number of times it was located.
+ *  \param m       The maximal number of marked positions, \f$m\geq\lceil n/max\_gap\rceil\f$.
+ *  \param max_gap The maximal distance between two marked positions.
+ *  \param marked  Bit vector of size \f$n=weights.size()\f$, which contains the marked positions.
+ *  \return The number of marked positions.
+ *  \par Time complexity
+ *      \f$ \Order{n \log W} \f$, where W is the sum of the costs
+ */
+inline bit_vector::size_type calculate_weighted_samples(const int_vector<>& weights, bit_vector::size_type m,
+        bit_vector::size_type max_gap, bit_vector& marked)
+{
+    typedef bit_vector::size_type size_type;
+    const size_type n = weights.size();
+    util::assign(marked, bit_vector(n, 0));
+    if (n == 0)
+        return 0;
+    double lb = 0, rb = 0; // the threshold lies in [lb..rb]
+    for (size_type j=0; j < n; ++j)
+        rb += (double)weights[j]*max_gap;
+    for (int round=0; round < 48; ++round) {
+        double threshold = round == 0 ? 0 : (lb+rb)/2; // try the smallest threshold first
+        size_type cnt = 1;
+        double cost = 0;
+        for (size_type j=1, last=0; j < n and cnt <= m; ++j) {
+            cost += (double)weights[j]*(j-last);
+            if (cost > threshold or j-last >= max_gap) {
+                ++cnt; last = j; cost = 0;
+            }
+        }
+        if (cnt <= m) {
+            rb = threshold;
+            if (round == 0)
+                break;
+        } else {
+            lb = threshold;
+        }
+    }
+    size_type cnt = 1;
+    double cost = 0;
+    marked[0] = 1;
+    for (size_type j=1, last=0; j < n; ++j) {
+        cost += (double)weights[j]*(j-last);
+        if (cost > rb or j-last >= max_gap) {
+            marked[j] = 1;
+            ++cnt; last = j; cost = 0;
+        }
+    }
+    return cnt;
+}
+
+//! Stores the SA and ISA values of text positions which are chosen by a weight for each text position.
+/*! The sampled text positions are calculated by calculate_weighted_samples from the weights
+ *  which are passed to init, e.g. the number of times each text position was located in a query
+ *  log. As many positions as by a uniform sampling with density t_dens are sampled, but the
+ *  positions are placed such that heavy positions are reached with few LF steps; the distance
+ *  of two sampled positions is at most t_max_gap. Without weights every t_dens-th text
+ *  position is sampled.
+ *
+ *  The sampled positions are marked in the bit vector of the suffix array positions and in
+ *  the bit vector of the text positions. The sample of the k-th marked suffix array position
+ *  is the index of its text position among the sampled ones, and the ISA sample of the j-th
+ *  sampled text position is its suffix array position. So csa_wt also uses these samples
+ *  for the ISA values (see isa_sample_at_or_after).
+ *
+ *  \tparam t_dens        The average sample density \f$s_{SA}\f$.
+ *  \tparam t_int_vector  The type of the vectors which store the samples.
+ *  \tparam t_bit_vector  The type of the bit vectors which mark the sampled positions.
+ *  \tparam t_max_gap     The maximal distance between two sampled text positions.
+ */
+template<uint32_t t_dens,
+         class t_int_vector = int_vector<>,
+         class t_bit_vector = sd_vector<>,
+         uint32_t t_max_gap = 4*t_dens>
+class weighted_sa_sample
+{
+    public:
+        typedef typename t_int_vector::size_type  size_type;
+        typedef typename t_int_vector::value_type value_type;
+        typedef t_bit_vector                      bit_vector_type;
+        typedef typename t_bit_vector::rank_1_type   rank_type;
+        typedef typename t_bit_vector::select_1_type select_type;
+        enum { sample_dens = t_dens };
+    private:
+        t_bit_vector m_marked;        // m_marked[i]=1 iff SA[i] is sampled
+        rank_type    m_rank_marked;   // rank support for m_marked
+        t_bit_vector m_text;          // m_text[j]=1 iff text position j is sampled
+        rank_type    m_rank_text;     // rank support for m_text
+        select_type  m_select_text;   // select support for m_text
+        t_int_vector m_samples;       // index of SA[i] among the sampled text positions for the marked positions i
+        t_int_vector m_isa_samples;   // ISA values of the sampled text positions
+        bit_vector       m_tmp_text;      // only used during construction
+        rank_support_v<> m_tmp_rank_text; // only used during construction
+
+        void copy(const weighted_sa_sample& s) {
+            m_marked = s.m_marked;
+            m_rank_marked = s.m_rank_marked;
+            m_rank_marked.set_vector(&m_marked);
+            m_text = s.m_text;
+            m_rank_text = s.m_rank_text;
+            m_rank_text.set_vector(&m_text);
+            m_select_text = s.m_select_text;
+            m_select_text.set_vector(&m_text);
+            m_samples = s.m_samples;
+            m_isa_samples = s.m_isa_samples;
+        }
+    public:
+        weighted_sa_sample() {}
+
+        weighted_sa_sample(const weighted_sa_sample& s) {
+            copy(s);
+        }
+
+        weighted_sa_sample& operator=(const weighted_sa_sample& s) {
+            if (this != &s) {
+                copy(s);
+            }
+            return *this;
+        }
+
+        //! Prepares the construction of the samples of a suffix array of size n.
+        /*! \param weights If not NULL, a vector of size n which contains the weight of each text position.
+         */
+        void init(size_type n, const int_vector<>* weights=NULL) {
+            if (weights != NULL and weights->size() != n)
+                throw std::logic_error("weighted_sa_sample: the number of weights differs from the text size");
+            size_type m = (n+t_dens-1)/t_dens;
+            if (weights != NULL) {
+                m = calculate_weighted_samples(*weights, m, t_max_gap, m_tmp_text);
+            } else {
+                util::assign(m_tmp_text, bit_vector(n, 0));
+                for (size_type j=0; j < n; j += t_dens)
+                    m_tmp_text[j] = 1;
+            }
+            util::init_support(m_tmp_rank_text, &m_tmp_text);
+            m_isa_samples.set_int_width(bit_magic::l1BP(n)+1);
+            util::check_int_width(m_isa_samples, n-(n>0), "weighted_sa_sample");
+            m_isa_samples.resize(m);
+        }
+
+        //! Adds the suffix array value sa of position i.
+        void add(size_type i, size_type sa) {
+            if (m_tmp_text[sa]) {
+                m_isa_samples[m_tmp_rank_text(sa)] = i;
+            }
+        }
+
+        //! Builds the bit vectors and the samples from the added values.
+        void finish() {
+            bit_vector marked(m_tmp_text.size(), 0);
+            for (size_type j=0; j < m_isa_samples.size(); ++j) {
+                marked[m_isa_samples[j]] = 1;
+            }
+            rank_support_v<> rank_marked(&marked);
+            m_samples.set_int_width(bit_magic::l1BP(m_isa_samples.size())+1);
+            util::check_int_width(m_samples, m_isa_samples.size()-(m_isa_samples.size()>0), "weighted_sa_sample");
+            m_samples.resize(m_isa_samples.size());
+            for (size_type j=0; j < m_isa_samples.size(); ++j) {
+                m_samples[rank_marked(m_isa_samples[j])] = j;
+            }
+            t_bit_vector tmp(marked), tmp_text(m_tmp_text);
+            m_marked.swap(tmp);
+            m_text.swap(tmp_text);
+            util::init_support(m_rank_marked, &m_marked);
+            util::init_support(m_rank_text, &m_text);
+            util::init_support(m_select_text, &m_text);
+            util::clear(m_tmp_rank_text);
+            util::clear(m_tmp_text);
+        }
+
+        //! Returns if the suffix array value of position i is sampled.
+        bool is_sampled(size_type i)const {
+            return m_marked[i];
+        }
+
+        //! Returns the suffix array value of the sampled suffix array position i.
+        /*! \pre is_sampled(i)
+         */
+        value_type sa_value(size_type i)const {
+            return m_select_text(m_samples[m_rank_marked(i)]+1);
+        }
+
+        //! Number of samples.
+        size_type size()const {
+            return m_samples.size();
+        }
+
+        //! Calculates the first sampled text position pos >= i and its ISA value isa.
+        /*! \return False if no text position >= i is sampled.
+         */
+        bool isa_sample_at_or_after(size_type i, size_type& pos, size_type& isa)const {
+            size_type j = m_rank_text(i);
+            if (j >= m_isa_samples.size())
+                return false;
+            pos = m_select_text(j+1);
+            isa = m_isa_samples[j];
+            return true;
+        }
+
+        bool operator==(const weighted_sa_sample& s)const {
+            if (m_samples != s.m_samples or m_isa_samples != s.m_isa_samples or m_text.size() != s.m_text.size())
+                return false;
+            for (size_type j=0; j < m_text.size(); ++j) {
+                if (m_text[j] != s.m_text[j])
+                    return false;
+            }
+            return true;
+        }
+
+        bool operator!=(const weighted_sa_sample& s)const {
+            return !(*this == s);
+        }
+
+        void swap(weighted_sa_sample& s) {
+            if (this != &s) {
+                m_marked.swap(s.m_marked);
+                util::swap_support(m_rank_marked, s.m_rank_marked, &m_marked, &s.m_marked);
+                m_text.swap(s.m_text);
+                util::swap_support(m_rank_text, s.m_rank_text, &m_text, &s.m_text);
+                util::swap_support(m_select_text, s.m_select_text, &m_text, &s.m_text);
+                m_samples.swap(s.m_samples);
+                m_isa_samples.swap(s.m_isa_samples);
+            }
+        }
+
+        size_type serialize(std::ostream& out, structure_tree_node* v=NULL, std::string name="")const {
+            structure_tree_node* child = structure_tree::add_child(v, name, util::class_name(*this));
+            size_type written_bytes = 0;
+            written_bytes += m_marked.serialize(out, child, "marked");
+            written_bytes += m_rank_marked.serialize(out, child, "rank_marked");
+            written_bytes += m_text.serialize(out, child, "text");
+            written_bytes += m_rank_text.serialize(out, child, "rank_text");
+            written_bytes += m_select_text.serialize(out, child, "select_text");
+            written_bytes += m_samples.serialize(out, child, "samples");
+            written_bytes += m_isa_samples.serialize(out, child, "isa_samples");
+            structure_tree::add_size(child, written_bytes);
+            return written_bytes;
+        }
+
+        void load(std::istream& in) {
+            m_marked.load(in);
+            m_rank_marked.load(in, &m_marked);
+            m_text.load(in);
+            m_rank_text.load(in, &m_text);
+            m_select_text.load(in, &m_text);
+            m_samples.load(in);
+            m_isa_samples.load(in);
+        }
+};
+
+//! Selects the SA-order sampling sa_order_sa_sample for csa_wt and csa_sada.
+struct sa_order_sampling {
+    template<uint32_t t_dens, class t_int_vector>
+    struct sample {
+        typedef sa_order_sa_sample<t_dens, t_int_vector> type;
+    };
+};
+
+//! Selects the text-order sampling text_order_sa_sample with bit vector t_bit_vector for csa_wt and csa_sada.
+template<class t_bit_vector = sd_vector<>, class t_rank = typename t_bit_vector::rank_1_type>
+struct text_order_sampling {
+    template<uint32_t t_dens, class t_int_vector>
+    struct sample {
+        typedef text_order_sa_sample<t_dens, t_int_vector, t_bit_vector, t_rank> type;
+    };
+};
+
+//! Selects the weighted sampling weighted_sa_sample for csa_wt; the weights are passed in file_map["sample_weights"].
+/*! \tparam t_bit_vector     The type of the bit vectors which mark the sampled positions.
+ *  \tparam t_max_gap_factor The distance between two sampled text positions is at most t_max_gap_factor times the sample density.
+ */
+template<class t_bit_vector = sd_vector<>, uint32_t t_max_gap_factor = 4>
+struct weighted_sampling {
+    template<uint32_t t_dens, class t_int_vector>
+    struct sample {
+        typedef weighted_sa_sample<t_dens, t_int_vector, t_bit_vector, t_max_gap_factor*t_dens> type;
+    };
+};
+
+} // end namespace sdsl
+
+#endif
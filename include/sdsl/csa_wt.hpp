@@ -32,17 +32,21 @@
 #include "suffixarrays.hpp"
 #include "bwt_construct.hpp"
 #include "fast_cache.hpp"
+#include "csa_sampling.hpp"
+#include "csa_psi_support.hpp"
 #include <iostream>
 #include <algorithm> // for std::swap
 #include <cassert>
 #include <cstring> // for strlen
 #include <iomanip>
 #include <iterator>
+#include <utility> // for std::pair
+#include <vector>
 
 namespace sdsl
 {
 
-template<class WaveletTree = wt_huff<>, uint32_t SampleDens = 32, uint32_t InvSampleDens = 64,  uint8_t fixedIntWidth = 0, class charType=unsigned char> // forward declaration
+template<class WaveletTree = wt_huff<>, uint32_t SampleDens = 32, uint32_t InvSampleDens = 64,  uint8_t fixedIntWidth = 0, class charType=unsigned char, class SaSampling=sa_order_sampling, class PsiSupport=psi_select_support> // forward declaration
 class csa_wt;
 
 template<uint8_t fixedIntWidth>
@@ -87,12 +91,11 @@ class psi_of_csa_wt
         //! Calculate the \f$\Psi\f$ value at position i.
         /*!	\param i The index for which the \f$\Psi\f$ value should be calculated, \f$i\in [0..size()-1]\f$.
          *	\par Time complexity
-         *		\f$ \Order{\log |\Sigma|} \f$
+         *		\f$ \Order{\log |\Sigma|} \f$, or \f$ \Order{s_{\Psi}} \f$ if the psi support stores \f$\Psi\f$ (see psi_sample_support)
          */
         value_type operator[](size_type i)const {
             assert(m_csa_wt != NULL);
-            char_type c = algorithm::get_ith_character_of_the_first_row(i, *m_csa_wt);
-            return m_csa_wt->wavelet_tree.select(i - m_csa_wt->C[m_csa_wt->char2comp[c]] + 1 , c);
+            return m_csa_wt->m_psi_support(*m_csa_wt, i);
         }
 
         //! Apply \f$\Psi\f$ k times to the value at position i.
@@ -127,15 +130,11 @@ class psi_of_csa_wt
         value_type operator()(size_type i)const {
             assert(m_csa_wt != NULL);
             assert(i < size());
-            // (1) get the ith character in the bwt, this takes \f$\log |\Sigma| \f$ time with use of the wavelet tree
-//		value_type c = m_csa_wt->m_wavelet_tree[i];
-            // (2) next count how many symbols c are in the prefix [0..i-1] of the bwt, this takes \f$\log |\Sigma| \f$ time with use of the wavelet tree.
-//		size_type j = m_csa_wt->m_wavelet_tree.rank(i, c);
-            // TODO: (1) and (2) can be calculated in only one request to the wavelet tree -> method rank_ith_symbol !!!
+            // (1) get the ith character c in the bwt and (2) count how many symbols c are in the prefix [0..i-1]
+            // of the bwt; both are determined by one traversal of the wavelet tree.
+            std::pair<size_type, typename CsaWT::char_type> rc = inverse_select(m_csa_wt->m_wavelet_tree, i);
             // (3) calculate the position of the j+1 th c in the sorted string of the bwt in constant time.
-            typename CsaWT::char_type c;
-            size_type j = m_csa_wt->m_wavelet_tree.rank_ith_symbol(i,c); // see documentation of rank_ith_symbol in wt_huff
-            return m_csa_wt->C[ m_csa_wt->char2comp[c] ] + j;
+            return m_csa_wt->C[ m_csa_wt->char2comp[rc.second] ] + rc.first;
         }
 
         //! Apply LF k times to the value at position i.
@@ -209,9 +208,9 @@ class psi_of_csa_wt
             return const_iterator(this, size());
         }
 
-        // Get the number of sampled \f$\Psi\f$ values. In the wavelet tree approach the number of sampled (i.e. explicitly stored) \f$\Psi\f$ values is zero.
+        // Get the sample density of the \f$\Psi\f$ values. It is zero, if the psi support does not store \f$\Psi\f$ and calculates it with the wavelet tree.
         uint32_t get_sample_dens()const {
-            return 0;
+            return CsaWT::psi_support_type::sample_dens;
         }
 };
 
@@ -294,12 +293,26 @@ class bwt_of_csa_wt
 //! A class for the Compressed Suffix Array (CSA) based on a Wavelet Tree (WT) of the Burrow Wheeler Transform of the orignal text.
 /*! The CSA is parameterized with an WavletTree, the sample density SampleDens (\f$s_{SA}\f$), and the sample density for inverse suffix array entries (\f$s_{SA^{-1}}\f$).
   * I.e. every \f$s_{SA}th\f$ value from the original suffix array is explicitely stored with \f$\log n\f$ bits.
+  * With fixedIntWidth=32 the samples are stored in an int_vector<32>, so the construction throws
+  * std::length_error for texts with more than \f$2^{32}\f$ characters; use fixedIntWidth 0 or 64 for such texts.
+  * The sampling is selected by SaSampling: sa_order_sampling (default) samples every \f$s_{SA}th\f$
+  * suffix array position, text_order_sampling<> the suffixes which start at every \f$s_{SA}th\f$ text
+  * position (see text_order_sa_sample). The latter bounds the number of LF steps of an access
+  * by \f$s_{SA}-1\f$. weighted_sampling<> places the samples by a weight for each text position,
+  * which is passed in file_map["sample_weights"], and also uses them as ISA samples.
+  * PsiSupport calculates \f$\Psi\f$: psi_select_support (default) by a select query on the wavelet
+  * tree, psi_sample_support<> by decoding the \f$\Psi\f$ values, which it stores in an enc_vector.
+  *
+  * \par Thread safety
+  *  The const methods do not change the csa_wt, so a constructed csa_wt can be queried by
+  *  several threads concurrently. The optional caches for SA and ISA values (USE_CSA_CACHE,
+  *  see csa_cache_type) can also be read and written concurrently.
   *
   * \todo example, code example
   *  \sa sdsl::csa_sada, sdsl::csa_uncompressed
   * @ingroup csa
  */
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens,  uint8_t fixedIntWidth, class charType>
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens,  uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
 class csa_wt
 {
     public:
@@ -318,8 +331,9 @@ class csa_wt
         typedef WaveletTree											 wavelet_tree_type;
         typedef charType											 char_type;
         typedef const char_type*									 pattern_type;
-        typedef typename csa_wt_trait<fixedIntWidth>::int_vector_type sa_sample_type;
+        typedef typename SaSampling::template sample<SampleDens, typename csa_wt_trait<fixedIntWidth>::int_vector_type>::type sa_sample_type;
         typedef typename csa_wt_trait<fixedIntWidth>::int_vector_type isa_sample_type;
+        typedef PsiSupport                                           psi_support_type;
 
         typedef csa_tag													index_category;
 
@@ -338,6 +352,7 @@ class csa_wt
         bwt_type m_bwt;  // bwt
         sa_sample_type m_sa_sample; // suffix array samples
         isa_sample_type m_isa_sample; // inverse suffix array samples
+        psi_support_type m_psi_support; // calculates the psi function
         int_vector<8>	m_char2comp;
         int_vector<8>	m_comp2char;
 
@@ -346,7 +361,8 @@ class csa_wt
 //		uint32_t m_sample_dens; // additional to SampleDens value
 //#define USE_CSA_CACHE
 #ifdef USE_CSA_CACHE
-        mutable fast_cache csa_cache;
+        mutable csa_cache_type m_sa_cache;  // cache for SA values
+        mutable csa_cache_type m_isa_cache; // cache for ISA values
 #endif
 
         template<typename RandomAccessContainer>
@@ -355,10 +371,20 @@ class csa_wt
         template<typename RandomAccessContainer>
         void construct_samples(const RandomAccessContainer& sa, const char_type* str);
 
+        //! Removes the cached SA and ISA values, which belong to the previous content.
+        void clear_caches() {
+#ifdef USE_CSA_CACHE
+            m_sa_cache.clear();
+            m_isa_cache.clear();
+#endif
+        }
+
         void copy(const csa_wt& csa) {
+            clear_caches();
             m_wavelet_tree			= csa.m_wavelet_tree;
             m_sa_sample 			= csa.m_sa_sample;
             m_isa_sample 			= csa.m_isa_sample;
+            m_psi_support			= csa.m_psi_support;
             m_sigma					= csa.m_sigma;
             m_char2comp				= csa.m_char2comp;
             m_comp2char				= csa.m_comp2char;
@@ -404,9 +430,19 @@ class csa_wt
         template<class size_type_class>
         csa_wt(int_vector_file_buffer<8, size_type_class>& bwt_buf);
 
-        csa_wt(tMSS& file_map, const std::string& dir, const std::string& id);
+        //! Construct the csa_wt from the files in file_map
+        /*! If file_map contains no suffix array, the BWT is constructed by construct_bwt_blockwise
+         *  and the samples are calculated with the LF function, i.e. the suffix array is never
+         *  materialized.
+         *  \param threads Number of threads for the construction of the wavelet tree, if
+         *                 WaveletTree supports a multi-threaded construction.
+         *  If file_map["sample_weights"] names a stored int_vector<> with a weight for each text
+         *  position, the weights are passed to the SA samples (used by weighted_sampling).
+         *  construct_csa keeps this file, also if delete_files is true.
+         */
+        csa_wt(tMSS& file_map, const std::string& dir, const std::string& id, uint32_t threads=1);
 
-        void construct(tMSS& file_map, const std::string& dir, const std::string& id);
+        void construct(tMSS& file_map, const std::string& dir, const std::string& id, uint32_t threads=1);
 
         //! Number of elements in the \f$\CSA\f$.
         /*! Required for the Container Concept of the STL.
@@ -443,7 +479,7 @@ class csa_wt
 
         	Required for the Assignable Conecpt of the STL.
           */
-        void swap(csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>& csa);
+        void swap(csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>& csa);
 
         //! Returns a const_iterator to the first element.
         /*! Required for the STL Container Concept.
@@ -474,6 +510,31 @@ class csa_wt
          */
         inline value_type operator()(size_type i)const;
 
+#ifdef USE_CSA_CACHE
+        //! Returns the cache of the SA values, e.g. to read its hit and miss counters.
+        const csa_cache_type& sa_cache()const {
+            return m_sa_cache;
+        }
+
+        //! Returns the cache of the ISA values.
+        const csa_cache_type& isa_cache()const {
+            return m_isa_cache;
+        }
+#endif
+
+        //! Calculates the suffix array values of the interval [lb..rb].
+        /*! \param lb Left border of the interval, \f$ lb \in [0..size()-1]\f$.
+         *  \param rb Right border of the interval, \f$ rb \in [lb..size()-1]\f$.
+         *  \param sa Array of size rb-lb+1; sa[k] is set to the suffix array value at position lb+k.
+         *  All positions walk to their next sampled position together. In each step the LF values
+         *  of the remaining positions are calculated by one batched rank_ith_symbol call to the
+         *  wavelet tree, which therefore has to support it (e.g. wt_huff).
+         *  \par Time complexity
+         *      \f$ \Order{s_{SA}\cdot z \cdot t_{\Psi}} \f$, where \f$z=rb-lb+1\f$, but
+         *      the cache misses of the \f$z\f$ walks overlap.
+         */
+        void sa_interval(size_type lb, size_type rb, value_type* sa)const;
+
         //! Assignment Operator.
         /*!
          *	Required for the Assignable Concept of the STL.
@@ -548,8 +609,8 @@ class csa_wt
 
 // == template functions ==
 
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType>
-csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::csa_wt(const char_type* str):char2comp(m_char2comp), comp2char(m_comp2char), C(m_C), sigma(m_sigma), psi(m_psi), bwt(m_bwt), sa_sample(m_sa_sample), isa_sample(m_isa_sample), wavelet_tree(m_wavelet_tree)
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::csa_wt(const char_type* str):char2comp(m_char2comp), comp2char(m_comp2char), C(m_C), sigma(m_sigma), psi(m_psi), bwt(m_bwt), sa_sample(m_sa_sample), isa_sample(m_isa_sample), wavelet_tree(m_wavelet_tree)
 {
     csa_uncompressed sa(str);
     /*	size_type n = strlen((const char*)str);
@@ -563,9 +624,9 @@ csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::csa_wt(
 //		throw std::logic_error(util::demangle(typeid(this).name())+": text size differ with sa size!");
 }
 
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType>
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
 template<typename RandomAccessContainer>
-csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::csa_wt(const RandomAccessContainer& sa, const char_type* str):char2comp(m_char2comp), comp2char(m_comp2char),C(m_C), sigma(m_sigma), psi(m_psi), bwt(m_bwt),sa_sample(m_sa_sample), isa_sample(m_isa_sample),wavelet_tree(m_wavelet_tree)
+csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::csa_wt(const RandomAccessContainer& sa, const char_type* str):char2comp(m_char2comp), comp2char(m_comp2char),C(m_C), sigma(m_sigma), psi(m_psi), bwt(m_bwt),sa_sample(m_sa_sample), isa_sample(m_isa_sample),wavelet_tree(m_wavelet_tree)
 {
     size_type n = 1;
     if (str != NULL) {
@@ -578,9 +639,9 @@ csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::csa_wt(
         throw std::logic_error(util::demangle(typeid(this).name())+": text size differ with sa size! ");
 }
 
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType>
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
 template<class size_type_class, uint8_t int_width, class size_type_class_1>
-csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::csa_wt(int_vector_file_buffer<8, size_type_class>& bwt_buf,
+csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::csa_wt(int_vector_file_buffer<8, size_type_class>& bwt_buf,
         int_vector_file_buffer<int_width, size_type_class_1>& sa_buf):char2comp(m_char2comp), comp2char(m_comp2char),C(m_C), sigma(m_sigma), psi(m_psi), bwt(m_bwt),sa_sample(m_sa_sample),isa_sample(m_isa_sample),wavelet_tree(m_wavelet_tree)
 {
     bwt_buf.reset(); sa_buf.reset();
@@ -595,12 +656,13 @@ csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::csa_wt(
 
     m_psi = psi_type(this);
     m_bwt = bwt_type(this);
+    m_psi_support.construct(*this);
 }
 
 
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType>
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
 template<class size_type_class>
-csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::csa_wt(int_vector_file_buffer<8, size_type_class>& bwt_buf):char2comp(m_char2comp), comp2char(m_comp2char),C(m_C), sigma(m_sigma), psi(m_psi), bwt(m_bwt),sa_sample(m_sa_sample),isa_sample(m_isa_sample),wavelet_tree(m_wavelet_tree)
+csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::csa_wt(int_vector_file_buffer<8, size_type_class>& bwt_buf):char2comp(m_char2comp), comp2char(m_comp2char),C(m_C), sigma(m_sigma), psi(m_psi), bwt(m_bwt),sa_sample(m_sa_sample),isa_sample(m_isa_sample),wavelet_tree(m_wavelet_tree)
 {
     if (SampleDens != 0 or InvSampleDens !=0) {
         std::cerr << "Warning: Construct only the BWT part of the CSA, please make sure SampleDens and InvSampleDens equal 0!" << std::endl;
@@ -613,35 +675,55 @@ csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::csa_wt(
 
     m_psi = psi_type(this);
     m_bwt = bwt_type(this);
+    m_psi_support.construct(*this);
 }
 
 
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType>
-csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::csa_wt(tMSS& file_map, const std::string& dir, const std::string& id):char2comp(m_char2comp), comp2char(m_comp2char),C(m_C), sigma(m_sigma), psi(m_psi), bwt(m_bwt),sa_sample(m_sa_sample),isa_sample(m_isa_sample),wavelet_tree(m_wavelet_tree)
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::csa_wt(tMSS& file_map, const std::string& dir, const std::string& id, uint32_t threads):char2comp(m_char2comp), comp2char(m_comp2char),C(m_C), sigma(m_sigma), psi(m_psi), bwt(m_bwt),sa_sample(m_sa_sample),isa_sample(m_isa_sample),wavelet_tree(m_wavelet_tree)
 {
-    construct(file_map, dir, id);
+    construct(file_map, dir, id, threads);
 }
 
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType>
-void csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::construct(tMSS& file_map, const std::string& dir, const std::string& id)
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+void csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::construct(tMSS& file_map, const std::string& dir, const std::string& id, uint32_t threads)
 {
+    clear_caches();
+    bool sa_exists = (file_map.find("sa") != file_map.end());
     if (file_map.find("bwt") == file_map.end()) { // if bwt is not already stored on disk => construct bwt
-        construct_bwt(file_map, dir, id);
+        if (sa_exists)
+            construct_bwt(file_map, dir, id);
+        else
+            construct_bwt_blockwise(file_map, dir, id);
 //		construct_bwt2(file_map, dir, id);
     }
     int_vector_file_buffer<8> bwt_buf(file_map["bwt"].c_str());
-    int_vector_file_buffer<>  sa_buf(file_map["sa"].c_str());
     size_type n = bwt_buf.int_vector_size;
     algorithm::set_text<csa_wt>(bwt_buf, n, m_C, m_char2comp, m_comp2char, m_sigma);
 //	m_wavelet_tree = WaveletTree(bwt_buf, n);
     write_R_output("csa", "construct WT", "begin", 1, 0);
-    m_wavelet_tree.construct(bwt_buf, n);
+    construct_wavelet_tree(m_wavelet_tree, bwt_buf, n, threads);
     write_R_output("csa", "construct WT", "end", 1, 0);
 
-    algorithm::set_sa_and_isa_samples<csa_wt>(sa_buf, m_sa_sample, m_isa_sample);
-
     m_psi = psi_type(this);
     m_bwt = bwt_type(this);
+    m_psi_support.construct(*this);
+
+    int_vector<> weights;
+    const int_vector<>* w = NULL;
+    if (file_map.find("sample_weights") != file_map.end()) {
+        if (!util::load_from_file(weights, file_map["sample_weights"].c_str()))
+            throw std::ios_base::failure("csa_wt: cannot load the sample weights "+file_map["sample_weights"]);
+        w = &weights;
+    }
+    if (sa_exists) {
+        int_vector_file_buffer<>  sa_buf(file_map["sa"].c_str());
+        algorithm::set_sa_and_isa_samples<csa_wt>(sa_buf, m_sa_sample, m_isa_sample, w);
+    } else { // sample with the LF function
+        write_R_output("csa", "sample SA", "begin", 1, 0);
+        algorithm::set_sa_and_isa_samples_by_lf<csa_wt, wt_huff<> >(bwt_buf, m_sa_sample, m_isa_sample, w);
+        write_R_output("csa", "sample SA", "end", 1, 0);
+    }
 }
 
 /*
@@ -659,41 +741,40 @@ void csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth>::set_sample_d
 }
 */
 
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType>
-uint32_t csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::get_psi_sample_dens()const
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+uint32_t csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::get_psi_sample_dens()const
 {
     return m_psi.get_sample_dens();
 }
 
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType>
-void csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::set_psi_sample_dens(const uint32_t sample_dens)
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+void csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::set_psi_sample_dens(const uint32_t sample_dens)
 {
 }
 
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType>
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
 template<typename RandomAccessContainer>
-void csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::construct_samples(const RandomAccessContainer& sa, const char_type* str)
+void csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::construct_samples(const RandomAccessContainer& sa, const char_type* str)
 {
-    m_sa_sample.set_int_width(bit_magic::l1BP(sa.size())+1);
-    m_sa_sample.resize((sa.size()+SampleDens-1)/SampleDens);
-    typename RandomAccessContainer::size_type i=0, idx=0;
-    for (typename RandomAccessContainer::const_iterator it = sa.begin(); i < sa.size(); it += (difference_type)SampleDens, i += SampleDens, ++idx) {
-        m_sa_sample[idx] = *it;
-    }
+    m_sa_sample.init(sa.size());
     m_isa_sample.set_int_width(bit_magic::l1BP(sa.size())+1);
+    util::check_int_width(m_isa_sample, sa.size()-(sa.size()>0), "isa_sample");
     m_isa_sample.resize((sa.size()+(InvSampleDens)-1)/(InvSampleDens));
-    i = 0;
+    typename RandomAccessContainer::size_type i = 0;
     for (typename RandomAccessContainer::const_iterator it = sa.begin(), end = sa.end(); it != end; ++it, ++i) {
+        m_sa_sample.add(i, *it);
         if ((*it % InvSampleDens) == 0) {
             m_isa_sample[*it/InvSampleDens] = i;
         }
     }
+    m_sa_sample.finish();
 }
 
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType>
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
 template<typename RandomAccessContainer>
-void csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::construct(const RandomAccessContainer& sa, const char_type* str)
+void csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::construct(const RandomAccessContainer& sa, const char_type* str)
 {
+    clear_caches();
     construct_samples(sa, str);
     const typename RandomAccessContainer::size_type n = sa.size();
     typename RandomAccessContainer::size_type i=0;
@@ -712,85 +793,107 @@ void csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::co
 
         m_psi = psi_type(this);
         m_bwt = bwt_type(this);
+        m_psi_support.construct(*this);
     }
 }
 
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType>
-typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::const_iterator csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::begin()const
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::const_iterator csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::begin()const
 {
     return const_iterator(this, 0);
 }
 
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType>
-typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::const_iterator csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::end()const
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::const_iterator csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::end()const
 {
     return const_iterator(this, size());
 }
 
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType>
-inline typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::value_type csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::operator[](size_type i)const
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+inline typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::value_type csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::operator[](size_type i)const
 {
+#ifdef USE_CSA_CACHE
+    size_type r = 0;
+    if (m_sa_cache.exists(i, r)) {
+        return r;
+    }
+    const size_type j = i;
+#endif
     size_type off = 0;
-    while (i % SampleDens) {
+    while (!m_sa_sample.is_sampled(i)) {
         i = m_psi(i);
         ++off;
     }
-    value_type result = m_sa_sample[i/SampleDens];
-    if (result + off < size()) {
-        return result + off;
-    } else {
-        return result + off - size();
+    value_type result = m_sa_sample.sa_value(i) + off;
+    if (result >= size()) {
+        result -= size();
     }
-    /*
-    #ifdef USE_CSA_CACHE
-    	size_type r = 0;
-    	if( csa_cache.exists(i, r) ){
-    		return r;
-    	}
-    #endif
-    	size_type off = 0;
-    	while( i % SampleDens ){// while i mod SampleDens != 0 (SA[i] is not sampled)
-    		i = m_psi[i];       // go to the position where SA[i]+1 is located
-    		++off;              // add 1 to the offset
-    	}
-    	value_type result = m_sa_sample[i/SampleDens];
-    	// TODO: try LF-function for iteration
-    	if( result < off ){
-    #ifdef USE_CSA_CACHE
-    		r = m_psi.size()-(off-result);
-    		return r;
-    #endif
-    		return m_psi.size()-(off-result);
-    	}
-    	else{
-    #ifdef USE_CSA_CACHE
-    		r = result-off;
-    		return r;
-    #endif
-    		return result-off;
-    	}
-    */
+#ifdef USE_CSA_CACHE
+    m_sa_cache.write(j, result);
+#endif
+    return result;
 }
 
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType>
-inline typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::value_type csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::operator()(size_type i)const
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+inline typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::value_type csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::operator()(size_type i)const
 {
-    size_type ii;
-    value_type result = m_isa_sample[ ii = ((i+InvSampleDens-1)/InvSampleDens) ]; // get the leftmost sampled isa value to the right of i
-    ii *= InvSampleDens;
-    if (ii >= size()) {
-        i = size() - 1 - i;
-    } else {
-        i = ii - i;
+#ifdef USE_CSA_CACHE
+    size_type r = 0;
+    if (m_isa_cache.exists(i, r)) {
+        return r;
     }
+    const size_type j = i;
+#endif
+    size_type ii;
+    value_type result = algorithm::isa_sample_at_or_after(*this, i, ii); // get the leftmost sampled isa value to the right of i
+    i = ii - i;
     while (i--) {
         result = m_psi(result);
     }
+#ifdef USE_CSA_CACHE
+    m_isa_cache.write(j, result);
+#endif
     return result;
 }
 
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType>
-csa_wt<WaveletTree,SampleDens, InvSampleDens, fixedIntWidth, charType>& csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::operator=(const csa_wt<WaveletTree,SampleDens, InvSampleDens, fixedIntWidth, charType>& csa)
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+void csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::sa_interval(size_type lb, size_type rb, value_type* sa)const
+{
+    assert(lb <= rb and rb < size());
+    if (rb-lb < 4) { // too few walks to overlap
+        for (size_type i=lb; i <= rb; ++i)
+            sa[i-lb] = (*this)[i];
+        return;
+    }
+    std::vector<std::pair<size_type, size_type> > active; // pairs (current position, index in sa)
+    active.reserve(rb-lb+1);
+    for (size_type i=lb; i <= rb; ++i)
+        active.push_back(std::make_pair(i, i-lb));
+    std::vector<size_type> pos(active.size()), rank(active.size());
+    std::vector<typename WaveletTree::value_type> c(active.size());
+    for (size_type off=0; !active.empty(); ++off) {
+        size_type m = 0;
+        for (size_type j=0; j < active.size(); ++j) {
+            size_type i = active[j].first;
+            if (m_sa_sample.is_sampled(i)) {
+                value_type result = m_sa_sample.sa_value(i) + off;
+                sa[active[j].second] = result < size() ? result : result - size();
+            } else {
+                active[m++] = active[j];
+            }
+        }
+        active.resize(m);
+        for (size_type j=0; j < m; ++j)
+            pos[j] = active[j].first;
+        if (m > 0)
+            m_wavelet_tree.rank_ith_symbol(&pos[0], m, &rank[0], &c[0]);
+        for (size_type j=0; j < m; ++j)
+            active[j].first = m_C[m_char2comp[c[j]]] + rank[j]; // LF
+    }
+}
+
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+csa_wt<WaveletTree,SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>& csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::operator=(const csa_wt<WaveletTree,SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>& csa)
 {
     if (this != &csa) {
         copy(csa);
@@ -799,14 +902,15 @@ csa_wt<WaveletTree,SampleDens, InvSampleDens, fixedIntWidth, charType>& csa_wt<W
 }
 
 
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType>
-typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::size_type csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::serialize(std::ostream& out, structure_tree_node* v, std::string name)const
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::size_type csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::serialize(std::ostream& out, structure_tree_node* v, std::string name)const
 {
     structure_tree_node* child = structure_tree::add_child(v, name, util::class_name(*this));
     size_type written_bytes = 0;
     written_bytes += m_wavelet_tree.serialize(out, child, "wavelet_tree");
     written_bytes += m_sa_sample.serialize(out, child, "sa_samples");
     written_bytes += m_isa_sample.serialize(out, child, "isa_samples");
+    written_bytes += m_psi_support.serialize(out, child, "psi_support");
     written_bytes += m_char2comp.serialize(out, child, "char2comp");
     written_bytes += m_comp2char.serialize(out, child, "comp2char");
     written_bytes += m_C.serialize(out, child, "C");
@@ -815,12 +919,14 @@ typename csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>
     return written_bytes;
 }
 
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType>
-void csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::load(std::istream& in)
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+void csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::load(std::istream& in)
 {
+    clear_caches();
     m_wavelet_tree.load(in);
     m_sa_sample.load(in);
     m_isa_sample.load(in);
+    m_psi_support.load(in);
     m_char2comp.load(in);
     m_comp2char.load(in);
     m_C.load(in);
@@ -829,13 +935,14 @@ void csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::lo
     m_bwt = bwt_type(this);
 }
 
-template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType>
-void csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::swap(csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>& csa)
+template<class WaveletTree, uint32_t SampleDens, uint32_t InvSampleDens, uint8_t fixedIntWidth, class charType, class SaSampling, class PsiSupport>
+void csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>::swap(csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType, SaSampling, PsiSupport>& csa)
 {
     if (this != &csa) {
         m_wavelet_tree.swap(csa.m_wavelet_tree);
         m_sa_sample.swap(csa.m_sa_sample);
         m_isa_sample.swap(csa.m_isa_sample);
+        m_psi_support.swap(csa.m_psi_support);
         m_char2comp.swap(csa.m_char2comp);
         m_comp2char.swap(csa.m_comp2char);
         m_C.swap(csa.m_C);
@@ -845,6 +952,8 @@ void csa_wt<WaveletTree, SampleDens, InvSampleDens, fixedIntWidth, charType>::sw
         csa.m_psi = psi_type(&csa);
         m_bwt = bwt_type(this);
         csa.m_bwt = bwt_type(&csa);
+        clear_caches();
+        csa.clear_caches();
     }
 }
 
@@ -65,7 +65,8 @@ bool construct_cst(std::string file_name, Cst& cst)
  *  \param dir				A directory path which points to the directory where the calculated files should be stored during the construction.
  *	\param build_only_bps   Boolean flag. If it is true, only the navigation part of the cst is build. I.e. compressed suffix array and other stuff is ommitted...
  *  \param lcp_method		Specify, which lcp construction algorithm should be used. Possible options are
- *								kasai, PHI, go, go2, any
+ *								kasai, PHI, PHIpar, go, go2, any. PHIpar is the PHI algorithm with
+ *								one thread per processor (see construct_lcp_PHI_parallel).
  *
  *	\par Space complexity
  *		\f$5n\f$ bytes
@@ -146,6 +147,8 @@ static bool construct_cst(Cst& cst, tMSS& file_map, bool delete_files=true, std:
                 construct_lcp_goPHI(file_map, dir, id);
             } else if (lcp_method=="PHI")
                 construct_lcp_PHI(file_map, dir, id);
+            else if (lcp_method=="PHIpar")
+                construct_lcp_PHI_parallel(file_map, dir, id, parallel::hardware_threads());
             else if (lcp_method=="PHIse")
                 construct_lcp_PHI(file_map, dir, id, true);
             else if (lcp_method=="simple_n5")
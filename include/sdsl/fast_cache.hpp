@@ -1,39 +1,185 @@
-
 #ifndef INCLUDED_SDSL_FAST_CACHE
 #define INCLUDED_SDSL_FAST_CACHE
 
 #include "int_vector.hpp"
+#include <vector>
 
 namespace sdsl
 {
 
-#define CACHE_SIZE 0x3FFULL
+//! Replacement policy of query_cache: the ways of a set are replaced in turn.
+struct cache_replace_fifo {
+    template<class Set>
+    static void hit(Set&, uint32_t) {}
 
-struct fast_cache {
-    typedef int_vector<>::size_type size_type;
-    size_type m_table[2*(CACHE_SIZE+1)];
-    // Constructor
-    fast_cache() {
-        for (size_type i=0; i < (CACHE_SIZE+1); ++i) {
-            m_table[i<<1] = (size_type)-1;
-        }
+    template<class Set>
+    static uint32_t victim(Set& s, uint32_t ways) {
+        return (s.tick++) % ways;
     }
-    // Returns true if the request i is cached and
-    // x is set to the answer of request i
-    bool exists(size_type i, size_type& x) {
-        if (m_table[(i&CACHE_SIZE)<<1 ] == i) {
-            x = m_table[((i&CACHE_SIZE)<<1) + 1 ];
-            return true;
-        } else
-            return false;
+};
+
+//! Replacement policy of query_cache: the least recently used way of a set is replaced.
+/*! The access times are updated without synchronization, so with concurrent
+ *  queries the replaced way is only approximately the least recently used one.
+ *  A hit only writes the set if the way is not already the most recently used
+ *  one, so frequently read entries do not cause write traffic between threads.
+ */
+struct cache_replace_lru {
+    template<class Set>
+    static void hit(Set& s, uint32_t way) {
+        if (s.entry[way].stamp != s.tick or 0 == s.tick) // repeated hits on the most recently used way do not write
+            s.entry[way].stamp = ++s.tick;
     }
-    // Writes the answer for request i to the cache
-    void write(size_type i, size_type x) {
-        m_table[(i&CACHE_SIZE)<<1 ] = i;
-        m_table[((i&CACHE_SIZE)<<1) + 1 ] = x;
+
+    template<class Set>
+    static uint32_t victim(Set& s, uint32_t ways) {
+        uint32_t v = 0;
+        for (uint32_t w=1; w < ways; ++w) {
+            if (s.entry[w].stamp < s.entry[v].stamp)
+                v = w;
+        }
+        return v;
     }
 };
 
+//! A set associative cache for the answers of const queries (e.g. SA, ISA or LCP values).
+/*!
+ *  \tparam t_log_sets The cache consists of \f$2^{t\_log\_sets}\f$ sets; request i is mapped to set i mod \f$2^{t\_log\_sets}\f$.
+ *  \tparam t_ways     The number of entries per set.
+ *  \tparam t_replace  The replacement policy, cache_replace_fifo or cache_replace_lru.
+ *  \tparam t_count    If true, the hits and misses of exists are counted.
+ *
+ *  Each entry is protected by a version, which is odd while the entry is written.
+ *  A reader only reports a hit if the version did not change while it read the entry,
+ *  and a writer skips an entry which is written by another thread. So exists and write
+ *  can be called concurrently by several threads without locks.
+ */
+template<uint8_t t_log_sets=10, uint32_t t_ways=1, class t_replace=cache_replace_fifo, bool t_count=false>
+class query_cache
+{
+    public:
+        typedef int_vector<>::size_type size_type;
+
+        struct entry_type {
+            volatile size_type version; // odd while the entry is written
+            volatile size_type request;
+            volatile size_type answer;
+            volatile size_type stamp;   // used by the replacement policy
+        };
+
+        struct set_type {
+            entry_type entry[t_ways];
+            volatile size_type tick;   // used by the replacement policy
+        };
+
+    private:
+        std::vector<set_type> m_sets;
+        volatile size_type    m_hits;
+        volatile size_type    m_misses;
+
+    public:
+        query_cache():m_sets(1ULL<<t_log_sets), m_hits(0), m_misses(0) {
+            clear();
+        }
+
+        //! Removes all entries and sets the counters to zero.
+        /*! Must not be called concurrently with exists or write. The owner of the
+         *  cache calls clear whenever the answers of the cached requests change,
+         *  e.g. in load, swap and operator=.
+         */
+        void clear() {
+            for (size_type s=0; s < m_sets.size(); ++s) {
+                for (uint32_t w=0; w < t_ways; ++w) {
+                    m_sets[s].entry[w].version = 0;
+                    m_sets[s].entry[w].request = (size_type)-1;
+                    m_sets[s].entry[w].stamp = 0;
+                }
+                m_sets[s].tick = 0;
+            }
+            m_hits = m_misses = 0;
+        }
+
+        //! Returns true if request i is cached and sets x to the answer of request i.
+        bool exists(size_type i, size_type& x) {
+            set_type& s = m_sets[i & (m_sets.size()-1)];
+            for (uint32_t w=0; w < t_ways; ++w) {
+                entry_type& e = s.entry[w];
+                size_type version = e.version;
+                if (version & 1)  // the entry is written
+                    continue;
+                __sync_synchronize();
+                if (e.request == i) {
+                    x = e.answer;
+                    __sync_synchronize();
+                    if (e.version == version) {
+                        t_replace::hit(s, w);
+                        if (t_count)
+                            __sync_fetch_and_add(&m_hits, 1);
+                        return true;
+                    }
+                }
+            }
+            if (t_count)
+                __sync_fetch_and_add(&m_misses, 1);
+            return false;
+        }
+
+        //! Writes the answer x of request i to the cache.
+        void write(size_type i, size_type x) {
+            set_type& s = m_sets[i & (m_sets.size()-1)];
+            uint32_t w = 0;
+            while (w < t_ways and s.entry[w].request != i and s.entry[w].request != (size_type)-1)
+                ++w;
+            if (w == t_ways)
+                w = t_replace::victim(s, t_ways);
+            entry_type& e = s.entry[w];
+            size_type version = e.version;
+            if ((version & 1) or !__sync_bool_compare_and_swap(&e.version, version, version+1))
+                return; // another thread writes the entry
+            e.request = i;
+            e.answer = x;
+            t_replace::hit(s, w);
+            __sync_synchronize();
+            e.version = version+2;
+        }
+
+        //! Number of successful calls of exists (only counted if t_count is true).
+        size_type hits()const {
+            return m_hits;
+        }
+
+        //! Number of unsuccessful calls of exists (only counted if t_count is true).
+        size_type misses()const {
+            return m_misses;
+        }
+
+        //! Sets the counters of hits and misses to zero.
+        void reset_counters() {
+            m_hits = m_misses = 0;
+        }
+
+        //! Number of entries of the cache.
+        static size_type capacity() {
+            return (1ULL<<t_log_sets) * t_ways;
+        }
+};
+
+//! The direct mapped cache with 1024 entries, which is used by bp_support_sada.
+typedef query_cache<10, 1, cache_replace_fifo> fast_cache;
+
+// The cache types of the SA and ISA values of csa_wt and csa_sada (if USE_CSA_CACHE is defined)
+// and of the LCP values of lcp_support_tree (if USE_LCP_CACHE is defined). They can be
+// set at compile time, e.g. -DSDSL_CSA_CACHE_TYPE="sdsl::query_cache<16,4,sdsl::cache_replace_lru,true>"
+#ifndef SDSL_CSA_CACHE_TYPE
+#define SDSL_CSA_CACHE_TYPE query_cache<12, 4, cache_replace_lru>
+#endif
+#ifndef SDSL_LCP_CACHE_TYPE
+#define SDSL_LCP_CACHE_TYPE query_cache<12, 4, cache_replace_lru>
+#endif
+
+typedef SDSL_CSA_CACHE_TYPE csa_cache_type;
+typedef SDSL_LCP_CACHE_TYPE lcp_cache_type;
+
 } // end namespace sdsl
 
 #endif
@@ -345,6 +345,8 @@ class int_vector
         friend void util::set_random_bits<int_vector>(int_vector& v, int);
         friend void util::set_zero_bits<int_vector>(int_vector& v);
         friend void util::set_one_bits<int_vector>(int_vector& v);
+        friend void util::set_one_bits_atomic<int_vector>(int_vector& v, uint64_t idx, uint8_t len);
+        friend void util::or_bits_atomic<int_vector>(int_vector& v, uint64_t idx, uint64_t x, uint8_t len);
         friend void util::bit_compress<int_vector>(int_vector& v);
         friend void util::set_all_values_to_k<int_vector>(int_vector& v, uint64_t k);
         friend void algorithm::calculate_sa<fixedIntWidth>(const unsigned char* c, typename int_vector<fixedIntWidth>::size_type len, int_vector<fixedIntWidth>& sa);
@@ -1140,7 +1142,7 @@ int_vector<fixedIntWidth,size_type_class>::~int_vector()
 {
 	mm::remove( this );
     if (m_data != NULL) {
-        free(m_data); //fixed delete
+        mm::free_mem(m_data); //fixed delete
     }
 }
 
@@ -1180,8 +1182,9 @@ void int_vector<fixedIntWidth,size_type_class>::bit_resize(const size_type size)
         // We need this padding since rank data structures do a memory
         // access to this padding to answer rank(size()) if size()%64 ==0.
         // Note that this padding is not counted in the serialize method!
-        data = (uint64_t*)realloc(m_data, (((m_size+64)>>6)<<3)); // if m_data == NULL realloc
+        data = mm::realloc_mem(m_data, (((old_size+64)>>6)<<3), (((m_size+64)>>6)<<3)); // if m_data == NULL realloc
         // Method realloc is equivalent to malloc if m_data == NULL.
+        // If m_data points into a mapped file, the content is copied into malloced memory.
         // If size is zero and ptr is not NULL, a new, minimum sized object is allocated and the original object is freed.
         // The allocated memory is aligned such that it can be used for any data type, including AltiVec- and SSE-related types.
         m_data = data;
@@ -1491,6 +1494,7 @@ typename int_vector<fixedIntWidth,size_type_class>::size_type int_vector<fixedIn
     } else {
         written_bytes += _sdsl_serialize_size_and_int_width(out, fixedIntWidth, m_int_width, m_size);
     }
+    written_bytes += mm::align_payload(out, m_size);
     uint64_t* p = m_data;
     const static size_type SDSL_BLOCK_SIZE = (1<<28);
     size_type idx = 0;
@@ -1502,6 +1506,7 @@ typename int_vector<fixedIntWidth,size_type_class>::size_type int_vector<fixedIn
     }
     out.write((char*) p, ((capacity()>>6)-idx)*sizeof(uint64_t));
     written_bytes += ((capacity()>>6)-idx)*sizeof(uint64_t);
+    written_bytes += mm::guard_payload(out, m_size);
     structure_tree::add_size(child, written_bytes);
     return written_bytes;
 }
@@ -1520,6 +1525,13 @@ void int_vector<fixedIntWidth,size_type_class>::load(std::istream& in)
 //		intWidth = fixedIntWidth;
 //	set_int_width(intWidth);
 
+    uint64_t* mapped_data = mm::map_payload(in, size, fixedIntWidth==1);
+    if (mapped_data != NULL) { // reference the payload in the mapped file
+        mm::free_mem(m_data);
+        m_data = mapped_data;
+        m_size = size;
+        return;
+    }
     bit_resize(size);
     uint64_t* p = m_data;
     const static size_type SDSL_BLOCK_SIZE = (1<<28); // TODO: is this the loading bottleneck?
@@ -1530,6 +1542,7 @@ void int_vector<fixedIntWidth,size_type_class>::load(std::istream& in)
         idx += SDSL_BLOCK_SIZE;
     }
     in.read((char*) p, ((capacity()>>6)-idx)*sizeof(uint64_t));
+    mm::skip_guard(in, size);
 }
 
 //! A wrapper class which allows us to serialize an char array as an int_vector.
@@ -1744,6 +1757,11 @@ class int_vector_file_buffer
         const uint64_t* data()const {
             return m_buf;
         }
+
+        //! Returns the number of values which fit into the buffer
+        size_type buffersize()const {
+            return m_len;
+        }
         //TODO: proxy object for writting the int buffer
         /*
         	reference operator[](const size_type i){
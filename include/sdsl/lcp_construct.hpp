@@ -26,6 +26,7 @@
 #include "int_vector.hpp"
 #include "rank_support_v.hpp"
 #include "util.hpp"
+#include "parallel.hpp"
 #include "testutils.hpp"
 #include "isa_construct.hpp"
 #include "bwt_construct.hpp"
@@ -68,6 +69,20 @@ bool construct_lcp_semi_extern_PHI(tMSS& file_map, const std::string& dir, const
  */
 bool construct_lcp_PHI(tMSS& file_map, const std::string& dir, const std::string& id, bool semi_external=false);
 
+//! Multi-threaded variant of the PHI algorithm of Kaerkkaeinen et al. (CPM 2009, "Permuted Longest Common Prefix Array")
+/*!	The algorithm computes the lcp array and stores it to disk. The threads compute PHI for
+ *  parts of the suffix array, the PLCP array for parts of the text positions and then the lcp
+ *  array for parts of the suffix array. Each part of the text positions starts its
+ *  comparisons with lcp-value 0.
+ *  \param file_map A map which contains the filenames of previous computed structures (like suffix array, Burrows and Wheeler transform, inverse suffix array, text,...)
+ *  \param dir		Directory where the lcp array should be stored.
+ *  \param id		Id for the file name of the lcp array.
+ *  \param threads  Number of threads. For threads=1 construct_lcp_PHI is used.
+ *  \par Space complexity
+ *		\f$ 9n \f$ bytes
+ */
+bool construct_lcp_PHI_parallel(tMSS& file_map, const std::string& dir, const std::string& id, uint32_t threads);
+
 class buffered_char_queue
 {
         typedef bit_vector::size_type size_type;
@@ -5,6 +5,7 @@
 #include "util.hpp"
 #include "algorithms_for_compressed_suffix_trees.hpp"
 #include "lcp_wt.hpp"
+#include "fast_cache.hpp"
 #include <iostream>
 #include <string>
 
@@ -16,6 +17,7 @@ namespace sdsl
  *	The time consumption of the []-operator depends on:
  *    - The time consumption of the tlcp_idx function of the CST
  *    - The access time to the suffix array ordered LCP array
+ *	If USE_LCP_CACHE is defined, the LCP values are cached (see lcp_cache_type).
  *
  */
 template<class Lcp, class Cst>
@@ -50,8 +52,19 @@ class _lcp_support_tree
 
         const Cst* m_cst;
         Lcp        m_lcp;
+#ifdef USE_LCP_CACHE
+        mutable lcp_cache_type m_cache;
+#endif
+
+        //! Removes the cached LCP values, which belong to the previous content.
+        void clear_cache() {
+#ifdef USE_LCP_CACHE
+            m_cache.clear();
+#endif
+        }
 
         void copy(const _lcp_support_tree& lcp_c) {
+            clear_cache();
             m_cst = lcp_c.m_cst;
             m_lcp = lcp_c.m_lcp; // works for lcp_bitcompressed and lcp_kurtz
         }
@@ -99,6 +112,7 @@ class _lcp_support_tree
         template<uint8_t int_width, class size_type_class>
         void construct(int_vector_file_buffer<int_width, size_type_class>& lcp_buf,
                        const Cst* cst=NULL) {
+            clear_cache();
             m_cst = cst;
             std::string id =  util::to_string(util::get_pid())+"_"+util::to_string(util::get_id()).c_str() + "_fc_lcp";
             {
@@ -121,6 +135,7 @@ class _lcp_support_tree
         }
 
         void set_cst(const Cst* cst) {
+            clear_cache();
             m_cst = cst;
         }
 
@@ -134,6 +149,8 @@ class _lcp_support_tree
 
         void swap(_lcp_support_tree& lcp_c) {
             m_lcp.swap(lcp_c.m_lcp);
+            clear_cache();
+            lcp_c.clear_cache();
         }
 
         //! Returns a const_iterator to the first element.
@@ -160,8 +177,25 @@ class _lcp_support_tree
          *  Required for the STL Random Access Container Concept.
          */
         inline value_type operator[](size_type i)const {
+#ifdef USE_LCP_CACHE
+            size_type r = 0;
+            if (m_cache.exists(i, r)) {
+                return r;
+            }
+            value_type result = m_lcp[ m_cst->tlcp_idx(i) ];
+            m_cache.write(i, result);
+            return result;
+#else
             return m_lcp[ m_cst->tlcp_idx(i) ];
+#endif
+        }
+
+#ifdef USE_LCP_CACHE
+        //! Returns the cache of the LCP values, e.g. to read its hit and miss counters.
+        const lcp_cache_type& cache()const {
+            return m_cache;
         }
+#endif
 
         //! Assignment Operator.
         /*!
@@ -214,6 +248,7 @@ class _lcp_support_tree
          *	\param fcr	A pointer to the rank support for the first child bit_vector
          */
         void load(std::istream& in, const Cst* cst=NULL) {
+            clear_cache();
             m_lcp.load(in); // works for lcp_kurtz and lcp_bitcompressed
             m_cst = cst;
         }
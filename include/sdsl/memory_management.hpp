@@ -8,7 +8,11 @@
 #include "uintx_t.hpp"
 #include "util.hpp"
 #include <map>
+#include <vector>
 #include <iostream>
+#include <streambuf>
+#include <fstream>
+#include <pthread.h>
 using std::cout;
 using std::endl;
 
@@ -21,6 +25,7 @@ class mm_item_base{
 		virtual bool unmap_hp(){return false;};// const = 0;
 		virtual ~mm_item_base(){};
 		virtual uint64_t size(){return 0;};
+		virtual const uint64_t* data(){return NULL;};
 };
 
 template<class int_vector_type>
@@ -32,7 +37,7 @@ class mm_item : public mm_item_base{
 		~mm_item(){ }
 
 		//! Map content of int_vector to a hugepage starting at address addr
-		/*! 
+		/*! Is called by mm::map_hp, which holds the lock of mm.
 		 *  Details: The content of the corresponding int_vector of mm_item 
 		 *           is copied into a hugepage starting at address addr.
 		 *           The string position in the hugepage is then increased
@@ -40,49 +45,202 @@ class mm_item : public mm_item_base{
 		 *           So addr is the new starting address for the next
 		 *           mm_item which have to be mapped.
 		 */
-		bool map_hp(uint64_t*& addr){
-			uint64_t len = size();
-			if ( m_v->m_data != NULL ){
-				memcpy((char*)addr, m_v->m_data, len); // copy old data
-				free(m_v->m_data);
-				m_v->m_data = addr;
-				addr += (len/8);		
-			}
-			return true;	
-		}
+		bool map_hp(uint64_t*& addr);
 
-		//! 
-		bool unmap_hp(){
-			uint64_t len = size();
-			if (  util::verbose ){
-				std::cerr<<"unmap int_vector of size "<< len <<std::endl;
-				std::cerr<<"m_data="<<m_v->m_data<<std::endl;
-			}
-			uint64_t* tmp_data = (uint64_t*)malloc(len); // allocate memory for m_data
-			memcpy(tmp_data, m_v->m_data, len); // copy data from the mmapped region
-			m_v->m_data = tmp_data;
-			return true;
-		}
+		//! Copy the content of int_vector from the hugepage back into malloced memory
+		/*! Is called by mm::unmap_hp, which holds the lock of mm.
+		 */
+		bool unmap_hp();
 
 		uint64_t size(){
 			return ((m_v->bit_size()+63)>>6)<<3;
 		}
+
+		const uint64_t* data(){
+			return m_v->m_data;
+		}
 };
 
 class mm_initializer; // forward declaration of initialization helper
 
+//! Allocation policies for the memory of int_vectors (see mm::set_policy).
+enum mm_policy_type{
+	MM_MALLOC = 0,     //!< Memory is allocated with malloc/realloc (default).
+	MM_HUGEPAGE = 1,   //!< Memory is allocated from an arena of MAP_HUGETLB pages.
+	MM_THP = 2,        //!< Memory is allocated from a 2 MiB aligned arena advised with MADV_HUGEPAGE.
+	MM_NUMA_LOCAL = 3, //!< Memory is allocated from an arena which is bound to the NUMA node of the allocating thread.
+	MM_MAPPED_FILE = 4 //!< Region kind of memory mapped files. Not an allocation policy.
+};
+
+//! A memory region which is not owned by malloc, e.g. a memory mapped file or an arena chunk.
+struct mm_region{
+	uint64_t len;  // length of the region in bytes
+	uint64_t refs; // number of int_vectors (and readers) which use the region
+	uint64_t top;  // number of allocated bytes in an arena chunk
+	mm_policy_type kind;
+	mm_region(uint64_t len=0, uint64_t refs=0, mm_policy_type kind=MM_MAPPED_FILE):len(len),refs(refs),top(0),kind(kind){}
+};
+
+//! Memory usage of one int_vector (see mm::item_infos).
+struct mm_item_info{
+	const void* vector;      // address of the int_vector object
+	const uint64_t* data;    // address of the memory of the int_vector
+	uint64_t bytes;          // number of bytes used by the int_vector
+	mm_policy_type kind;     // kind of the memory 
+	uint64_t hugepage_bytes; // number of bytes which are backed by huge pages
+};
+
+//! Aggregated memory usage of a set of int_vectors (see mm::hugepage_stats).
+struct mm_hp_stats{
+	uint64_t vectors;        // number of int_vectors
+	uint64_t bytes;          // number of bytes used by the int_vectors
+	uint64_t hugepage_bytes; // number of bytes which are backed by huge pages
+	mm_hp_stats():vectors(0), bytes(0), hugepage_bytes(0){}
+	//! Fraction of the bytes which are backed by huge pages.
+	double coverage()const{ return bytes > 0 ? ((double)hugepage_bytes)/bytes : 1.0; }
+};
+
 // memory management class
 class mm{
 	friend class mm_initializer;
+	template<class int_vector_type> friend class mm_item;
 	typedef std::map<uint64_t, mm_item_base*> tMVecItem;
+	typedef std::map<uint64_t, mm_region> tMRegion;
 	static tMVecItem m_items; 
+	static tMRegion m_regions;
 	static uint64_t m_total_memory;
 	static uint64_t *m_data;
+	static mm_policy_type m_policy;
+	static uint64_t m_chunk_size;
+	static uint64_t m_arena[MM_MAPPED_FILE]; // current chunk of each arena
+	static pthread_mutex_t m_mutex; // guards m_items, m_regions, m_data and the allocation methods
+	static volatile uint64_t m_region_begin; // all regions lie in [m_region_begin, m_region_end)
+	static volatile uint64_t m_region_end;
+
+	//! Holds the mutex of mm during its lifetime.
+	class lock_guard{
+		public:
+			lock_guard(){ pthread_mutex_lock(&m_mutex); }
+			~lock_guard(){ pthread_mutex_unlock(&m_mutex); }
+	};
+
+	//! Returns false if addr can not lie in a region. Does not need the lock.
+	/*! The bounds only grow while a region which contains addr exists, so a
+	 *  concurrent update can not exclude an address of an existing region.
+	 */
+	static bool may_be_in_region(const void* addr){
+		return (uint64_t)addr >= m_region_begin and (uint64_t)addr < m_region_end;
+	}
+	static tMRegion::iterator find_region(const void* addr);
+	static void insert_region(uint64_t base, const mm_region& region);
+	static void unmap_region(tMRegion::iterator it);
+	static void update_region_bounds();
+	static void retain_region_unlocked(const void* addr);
+	static void release_region_unlocked(const void* addr);
+	static char* map_chunk(uint64_t len, mm_policy_type kind);
+	static uint64_t* arena_alloc(uint64_t size, mm_policy_type kind);
+	static void drop_arena(mm_policy_type kind);
+	static void free_mem_unlocked(uint64_t* data);
+	static bool in_hp_region_unlocked(const void* addr);
 	public:
 		mm();
 
+		//! Set the allocation policy for all following int_vector allocations.
+		/*! \param policy     The allocation policy.
+		 *  \param chunk_size Minimal size of the chunks the arena requests from the system.
+		 *                    0 keeps the current chunk size (default 64 MiB).
+		 *  Example: Construct a CSA directly in hugepages.
+		 *  \code
+		 *  mm::set_policy(MM_HUGEPAGE);
+		 *  construct_csa(file, csa);
+		 *  mm::set_policy(MM_MALLOC);
+		 *  \endcode
+		 *  Arena memory is released when all int_vectors of an arena chunk
+		 *  are destroyed. If the system can not provide memory for the policy,
+		 *  malloc is used.
+		 */
+		static void set_policy(mm_policy_type policy, uint64_t chunk_size=0);
+
+		//! Returns the current allocation policy.
+		static mm_policy_type policy(){ return m_policy; }
+
+		//! Reallocate the memory of an int_vector according to the current policy.
+		/*! \param data     Pointer to the current memory, or NULL.
+		 *  \param old_size Number of bytes which are currently used at data.
+		 *  \param size     Number of bytes which should be allocated.
+		 *  If data is the last allocation of the current arena chunk, it is
+		 *  resized in place. Otherwise the content is copied to the new memory
+		 *  and the old memory is freed or its region reference is released.
+		 *  realloc_mem, free_mem, add, remove and the region methods may be called
+		 *  concurrently, so that int_vectors can be created and destroyed by several
+		 *  threads. Memory which lies outside of all regions is passed to realloc
+		 *  and free without taking the lock, if the policy is MM_MALLOC. The lock
+		 *  is only held for the bookkeeping; the content is copied without it.
+		 */
+		static uint64_t* realloc_mem(uint64_t* data, uint64_t old_size, uint64_t size);
+
+		//! Free the memory of an int_vector (see realloc_mem).
+		static void free_mem(uint64_t* data);
+
+		//! Map the file file_name read-only (copy on write) into memory.
+		/*! \param file_name Name of the file.
+		 *  \param len       Is set to the size of the file in bytes.
+		 *  \return Start address of the mapping or NULL if the mapping failed.
+		 *  The mapping is registered as region with one reference, which has
+		 *  to be released with release_region. One additional page after the
+		 *  end of the file is mapped so that accesses to the padding word of
+		 *  an int_vector at the end of the file are valid.
+		 */
+		static char* map_file(const std::string& file_name, uint64_t& len);
+
+		//! Add a reference to the region which contains addr.
+		static void retain_region(const void* addr);
+
+		//! Remove a reference from the region which contains addr. The region is unmapped if no references remain.
+		static void release_region(const void* addr);
+
+		//! Returns true if addr lies in a region which is not owned by malloc.
+		static bool in_region(const void* addr);
+
+		//! Returns the kind of the region which contains addr or MM_MALLOC if addr is not in a region.
+		static mm_policy_type region_kind(const void* addr);
+
+		//! Number of padding bytes before a payload of payload_size bytes at offset pos in an aligned file.
+		static uint64_t payload_padding(uint64_t pos, uint64_t payload_size, uint64_t alignment){
+			if ( 0 == alignment )
+				return 0;
+			uint64_t a = payload_size >= alignment ? alignment : 8;
+			return (a - pos % a) % a;
+		}
+
+		//! Reference the payload of an int_vector in a memory mapped stream.
+		/*! \param in       The stream from which the int_vector is loaded. The header of the
+		 *                  int_vector was already read.
+		 *  \param bit_size The number of bits of the int_vector.
+		 *  \param bit_vector Indicates if the padding word after the payload has to be zero.
+		 *  \return A pointer to the payload in the mapping or NULL if in is not a mapped
+		 *          stream or the payload can not be referenced. In the latter case the
+		 *          stream is positioned at the start of the payload and the content has
+		 *          to be read as usual. 
+		 */
+		static uint64_t* map_payload(std::istream& in, uint64_t bit_size, bool bit_vector);
+
+		//! Write the alignment padding before a payload, if out writes to an aligned file.
+		/*! \return The number of written bytes.
+		 */
+		static uint64_t align_payload(std::ostream& out, uint64_t bit_size);
+
+		//! Write the zero guard word after a payload, if out writes to an aligned file.
+		/*! \return The number of written bytes.
+		 */
+		static uint64_t guard_payload(std::ostream& out, uint64_t bit_size);
+
+		//! Skip the zero guard word after a payload, if in reads from an aligned file.
+		static void skip_guard(std::istream& in, uint64_t bit_size);
+
 		template<class int_vector_type>
 		static void add(int_vector_type *v){
+			lock_guard lock;
 			if( mm::m_items.find((uint64_t)v) == mm::m_items.end() ){
 				mm_item_base* item = new mm_item<int_vector_type>(v); 
 				if(util::verbose) cout << "mm::add: add vector " << v << endl;
@@ -94,6 +252,7 @@ class mm{
 
 		template<class int_vector_type>
 		static void remove(int_vector_type *v){
+			lock_guard lock;
 			if( mm::m_items.find((uint64_t)v) != mm::m_items.end() ){
 				if( util::verbose ){ cout << "mm:remove: remove vector " << v << endl; };
 				mm_item_base* item = m_items[(uint64_t)v];
@@ -104,10 +263,174 @@ class mm{
 			}
 		}
 
+		//! Copy all int_vectors into one hugepage region.
+		/*! Use set_policy(MM_HUGEPAGE) to allocate int_vectors directly in hugepages.
+		 *  The lock is held during the copy, since the set of int_vectors has to
+		 *  stay fixed. So int_vectors can not be created or destroyed meanwhile.
+		 */
 		static bool map_hp();
+		//! Copy all int_vectors of the region of map_hp back into malloced memory.
 		static bool unmap_hp();
+		//! Returns true if addr lies in the region of map_hp.
+		static bool in_hp_region(const void* addr);
+
+		//! Report the memory usage of all registered int_vectors.
+		/*! The hugepage backing is determined with /proc/self/smaps. For transparent
+		 *  huge pages smaps only reports the number of huge pages of each mapping, so the 
+		 *  hugepage_bytes of an int_vector are estimated proportionally to its share of 
+		 *  the mapping.
+		 *  \param infos        Vector which is filled with one entry per int_vector.
+		 *  \param vector_begin Only int_vectors whose object lies in [vector_begin, vector_end) are reported.
+		 *  \param vector_end   NULL reports all int_vectors. 
+		 */
+		static void item_infos(std::vector<mm_item_info>& infos, const void* vector_begin=NULL, const void* vector_end=NULL);
+
+		//! Aggregated hugepage usage of all registered int_vectors.
+		static mm_hp_stats hugepage_stats();
+
+		//! Aggregated hugepage usage of the int_vectors which are members of t.
+		/*! Only int_vectors which are stored inside the object t (and not 
+		 *  in memory referenced by pointers of t) are taken into account. 
+		 *  Example: Alert if an index lost its hugepage backing.
+		 *  \code
+		 *  if ( mm::hugepage_stats(csa).coverage() < 0.9 ) ...
+		 *  \endcode
+		 */
+		template<class T>
+		static mm_hp_stats hugepage_stats(const T& t){
+			return hugepage_stats(&t, (&t)+1);
+		}
+
+		static mm_hp_stats hugepage_stats(const void* vector_begin, const void* vector_end);
+};
+
+template<class int_vector_type>
+bool mm_item<int_vector_type>::map_hp(uint64_t*& addr){
+	uint64_t len = size();
+	if ( m_v->m_data != NULL ){
+		memcpy((char*)addr, m_v->m_data, len); // copy old data
+		addr[len/8] = 0; // the padding word; it is only allocated by int_vector if bit_size%64 == 0
+		mm::free_mem_unlocked(m_v->m_data);
+		m_v->m_data = addr;
+		mm::retain_region_unlocked(addr);
+		addr += (len/8)+1;		
+	}
+	return true;	
+}
+
+template<class int_vector_type>
+bool mm_item<int_vector_type>::unmap_hp(){
+	if ( m_v->m_data == NULL or !mm::in_hp_region_unlocked(m_v->m_data) )
+		return true;
+	uint64_t len = size()+8;
+	if (  util::verbose ){
+		std::cerr<<"unmap int_vector of size "<< len <<std::endl;
+		std::cerr<<"m_data="<<m_v->m_data<<std::endl;
+	}
+	uint64_t* tmp_data = (uint64_t*)malloc(len); // allocate memory for m_data
+	memcpy(tmp_data, m_v->m_data, len); // copy data from the mmapped region
+	mm::release_region_unlocked(m_v->m_data);
+	m_v->m_data = tmp_data;
+	return true;
+}
+
+//! A stream buffer which reads from a memory mapped file.
+/*! If an int_vector is loaded from a stream which uses a
+ *  mapped_streambuf, the int_vector references its content
+ *  directly in the mapping instead of copying it. 
+ *  The mapping is private, i.e. the page cache is shared
+ *  between processes as long as the int_vector is not modified.
+ *  \sa util::load_from_mmap_file
+ */
+class mapped_streambuf : public std::streambuf{
+	private:
+		char* m_base;		// start of the mapping
+		uint64_t m_len; 	// length of the file
+		uint64_t m_alignment;// alignment of the payloads, 0 for plain files
+		
+		mapped_streambuf(const mapped_streambuf&);
+		mapped_streambuf& operator=(const mapped_streambuf&);
+	protected:
+		pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which = std::ios_base::in);
+		pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in);
+	public:
+		mapped_streambuf():m_base(NULL), m_len(0), m_alignment(0){}
+		~mapped_streambuf(){ close(); }
+
+		//! Map file_name and read the header of aligned files.
+		bool open(const char* file_name);
+		//! Release the reference to the mapping.
+		void close();
+
+		uint64_t alignment()const{ return m_alignment; }
+		uint64_t pos()const{ return gptr()-eback(); }
+		const char* current()const{ return gptr(); }
+		uint64_t remaining()const{ return egptr()-gptr(); }
+		void skip(uint64_t n){ setg(eback(), gptr()+(n < remaining() ? n : remaining()), egptr()); }
+};
+
+//! A file buffer which aligns the payloads of int_vectors.
+/*! Payloads which are at least one page large are aligned to page boundaries,
+ *  smaller payloads are aligned to 8 bytes. 
+ *  \sa util::store_to_mmap_file
+ */
+class aligned_filebuf : public std::filebuf{
+	private:
+		uint64_t m_alignment;
+	public:
+		explicit aligned_filebuf(uint64_t alignment):m_alignment(alignment){}
+		uint64_t alignment()const{ return m_alignment; }
+		uint64_t pos(){ return pubseekoff(0, std::ios_base::cur, std::ios_base::out); }
 };
 
+//! Magic number at the start of files written by util::store_to_mmap_file
+const uint64_t SDSL_MMAP_MAGIC = 0x70616d6d6c736473ULL; // "sdslmmap"
+
+namespace util{
+
+//! Store a data structure to a file in which all int_vector payloads are aligned.
+/*! Files written by this method can be loaded with load_from_mmap_file
+ *  without copying the int_vectors.
+ *  \param v Data structure to store.
+ *  \param file_name Name of the file where to store the data structure.
+ *  \return If the data structure was stored successfully.
+ */
+template<class T>
+bool store_to_mmap_file(const T& v, const char* file_name)
+{
+	aligned_filebuf buf(sysconf(_SC_PAGESIZE));
+	if ( !buf.open(file_name, std::ios::binary | std::ios::trunc | std::ios::out) )
+		return false;
+	std::ostream out(&buf);
+	uint64_t magic = SDSL_MMAP_MAGIC, alignment = buf.alignment();
+	write_member(magic, out);
+	write_member(alignment, out);
+	v.serialize(out);
+	return buf.close() != NULL and out.good();
+}
+
+//! Load a data structure from a memory mapped file.
+/*! The int_vectors of the data structure reference the mapping
+ *  and are not copied. The mapping is released when the last
+ *  int_vector which references it is destroyed or resized.
+ *  Files written by store_to_file can also be loaded; in this case
+ *  only payloads which happen to be 8-byte aligned are referenced.
+ *  \param v Data structure to load.
+ *  \param file_name Name of the serialized file.
+ */
+template<class T>
+bool load_from_mmap_file(T& v, const char* file_name)
+{
+	mapped_streambuf buf;
+	if ( !buf.open(file_name) )
+		return false;
+	std::istream in(&buf);
+	v.load(in);
+	return in.good();
+}
+
+} // end namespace util
+
 static class mm_initializer{
 	public:
 		mm_initializer ();
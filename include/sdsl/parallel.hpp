@@ -0,0 +1,132 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2012 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file parallel.hpp
+    \brief parallel.hpp contains helper functions to execute construction steps with several threads.
+	\author Simon Gog
+*/
+#ifndef INCLUDED_SDSL_PARALLEL
+#define INCLUDED_SDSL_PARALLEL
+
+#include "int_vector.hpp" // for uint64_t and uint32_t
+#include "util.hpp"       // for util::init_support
+#include <pthread.h>
+#include <unistd.h>    // for sysconf
+#include <vector>
+#include <algorithm>   // for std::min
+
+//! Namespace for the succinct data structure library.
+namespace sdsl
+{
+
+//! Namespace for helper functions for multi-threaded construction.
+/*! A task is an object with an operator()(). Tasks which are executed
+ *  in parallel must not write to the same memory.
+ */
+namespace parallel
+{
+
+//! Returns the number of online processors of the machine (at least 1).
+inline uint32_t hardware_threads()
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (uint32_t)n : 1;
+}
+
+template<class Task>
+void* execute_task(void* task)
+{
+    (*(Task*)task)();
+    return NULL;
+}
+
+//! Executes the tasks tasks[0..n-1] in parallel and returns after all tasks are finished.
+/*! Each task is executed by its own thread; task 0 is executed by the calling thread.
+ *  If a thread cannot be created, its task is executed by the calling thread.
+ */
+template<class Task>
+void run(Task* tasks, uint32_t n)
+{
+    if (n == 0)
+        return;
+    std::vector<pthread_t> threads(n-1);
+    std::vector<bool> started(n-1, false);
+    for (uint32_t i=1; i < n; ++i) {
+        started[i-1] = (0 == pthread_create(&threads[i-1], NULL, execute_task<Task>, (void*)(tasks+i)));
+    }
+    tasks[0]();
+    for (uint32_t i=1; i < n; ++i) {
+        if (started[i-1])
+            pthread_join(threads[i-1], NULL);
+        else
+            tasks[i]();
+    }
+}
+
+//! Executes the tasks of a vector in parallel.
+/*! \sa run(Task*, uint32_t)
+ */
+template<class Task>
+void run(std::vector<Task>& tasks)
+{
+    if (!tasks.empty())
+        run(&tasks[0], (uint32_t)tasks.size());
+}
+
+//! Executes three tasks of different types in parallel.
+/*! \sa run(Task*, uint32_t)
+ */
+template<class Task1, class Task2, class Task3>
+void run(Task1& task1, Task2& task2, Task3& task3)
+{
+    pthread_t threads[2];
+    bool started2 = (0 == pthread_create(&threads[0], NULL, execute_task<Task2>, (void*)&task2));
+    bool started3 = (0 == pthread_create(&threads[1], NULL, execute_task<Task3>, (void*)&task3));
+    task1();
+    if (started2) pthread_join(threads[0], NULL); else task2();
+    if (started3) pthread_join(threads[1], NULL); else task3();
+}
+
+//! A task which initializes the support structure s for x (see util::init_support).
+template<class S, class X>
+struct init_support_task {
+    S* s;
+    const X* x;
+    init_support_task(S& s, const X* x):s(&s), x(x) {}
+    void operator()() {
+        util::init_support(*s, x);
+    }
+};
+
+//! Returns the first index of part i, if [0..n-1] is split into parts parts of almost equal size.
+inline uint64_t part_begin(uint64_t n, uint32_t parts, uint32_t i)
+{
+    return (n/parts)*i + std::min((uint64_t)i, n%parts);
+}
+
+//! Atomically adds x to the counter and returns the old value of the counter.
+/*! Used to distribute work dynamically between threads.
+ */
+inline uint64_t fetch_and_add(volatile uint64_t& counter, uint64_t x)
+{
+    return __sync_fetch_and_add(&counter, x);
+}
+
+} // end namespace parallel
+
+} // end namespace sdsl
+
+#endif
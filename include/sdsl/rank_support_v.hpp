@@ -22,6 +22,7 @@
 #define INCLUDED_SDSL_RANK_SUPPORT_V
 
 #include "rank_support.hpp"
+#include "parallel.hpp"
 
 //! Namespace for the succinct data structure library.
 namespace sdsl
@@ -161,12 +162,45 @@ class rank_support_v : public rank_support
         typedef bit_vector bit_vector_type;
     private:
         int_vector<64> m_basic_block; // basic block for interleaved storage of superblockrank and blockrank
+        void prefetch(size_type idx)const;
+        size_type init_superblocks(size_type kb, size_type ke);
+
+        // task of the multi-threaded init, which initializes the superblocks [kb..ke-1]
+        struct init_task {
+            rank_support_v* rs;
+            size_type kb, ke;
+            size_type offset; // number of arguments before superblock kb
+            bool first_pass;
+
+            void operator()() {
+                if (first_pass) {
+                    offset = rs->init_superblocks(kb, ke);
+                } else {
+                    for (size_type k=kb; k < ke; ++k)
+                        rs->m_basic_block[2*k] += offset;
+                }
+            }
+        };
     public:
         explicit rank_support_v(const bit_vector* v = NULL);
         rank_support_v(const rank_support_v& rs);
         ~rank_support_v();
         void init(const bit_vector* v=NULL);
+        //! Initializes the rank support for v with several threads.
+        /*! The superblocks are split into parts. The threads first calculate the counts of
+            their part relative to its start and then add the number of arguments before
+            their part. The result equals the one of init(v).
+         */
+        void init(const bit_vector* v, uint32_t threads);
         const size_type rank(size_type idx) const;
+        //! Answers n rank queries.
+        /*! \param idx Array of the n query positions.
+            \param n   Number of queries.
+            \param out Array of size n; out[i] is set to rank(idx[i]).
+            The memory of the query SDSL_PREFETCH_DISTANCE positions ahead is prefetched
+            while a query is answered, so the cache misses of independent queries overlap.
+         */
+        void rank(const size_type* idx, size_type n, size_type* out) const;
         const size_type operator()(size_type idx)const;
         const size_type size()const;
         size_type serialize(std::ostream& out, structure_tree_node* v=NULL, std::string name="")const;
@@ -267,6 +301,62 @@ inline void rank_support_v<b, pattern_len>::init(const bit_vector* v)
     }
 }
 
+// Calculates the entries of the superblocks [kb..ke-1] in m_basic_block, where the superblock
+// counts are relative to superblock kb; returns the number of arguments in the superblocks.
+template<uint8_t b, uint8_t pattern_len>
+inline typename rank_support_v<b, pattern_len>::size_type rank_support_v<b, pattern_len>::init_superblocks(size_type kb, size_type ke)
+{
+    const size_type words = m_v->capacity()>>6;
+    const uint64_t* data = m_v->data();
+    uint64_t carry = (kb == 0) ? rank_support_v_trait<b, pattern_len>::init_carry() : (data[8*kb-1]>>63);
+    size_type sum = 0;
+    for (size_type k=kb; k < ke; ++k) {
+        m_basic_block[2*k] = sum;
+        uint64_t second_level_cnt = 0;
+        size_type i = 8*k, block_sum = 0;
+        for (; i < 8*k+8 and i < words; ++i) {
+            if (i&0x7)
+                second_level_cnt |= block_sum<<(63-9*(i&0x7));
+            block_sum += rank_support_v_trait<b, pattern_len>::args_in_the_word(data[i], carry);
+        }
+        if ((i&0x7) and i == words) // the last superblock is not full
+            second_level_cnt |= block_sum<<(63-9*(i&0x7));
+        m_basic_block[2*k+1] = second_level_cnt;
+        sum += block_sum;
+    }
+    return sum;
+}
+
+template<uint8_t b, uint8_t pattern_len>
+inline void rank_support_v<b, pattern_len>::init(const bit_vector* v, uint32_t threads)
+{
+    size_type superblocks = (v == NULL or v->empty()) ? 0 : (v->capacity()>>9)+1;
+    if (threads > superblocks/1024) // each thread processes at least 1024 superblocks
+        threads = superblocks/1024;
+    if (threads <= 1) {
+        init(v);
+        return;
+    }
+    set_vector(v);
+    m_basic_block.resize(superblocks<<1);
+    std::vector<init_task> tasks(threads);
+    for (uint32_t t=0; t < threads; ++t) {
+        tasks[t].rs = this;
+        tasks[t].kb = parallel::part_begin(superblocks, threads, t);
+        tasks[t].ke = parallel::part_begin(superblocks, threads, t+1);
+        tasks[t].first_pass = true;
+    }
+    parallel::run(tasks);
+    size_type sum = 0;
+    for (uint32_t t=0; t < threads; ++t) {
+        size_type part_sum = tasks[t].offset;
+        tasks[t].offset = sum;
+        tasks[t].first_pass = false;
+        sum += part_sum;
+    }
+    parallel::run(tasks);
+}
+
 template<uint8_t b, uint8_t pattern_len>
 inline const typename rank_support_v<b, pattern_len>::size_type rank_support_v<b, pattern_len>::rank(size_type idx)const
 {
@@ -279,6 +369,27 @@ inline const typename rank_support_v<b, pattern_len>::size_type rank_support_v<b
 }
 
 
+template<uint8_t b, uint8_t pattern_len>
+inline void rank_support_v<b, pattern_len>::prefetch(size_type idx)const
+{
+    SDSL_PREFETCH(m_basic_block.data() + ((idx>>8)&0xFFFFFFFFFFFFFFFEULL));
+    SDSL_PREFETCH(m_v->data() + (idx>>6));
+}
+
+template<uint8_t b, uint8_t pattern_len>
+inline void rank_support_v<b, pattern_len>::rank(const size_type* idx, size_type n, size_type* out)const
+{
+    const size_type d = SDSL_PREFETCH_DISTANCE;
+    for (size_type i=0; i < n and i < d; ++i) {
+        prefetch(idx[i]);
+    }
+    for (size_type i=0; i < n; ++i) {
+        if (i+d < n)
+            prefetch(idx[i+d]);
+        out[i] = rank_support_v::rank(idx[i]);
+    }
+}
+
 template<uint8_t b, uint8_t pattern_len>
 inline const typename rank_support_v<b, pattern_len>::size_type rank_support_v<b, pattern_len>::operator()(size_type idx)const
 {
@@ -340,6 +451,16 @@ inline bool rank_support_v<b, pattern_len>::operator!=(const rank_support_v& rs)
     return !(*this == rs);
 }
 
+namespace util
+{
+//! Initialise rank_support_v with several threads
+template<uint8_t b, uint8_t pattern_len>
+void init_support(rank_support_v<b, pattern_len>& s, const bit_vector* x, uint32_t threads)
+{
+    s.init(x, threads);
+}
+}
+
 }// end namespace sds
 
 #endif // end file 
@@ -52,12 +52,21 @@ class rank_support_v5 : public rank_support
         typedef bit_vector bit_vector_type;
     private:
         int_vector<64> m_basic_block; // basic block for interleaved storage of superblockrank and blockrank
+        void prefetch(size_type idx)const;
     public:
         explicit rank_support_v5(const bit_vector* v = NULL);
         rank_support_v5(const rank_support_v5& rs);
         ~rank_support_v5();
         void init(const bit_vector* v=NULL);
         const size_type rank(size_type idx) const;
+        //! Answers n rank queries.
+        /*! \param idx Array of the n query positions.
+            \param n   Number of queries.
+            \param out Array of size n; out[i] is set to rank(idx[i]).
+            The memory of the query SDSL_PREFETCH_DISTANCE positions ahead is prefetched
+            while a query is answered, so the cache misses of independent queries overlap.
+         */
+        void rank(const size_type* idx, size_type n, size_type* out) const;
         const size_type operator()(size_type idx)const;
         const size_type size()const;
         size_type serialize(std::ostream& out, structure_tree_node* v=NULL, std::string name="")const;
@@ -173,6 +182,29 @@ inline const typename rank_support_v5<b, pattern_len>::size_type rank_support_v5
 }
 
 
+template<uint8_t b, uint8_t pattern_len>
+inline void rank_support_v5<b, pattern_len>::prefetch(size_type idx)const
+{
+    SDSL_PREFETCH(m_basic_block.data() + ((idx>>10)&0xFFFFFFFFFFFFFFFEULL));
+    // the words of the 6x64bit block in front of idx are also read
+    SDSL_PREFETCH(m_v->data() + (((idx&0xFFFFFFFFFFFFF800ULL) + ((idx&0x7FF)/(64*6))*(64*6))>>6));
+    SDSL_PREFETCH(m_v->data() + (idx>>6));
+}
+
+template<uint8_t b, uint8_t pattern_len>
+inline void rank_support_v5<b, pattern_len>::rank(const size_type* idx, size_type n, size_type* out)const
+{
+    const size_type d = SDSL_PREFETCH_DISTANCE;
+    for (size_type i=0; i < n and i < d; ++i) {
+        prefetch(idx[i]);
+    }
+    for (size_type i=0; i < n; ++i) {
+        if (i+d < n)
+            prefetch(idx[i+d]);
+        out[i] = rank_support_v5::rank(idx[i]);
+    }
+}
+
 template<uint8_t b, uint8_t pattern_len>
 inline const typename rank_support_v5<b, pattern_len>::size_type rank_support_v5<b, pattern_len>::operator()(size_type idx)const
 {
@@ -197,6 +197,10 @@ class rrr_vector
                 }
                 btnr_pos += space_for_bt;
             }
+            if (i < bt_array.size() and (i % m_sample_rate) == 0) { // the empty block after the last full block starts a sample
+                m_btnrp[ i/m_sample_rate ] = btnr_pos;
+                m_rank[ i/m_sample_rate ] = sum_rank;
+            }
             // for technical reasons add an additional element to m_rank
             m_rank[ m_rank.size()-1 ] = sum_rank; // sum_rank contains the total number of set bits in bv
             util::assign(m_bt, bt_array);
@@ -333,6 +337,20 @@ class rrr_rank_support
         const bit_vector_type* m_v; //!< Pointer to the rank supported rrr_vector
         uint16_t m_sample_rate;  //!<    "     "   "      "
 
+        void prefetch_samples(size_type i)const {
+            size_type sample_pos = (i/block_size)/m_sample_rate;
+            const int_vector<>& r = m_v->m_rank;
+            const int_vector<>& p = m_v->m_btnrp;
+            SDSL_PREFETCH(r.data() + ((sample_pos*r.get_int_width())>>6));
+            SDSL_PREFETCH(p.data() + ((sample_pos*p.get_int_width())>>6));
+        }
+
+        void prefetch_btnr(size_type i)const {
+            size_type btnrp = m_v->m_btnrp[ (i/block_size)/m_sample_rate ];
+            SDSL_PREFETCH(m_v->m_btnr.data() + (btnrp>>6));
+            SDSL_PREFETCH(m_v->m_btnr.data() + (btnrp>>6) + 8);
+        }
+
     public:
         //! Standard constructor
         /*! \param v Pointer to the rrr_vector, which should be supported
@@ -383,6 +401,26 @@ class rrr_rank_support
             return rrr_rank_support_trait<b>::adjust_rank(rank + popcnt, i);
         }
 
+        //! Answers n rank queries
+        /*! \param idx Array of the n query positions, each in [0..size()].
+            \param n   Number of queries.
+            \param out Array of size n; out[j] is set to rank(idx[j]).
+            The samples of a query are prefetched 2*SDSL_PREFETCH_DISTANCE queries ahead
+            and the block type numbers SDSL_PREFETCH_DISTANCE queries ahead, so
+            the cache misses of independent queries overlap.
+        */
+        void rank(const size_type* idx, size_type n, size_type* out)const {
+            const size_type d = SDSL_PREFETCH_DISTANCE;
+            for (size_type j=0; j < n+2*d; ++j) {
+                if (j < n)
+                    prefetch_samples(idx[j]);
+                if (j >= d and j-d < n)
+                    prefetch_btnr(idx[j-d]);
+                if (j >= 2*d and j-2*d < n)
+                    out[j-2*d] = rank(idx[j-2*d]);
+            }
+        }
+
         //! Short hand for rank(i)
         const size_type operator()(size_type i)const {
             return rank(i);
@@ -258,6 +258,10 @@ class rrr_vector<15, wt_type>
                 }
                 btnr_pos += space_for_bt;
             }
+            if (i < bt_array.size() and (i % m_sample_rate) == 0) { // the empty block after the last full block starts a sample
+                m_btnrp[ i/m_sample_rate ] = btnr_pos;
+                m_rank[ i/m_sample_rate ] = sum_rank;
+            }
             // for technical reasons add an additional element to m_rank
             m_rank[ m_rank.size()-1 ] = sum_rank; // sum_rank contains the total number of set bits in bv
             util::assign(m_bt, bt_array);
@@ -380,6 +384,23 @@ class rrr_rank_support<b, 15, wt_type>
     private:
         const bit_vector_type* m_v; //!< Pointer to the rank supported rrr_vector
         uint16_t m_sample_rate;  //!<    "     "   "      "
+
+        void prefetch_samples(size_type i)const {
+            size_type sample_pos = (i/bit_vector_type::block_size)/m_sample_rate;
+            const int_vector<>& r = m_v->m_rank;
+            const int_vector<>& p = m_v->m_btnrp;
+            SDSL_PREFETCH(r.data() + ((sample_pos*r.get_int_width())>>6));
+            SDSL_PREFETCH(p.data() + ((sample_pos*p.get_int_width())>>6));
+            // the 4-bit block types between the sample and the block of i
+            SDSL_PREFETCH(m_v->m_bt.data() + ((sample_pos*m_sample_rate)>>4));
+            SDSL_PREFETCH(m_v->m_bt.data() + ((i/bit_vector_type::block_size)>>4));
+        }
+
+        void prefetch_btnr(size_type i)const {
+            size_type btnrp = m_v->m_btnrp[ (i/bit_vector_type::block_size)/m_sample_rate ];
+            SDSL_PREFETCH(m_v->m_btnr.data() + (btnrp>>6));
+            SDSL_PREFETCH(m_v->m_btnr.data() + (btnrp>>6) + 8);
+        }
         // TODO cache for sequential ranks
 //		mutable size_type m_last_bt;
 //		mutable size_type m_last_w; // store the last decoded word
@@ -490,6 +511,26 @@ class rrr_rank_support<b, 15, wt_type>
                     bit_magic::b1Cnt(((uint64_t)(bi_type::nr_to_bin(last_bt, btnr))) & bit_magic::Li1Mask[off]), i);
         }
 
+        //! Answers n rank queries
+        /*! \param idx Array of the n query positions, each in [0..size()].
+            \param n   Number of queries.
+            \param out Array of size n; out[j] is set to rank(idx[j]).
+            The samples of a query are prefetched 2*SDSL_PREFETCH_DISTANCE queries ahead
+            and the block type numbers SDSL_PREFETCH_DISTANCE queries ahead, so
+            the cache misses of independent queries overlap.
+        */
+        void rank(const size_type* idx, size_type n, size_type* out)const {
+            const size_type d = SDSL_PREFETCH_DISTANCE;
+            for (size_type j=0; j < n+2*d; ++j) {
+                if (j < n)
+                    prefetch_samples(idx[j]);
+                if (j >= d and j-d < n)
+                    prefetch_btnr(idx[j-d]);
+                if (j >= 2*d and j-2*d < n)
+                    out[j-2*d] = rank(idx[j-2*d]);
+            }
+        }
+
         //! Short hand for rank(i)
         const size_type operator()(size_type i)const {
             return rank(i);
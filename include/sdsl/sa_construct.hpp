@@ -0,0 +1,78 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2012 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file sa_construct.hpp
+    \brief sa_construct.hpp contains a construction method for suffix arrays of texts which do not fit into main memory.
+	\author Simon Gog
+*/
+#ifndef INCLUDED_SDSL_SA_CONSTRUCT
+#define INCLUDED_SDSL_SA_CONSTRUCT
+
+#include "typedefs.hpp" // includes definition of tMSS
+#include "int_vector.hpp"
+#include "temp_write_read_buffer.hpp"
+#include "util.hpp"
+#include "testutils.hpp"
+
+#include <string>
+
+namespace sdsl
+{
+
+//! External memory prefix doubling algorithm for the suffix array
+/*! The algorithm computes the suffix array of the text file_map["text"] and stores it to disk.
+ *  Each round sorts the tuples (name[i], name[i+h], i) with an external merge sort and
+ *  renames the suffixes, until all names are unique (Dementiev et al., JEA 2008, ,,Better
+ *  external memory suffix array construction'', Section 3). The initial names are the first
+ *  characters of the suffixes packed into 64-bit words.
+ *
+ *  \param file_map   A map which contains the filenames of previous computed structures.
+ *  \param dir        Directory where the suffix array and the temporary files are stored.
+ *  \param id         Id for the file name of the suffix array.
+ *  \param ram_budget Number of bytes of main memory the algorithm may use (at least 1 MB are used).
+ *  \par Space complexity
+ *       ram_budget bytes of main memory and about \f$ 64n \f$ bytes of disk space.
+ *  \par I/O volume
+ *       \f$ \Order{n \log n} \f$ words. Each round also writes the candidate suffix array
+ *       (\f$ n\lceil\log(n+1)\rceil \f$ bits), as it is only known after the round whether
+ *       all names are unique; this is small compared to the tuples of three words
+ *       per suffix which are sorted in each round.
+ *
+ *  The result is the suffix array as int_vector<> of width \f$\lfloor\log(n+1)\rfloor+1\f$
+ *  in the file dir+"sa_"+id, which is also stored in file_map["sa"].
+ */
+bool construct_sa_extern(tMSS& file_map, const std::string& dir, const std::string& id, uint64_t ram_budget);
+
+//! External memory construction of the BWT from the text and the suffix array
+/*! The pairs \f$(SA[i]-1 \bmod n, i)\f$ are sorted by the text position, the text is
+ *  scanned to get the characters and the pairs \f$(i, T[SA[i]-1 \bmod n])\f$ are sorted
+ *  by \f$i\f$. Text and suffix array are only read sequentially.
+ *
+ *  \param file_map   A map which contains the filenames of the text and the suffix array.
+ *  \param dir        Directory where the BWT and the temporary files are stored.
+ *  \param id         Id for the file name of the BWT.
+ *  \param ram_budget Number of bytes of main memory the algorithm may use (at least 1 MB are used).
+ *  \par I/O volume
+ *       \f$ \Order{n} \f$ words for each merge level of the two sorts.
+ *
+ *  The result is the BWT as int_vector<8> in the file dir+"bwt_"+id, which is also
+ *  stored in file_map["bwt"]. If file_map already contains a BWT, nothing is done.
+ */
+bool construct_bwt_extern(tMSS& file_map, const std::string& dir, const std::string& id, uint64_t ram_budget);
+
+}// end namespace
+
+#endif
@@ -23,6 +23,7 @@
 
 #include "int_vector.hpp"
 #include "select_support.hpp"
+#include "parallel.hpp"
 
 //#define SDSL_DEBUG_SELECT_SUPPORT_JMC
 
@@ -256,19 +257,76 @@ class select_support_mcl : public select_support
         int_vector<0>* m_miniblock;
         size_type m_arg_cnt;
         void copy(const select_support_mcl<b, pattern_len>& ss);
+        void prefetch_superblock(size_type i)const;
+        void prefetch_miniblock(size_type i)const;
+        void prefetch_word(size_type i)const;
         void construct();
         void initData();
         void init_fast(const int_vector<1>* v=NULL);
+        void init_fast(const int_vector<1>* v, uint32_t threads);
+        void init_fast_superblocks(size_type word, size_type cnt, size_type sb_begin, size_type sb_end, size_type* first_arg);
+        void create_longsuperblock(size_type sb);
+
+        // task of the multi-threaded init_fast, which processes the words [wb..we-1]
+        struct init_task {
+            select_support_mcl* ss;
+            size_type wb, we;
+            size_type cnt;            // number of arguments before word wb
+            size_type sb_begin, sb_end; // superblocks whose first argument lies in the words
+            size_type* first_arg;
+            bool first_pass;
+
+            void operator()() {
+                const uint64_t* data = ss->m_v->data();
+                uint64_t carry = 0;
+                if (first_pass) { // count the arguments
+                    cnt = 0;
+                    for (size_type i=wb; i < we; ++i) {
+                        uint64_t w = data[i];
+                        if (i+1 == (ss->m_v->capacity()>>6) and (ss->m_v->size()&0x3F)) { // ignore the bits after the end
+                            w = b ? (w & bit_magic::Li1Mask[ss->m_v->size()&0x3F]) : (w | ~bit_magic::Li1Mask[ss->m_v->size()&0x3F]);
+                        }
+                        cnt += select_support_mcl_trait<b, pattern_len>::args_in_the_word(w, carry);
+                    }
+                    return;
+                }
+                if (sb_begin >= sb_end)
+                    return;
+                size_type i = wb, first = sb_begin<<12;
+                size_type args = select_support_mcl_trait<b, pattern_len>::args_in_the_word(data[i], carry);
+                while (cnt + args <= first) { // find the word which contains the first argument of superblock sb_begin
+                    cnt += args;
+                    args = select_support_mcl_trait<b, pattern_len>::args_in_the_word(data[++i], carry);
+                }
+                ss->init_fast_superblocks(i, cnt, sb_begin, sb_end, first_arg);
+            }
+        };
     public:
         explicit select_support_mcl(const int_vector<1>* v=NULL);
         select_support_mcl(const select_support_mcl<b,pattern_len>& ss);
         ~select_support_mcl();
         void init(const int_vector<1>* v=NULL);
+        //! Initializes the select support for v with several threads.
+        /*! The words of v are split into parts and the arguments in each part are counted.
+            Then each thread initializes the superblocks whose first argument lies in its part.
+            The result equals the one of init(v). Only bit patterns of length 1 are initialized
+            in parallel.
+         */
+        void init(const int_vector<1>* v, uint32_t threads);
         void init_slow(const int_vector<1>* v=NULL);
         //! Select function
         /*! \sa select_support.select
          */
         inline const size_type select(size_type i) const;
+        //! Answers n select queries.
+        /*! \param i   Array of the n query arguments, each in [1..number of arguments].
+            \param n   Number of queries.
+            \param out Array of size n; out[j] is set to select(i[j]).
+            The three dependent memory accesses of a query (superblock, miniblock and
+            bit_vector) are prefetched in a pipeline SDSL_PREFETCH_DISTANCE queries apart,
+            so the cache misses of independent queries overlap.
+         */
+        void select(const size_type* i, size_type n, size_type* out) const;
         //! Alias for select(i).
         inline const size_type operator()(size_type i)const;
         size_type serialize(std::ostream& out, structure_tree_node* v=NULL, std::string name="")const;
@@ -478,16 +536,46 @@ void select_support_mcl<b,pattern_len>::init_fast(const int_vector<1>* v)
     m_miniblock = new int_vector<0>[sb];
 
     m_superblock = int_vector<0>(sb, 0, m_logn);// TODO: hier koennte man logn noch optimieren...s
+    std::vector<size_type> first_arg(sb, 0);
 
 #ifdef SDSL_DEBUG_SELECT_SUPPORT_JMC
     std::cerr<<"H1"<<std::endl;
 #endif
 
+    init_fast_superblocks(0, 0, 0, sb, &first_arg[0]);
+    for (size_type i=0; i < sb; ++i)
+        m_superblock[i] = first_arg[i];
+#ifdef SDSL_DEBUG_SELECT_SUPPORT_JMC
+    sw.stop();
+    std::cerr<<"Init tables  takes "<<sw.get_real_time()<<" ms"<<std::endl;
+#endif
+}
+
+// Creates the array of long superblocks, if it does not exist yet. Threads may call this concurrently.
+template<uint8_t b, uint8_t pattern_len>
+void select_support_mcl<b,pattern_len>::create_longsuperblock(size_type sb)
+{
+    if (m_longsuperblock == NULL) {
+        int_vector<0>* longsuperblock = new int_vector<0>[sb+1];
+        if (!__sync_bool_compare_and_swap(&m_longsuperblock, (int_vector<0>*)NULL, longsuperblock))
+            delete [] longsuperblock;
+    }
+}
+
+// Initializes the superblocks [sb_begin..sb_end-1] as init_fast does. word is the index of the word
+// which contains the first argument of superblock sb_begin and cnt the number of arguments before word.
+// The positions of the first arguments of the superblocks are stored in first_arg[sb_begin..sb_end-1].
+template<uint8_t b, uint8_t pattern_len>
+void select_support_mcl<b,pattern_len>::init_fast_superblocks(size_type word, size_type cnt, size_type sb_begin, size_type sb_end, size_type* first_arg)
+{
+    const int_vector<1>* v = m_v;
+    const size_type SUPER_BLOCK_SIZE = 64*64;
+    const size_type sb = (m_arg_cnt+SUPER_BLOCK_SIZE-1)/SUPER_BLOCK_SIZE; // number of superblocks
     bit_vector::size_type arg_position[SUPER_BLOCK_SIZE];
-    const uint64_t* data = v->data();
+    const uint64_t* data = v->data() + word;
     uint64_t carry_new=0;
-    size_type last_k64 = 1, sb_cnt=0;
-    for (size_type i=0, cnt_old=0, cnt_new=0, last_k64_sum=1; i < v->capacity(); i+=64, ++data) {
+    size_type last_k64 = 1, sb_cnt=sb_begin;
+    for (size_type i=word*64, cnt_old=cnt, cnt_new=cnt, last_k64_sum=(sb_begin*SUPER_BLOCK_SIZE)+1; i < v->capacity() and sb_cnt < sb_end; i+=64, ++data) {
         cnt_new += select_support_mcl_trait<b, pattern_len>::args_in_the_word(*data, carry_new);
         if (cnt_new >= last_k64_sum) {
             arg_position[last_k64-1] = i + select_support_mcl_trait<b, pattern_len>::ith_arg_pos_in_the_word(*data, last_k64_sum  - cnt_old, carry_new);
@@ -495,7 +583,7 @@ void select_support_mcl<b,pattern_len>::init_fast(const int_vector<1>* v)
             last_k64_sum += 64;
 
             if (last_k64 == SUPER_BLOCK_SIZE+1) {
-                m_superblock[sb_cnt] = arg_position[0];
+                first_arg[sb_cnt] = arg_position[0];
                 size_type pos_of_last_arg_in_the_block = arg_position[last_k64-65];
 
                 for (size_type i=arg_position[last_k64-65]+1, j=last_k64-65; i < v->size() and j < SUPER_BLOCK_SIZE; ++i)
@@ -505,7 +593,7 @@ void select_support_mcl<b,pattern_len>::init_fast(const int_vector<1>* v)
                     }
                 size_type pos_diff = pos_of_last_arg_in_the_block - arg_position[0];
                 if (pos_diff > m_logn4) { // long block
-                    if (m_longsuperblock == NULL) m_longsuperblock = new int_vector<0>[sb+1]; // create longsuperblock
+                    create_longsuperblock(sb); // create longsuperblock
                     // GEANDERT am 2010-07-17 +1 nach pos_of_last_arg..
                     m_longsuperblock[sb_cnt] = int_vector<0>(SUPER_BLOCK_SIZE, 0, bit_magic::l1BP(pos_of_last_arg_in_the_block) + 1);
                     for (size_type j=arg_position[0], k=0; j < pos_of_last_arg_in_the_block; ++j)
@@ -530,7 +618,7 @@ void select_support_mcl<b,pattern_len>::init_fast(const int_vector<1>* v)
     // TODO: handle last block!!! einfach ein longsuperblock anhaengen?
     if (last_k64 > 1) {
         // GEANDERT am 2010-09-27 +1 nach sb, da wir den superblock extra zu den existierenden anhaengen koennen
-        if (m_longsuperblock == NULL) m_longsuperblock = new int_vector<0>[sb+1]; // create longsuperblock
+        create_longsuperblock(sb); // create longsuperblock
         m_longsuperblock[sb_cnt] = int_vector<0>(SUPER_BLOCK_SIZE, 0, bit_magic::l1BP(v->size()-1) + 1);
         for (size_type i=arg_position[0],k=0; i < v->size(); ++i) {
             if (select_support_mcl_trait<b, pattern_len>::found_arg(i, *v)) {
@@ -539,10 +627,43 @@ void select_support_mcl<b,pattern_len>::init_fast(const int_vector<1>* v)
         }
         ++sb_cnt;
     }
-#ifdef SDSL_DEBUG_SELECT_SUPPORT_JMC
-    sw.stop();
-    std::cerr<<"Init tables  takes "<<sw.get_real_time()<<" ms"<<std::endl;
-#endif
+}
+
+template<uint8_t b, uint8_t pattern_len>
+void select_support_mcl<b,pattern_len>::init_fast(const int_vector<1>* v, uint32_t threads)
+{
+    set_vector(v);
+    initData();
+    const size_type words = v->capacity()>>6;
+    std::vector<init_task> tasks(threads);
+    for (uint32_t t=0; t < threads; ++t) {
+        tasks[t].ss = this;
+        tasks[t].wb = parallel::part_begin(words, threads, t);
+        tasks[t].we = parallel::part_begin(words, threads, t+1);
+        tasks[t].first_pass = true;
+    }
+    parallel::run(tasks);
+    for (uint32_t t=0; t < threads; ++t) {
+        size_type part_cnt = tasks[t].cnt;
+        tasks[t].cnt = m_arg_cnt;
+        tasks[t].first_pass = false;
+        m_arg_cnt += part_cnt;
+    }
+    const size_type SUPER_BLOCK_SIZE = 64*64;
+    if (m_arg_cnt==0) // if there are no arguments in the vector we are done...
+        return;
+    size_type sb = (m_arg_cnt+SUPER_BLOCK_SIZE-1)/SUPER_BLOCK_SIZE; // number of superblocks
+    m_miniblock = new int_vector<0>[sb];
+    m_superblock = int_vector<0>(sb, 0, m_logn);
+    std::vector<size_type> first_arg(sb, 0);
+    for (uint32_t t=0; t < threads; ++t) { // superblock s belongs to the part which contains its first argument s*SUPER_BLOCK_SIZE
+        tasks[t].sb_begin  = (tasks[t].cnt+SUPER_BLOCK_SIZE-1)/SUPER_BLOCK_SIZE;
+        tasks[t].sb_end    = (t+1 < threads) ? (tasks[t+1].cnt+SUPER_BLOCK_SIZE-1)/SUPER_BLOCK_SIZE : sb;
+        tasks[t].first_arg = &first_arg[0];
+    }
+    parallel::run(tasks);
+    for (size_type i=0; i < sb; ++i)
+        m_superblock[i] = first_arg[i];
 }
 
 template<uint8_t b, uint8_t pattern_len>
@@ -555,6 +676,17 @@ void select_support_mcl<b,pattern_len>::init(const int_vector<1>* v)
     return;
 }
 
+template<uint8_t b, uint8_t pattern_len>
+void select_support_mcl<b,pattern_len>::init(const int_vector<1>* v, uint32_t threads)
+{
+    if (v != NULL and threads > (v->capacity()>>22)) // each thread processes at least 2^22 bits
+        threads = v->capacity()>>22;
+    if (pattern_len>1 or v == NULL or v->size() < 100000 or threads <= 1)
+        init(v);
+    else
+        init_fast(v, threads);
+}
+
 template<uint8_t b, uint8_t pattern_len>
 inline const typename select_support_mcl<b,pattern_len>::size_type select_support_mcl<b,pattern_len>::select(size_type i)const
 {
@@ -615,6 +747,55 @@ inline const typename select_support_mcl<b,pattern_len>::size_type select_suppor
     }
 }
 
+template<uint8_t b, uint8_t pattern_len>
+inline void select_support_mcl<b,pattern_len>::prefetch_superblock(size_type i)const
+{
+    size_type sb_idx = (i-1)>>12;
+    SDSL_PREFETCH(m_superblock.data() + ((sb_idx*m_superblock.get_int_width())>>6));
+    SDSL_PREFETCH(m_longsuperblock + sb_idx);
+    SDSL_PREFETCH(m_miniblock + sb_idx);
+}
+
+template<uint8_t b, uint8_t pattern_len>
+inline void select_support_mcl<b,pattern_len>::prefetch_miniblock(size_type i)const
+{
+    size_type sb_idx = (i-1)>>12, offset = (i-1)&0xFFF;
+    if (m_longsuperblock!=NULL and !m_longsuperblock[sb_idx].empty()) {
+        const int_vector<0>& lsb = m_longsuperblock[sb_idx];
+        SDSL_PREFETCH(lsb.data() + ((offset*lsb.get_int_width())>>6));
+    } else {
+        const int_vector<0>& mb = m_miniblock[sb_idx];
+        SDSL_PREFETCH(mb.data() + (((offset>>6)*mb.get_int_width())>>6));
+    }
+}
+
+template<uint8_t b, uint8_t pattern_len>
+inline void select_support_mcl<b,pattern_len>::prefetch_word(size_type i)const
+{
+    size_type sb_idx = (i-1)>>12, offset = (i-1)&0xFFF;
+    if ((m_longsuperblock==NULL or m_longsuperblock[sb_idx].empty()) and (offset&0x3F)!=0) {
+        size_type pos = m_superblock[sb_idx] + m_miniblock[sb_idx][offset>>6] + 1;
+        SDSL_PREFETCH(m_v->data() + (pos>>6));
+    }
+}
+
+template<uint8_t b, uint8_t pattern_len>
+inline void select_support_mcl<b,pattern_len>::select(const size_type* i, size_type n, size_type* out)const
+{
+    const size_type d = SDSL_PREFETCH_DISTANCE;
+    // query j is answered in round j+3d; its memory is prefetched in rounds j, j+d and j+2d
+    for (size_type j=0; j < n+3*d; ++j) {
+        if (j < n)
+            prefetch_superblock(i[j]);
+        if (j >= d and j-d < n)
+            prefetch_miniblock(i[j-d]);
+        if (j >= 2*d and j-2*d < n)
+            prefetch_word(i[j-2*d]);
+        if (j >= 3*d and j-3*d < n)
+            out[j-3*d] = select_support_mcl::select(i[j-3*d]);
+    }
+}
+
 template<uint8_t b, uint8_t pattern_len>
 inline const typename select_support_mcl<b,pattern_len>::size_type select_support_mcl<b,pattern_len>::operator()(size_type i)const
 {
@@ -762,6 +943,15 @@ bool select_support_mcl<b,pattern_len>::operator!=(const select_support_mcl& ss)
     return !(*this == ss);
 }
 
+namespace util
+{
+//! Initialise select_support_mcl with several threads
+template<uint8_t b, uint8_t pattern_len>
+void init_support(select_support_mcl<b, pattern_len>& s, const int_vector<1>* x, uint32_t threads)
+{
+    s.init(x, threads);
+}
+}
 
 }
 
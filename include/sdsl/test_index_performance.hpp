@@ -25,10 +25,15 @@
 #include "testutils.hpp"	// for write_R_output 
 #include "util.hpp"			// for 
 #include "algorithms.hpp"	// for backward_search
+#include "rank_support_v.hpp"     // for the multi-threaded init_support
+#include "select_support_mcl.hpp" // for the multi-threaded init_support
+#include "parallel.hpp"       // for the multi-threaded query benchmarks
 #include "testutils.hpp"    // for file
 #include <cstdlib>			// for rand 
 #include <algorithm>		// for swap
 #include <vector>			// for std::vector	
+#include <utility>			// for std::pair
+#include <limits>			// for std::numeric_limits
 #include <iostream>
 
 namespace sdsl
@@ -39,6 +44,86 @@ namespace sdsl
  */
 int_vector<64> get_rnd_positions(uint8_t log_s, uint64_t& mask, uint64_t m=0, uint64_t x=17);
 
+//! Test the speed of the implementations of the bit_magic primitives
+/*!
+ * \param times Number of calls of each implementation.
+ * Implementations which are not supported by the CPU are skipped.
+ */
+inline void test_bit_magic_variants(bit_vector::size_type times=100000000)
+{
+    typedef bit_vector::size_type size_type;
+    uint64_t mask;
+    int_vector<64> rands = get_rnd_positions(20, mask);
+    size_type cnt=0;
+    write_R_output("bit_magic","b1Cnt swar","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        cnt += bit_magic::b1CntSwar(rands[i&mask]);
+    }
+    write_R_output("bit_magic","b1Cnt swar","end",times,cnt);
+    if (bit_magic::cpu_popcnt) {
+        cnt = 0;
+        write_R_output("bit_magic","b1Cnt popcnt","begin",times,cnt);
+        for (size_type i=0; i<times; ++i) {
+            cnt += bit_magic::b1CntPopcnt(rands[i&mask]);
+        }
+        write_R_output("bit_magic","b1Cnt popcnt","end",times,cnt);
+    }
+    cnt = 0;
+    write_R_output("bit_magic","b1Cnt bulk","begin",times,cnt);
+    for (size_type i=0; i<times; i+=rands.size()) {
+        cnt += bit_magic::b1Cnt(rands.data(), rands.size());
+    }
+    write_R_output("bit_magic","b1Cnt bulk","end",times,cnt);
+    // the i-th 1-bit with i in [1..b1Cnt(x)]; x|1 ensures that there is one
+    cnt = 0;
+    write_R_output("bit_magic","i1BP2","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        uint64_t x = rands[i&mask]|1;
+        cnt += bit_magic::i1BP2(x, (i%bit_magic::b1Cnt(x))+1);
+    }
+    write_R_output("bit_magic","i1BP2","end",times,cnt);
+    cnt = 0;
+    write_R_output("bit_magic","k1BP","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        uint64_t x = rands[i&mask]|1;
+        cnt += bit_magic::k1BP(x, (i%bit_magic::b1Cnt(x))+1);
+    }
+    write_R_output("bit_magic","k1BP","end",times,cnt);
+    if (bit_magic::cpu_bmi2) {
+        cnt = 0;
+        write_R_output("bit_magic","i1BP pdep","begin",times,cnt);
+        for (size_type i=0; i<times; ++i) {
+            uint64_t x = rands[i&mask]|1;
+            cnt += bit_magic::i1BPPdep(x, (i%bit_magic::b1Cnt(x))+1);
+        }
+        write_R_output("bit_magic","i1BP pdep","end",times,cnt);
+    }
+    cnt = 0;
+    write_R_output("bit_magic","l1BP table","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        cnt += bit_magic::l1BPTable(rands[i&mask]);
+    }
+    write_R_output("bit_magic","l1BP table","end",times,cnt);
+    cnt = 0;
+    write_R_output("bit_magic","l1BP","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        cnt += bit_magic::l1BP(rands[i&mask]);
+    }
+    write_R_output("bit_magic","l1BP","end",times,cnt);
+    cnt = 0;
+    write_R_output("bit_magic","r1BP table","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        cnt += bit_magic::r1BPTable(rands[i&mask]);
+    }
+    write_R_output("bit_magic","r1BP table","end",times,cnt);
+    cnt = 0;
+    write_R_output("bit_magic","r1BP","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        cnt += bit_magic::r1BP(rands[i&mask]);
+    }
+    write_R_output("bit_magic","r1BP","end",times,cnt);
+}
+
 template<class Vector>
 void test_int_vector_random_access(const Vector& v, bit_vector::size_type times=100000000)
 {
@@ -98,24 +183,90 @@ void test_rank_random_access(const Rank& rank, bit_vector::size_type times=20000
     write_R_output("rank","random access","end",times,cnt);
 }
 
+//! Compare the throughput of the batched rank method with the scalar one
+/*!
+ * \param times Number of random queries.
+ * \param batch Number of queries per call of the batched rank method; a power of two \f$\leq 2^{20}\f$.
+ */
+template<class Rank>
+void test_rank_batch_random_access(const Rank& rank, bit_vector::size_type times=20000000,
+                                   bit_vector::size_type batch=1024)
+{
+    typedef bit_vector::size_type size_type;
+    uint64_t mask;
+    int_vector<64> rands = get_rnd_positions(20, mask, rank.size()+1);
+    times -= times % batch;
+    std::vector<size_type> out(batch);
+    size_type cnt=0;
+    write_R_output("rank","scalar loop","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        cnt += rank.rank(rands[ i&mask ]);
+    }
+    write_R_output("rank","scalar loop","end",times,cnt);
+    cnt=0;
+    write_R_output("rank","batch","begin",times,cnt);
+    for (size_type i=0; i<times; i+=batch) {
+        rank.rank(rands.data() + (i&mask), batch, &out[0]);
+        for (size_type j=0; j<batch; ++j)
+            cnt += out[j];
+    }
+    write_R_output("rank","batch","end",times,cnt);
+}
+
 //! Test creation time for a rank data structure
 /*
- * param size The size of the bit vector in bits for which to rank_support should be created
+ * param size        The size of the bit vector in bits for which to rank_support should be created
+ * param max_threads The construction is measured with 1, 2, 4, ... threads up to max_threads
  */
 template<class Rank>
-void test_rank_construction(bit_vector::size_type size=838860800)
+void test_rank_construction(bit_vector::size_type size=838860800, uint32_t max_threads=1)
 {
     typedef bit_vector::size_type size_type;
     bit_vector b(size);
     util::set_random_bits(b, 17);
     std::cout<<"# bit vector size of rank construct : "<<size<<std::endl;
-    write_R_output("rank","construct","begin",1,0);
-    Rank rs(&b); // construct rank_support data structure
-    write_R_output("rank","construct","end",1,rs(size));
+    for (uint32_t threads=1; threads <= max_threads; threads*=2) {
+        Rank rs;
+        write_R_output("rank","construct","begin",threads,0);
+        util::init_support(rs, &b, threads); // construct rank_support data structure
+        write_R_output("rank","construct","end",threads,rs(size));
+    }
 }
 
 
 
+//! Compare the throughput of the batched select method with the scalar one
+/*!
+ * \param times Number of random queries.
+ * \param batch Number of queries per call of the batched select method; a power of two \f$\leq 2^{20}\f$.
+ */
+template<class Select>
+void test_select_batch_random_access(const Select& select, bit_vector::size_type times=20000000,
+                                     bit_vector::size_type batch=1024)
+{
+    typedef bit_vector::size_type size_type;
+    uint64_t mask;
+    int_vector<64> rands = get_rnd_positions(20, mask, util::get_one_bits(*(select.v)));
+    for (size_type i=0; i<rands.size(); ++i)
+        rands[i] = rands[i]+1;
+    times -= times % batch;
+    std::vector<size_type> out(batch);
+    size_type cnt=0;
+    write_R_output("select","scalar loop","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        cnt += select.select(rands[ i&mask ]);
+    }
+    write_R_output("select","scalar loop","end",times,cnt);
+    cnt=0;
+    write_R_output("select","batch","begin",times,cnt);
+    for (size_type i=0; i<times; i+=batch) {
+        select.select(rands.data() + (i&mask), batch, &out[0]);
+        for (size_type j=0; j<batch; ++j)
+            cnt += out[j];
+    }
+    write_R_output("select","batch","end",times,cnt);
+}
+
 //! Test random queries on select data structure
 /*
  */
@@ -163,19 +314,62 @@ void test_select_random_access(const Select& select, bit_vector::size_type args,
 
 //! Test creation time for a rank data structure
 /*
- * param size The size of the bit vector in bits for which to rank_support should be created
+ * param size        The size of the bit vector in bits for which to select_support should be created
+ * param max_threads The construction is measured with 1, 2, 4, ... threads up to max_threads
  */
 template<class Select>
-void test_select_construction(bit_vector::size_type size=838860800)
+void test_select_construction(bit_vector::size_type size=838860800, uint32_t max_threads=1)
 {
     typedef bit_vector::size_type size_type;
     bit_vector b(size);
     util::set_random_bits(b, 17);
     std::cout<<"# bit vector size of select construct : "<<size<<std::endl;
-    write_R_output("select","construct","begin",1,0);
-    Select sls(&b); // construct rank_support data structure
-    write_R_output("select","construct","end",1, sls(1));
-    std::cout<<"# size of the select_support_mcl :  "<< ((double)util::get_size_in_bytes(sls))/util::get_size_in_bytes(b) <<std::endl;
+    for (uint32_t threads=1; threads <= max_threads; threads*=2) {
+        Select sls;
+        write_R_output("select","construct","begin",threads,0);
+        util::init_support(sls, &b, threads); // construct select_support data structure
+        write_R_output("select","construct","end",threads, sls(1));
+        if (threads == 1)
+            std::cout<<"# size of the select_support_mcl :  "<< ((double)util::get_size_in_bytes(sls))/util::get_size_in_bytes(b) <<std::endl;
+    }
+}
+
+//! Test random rank and select queries for growing bit vectors
+/*!
+ * \param log_min The smallest bit vector has \f$2^{log\_min}\f$ bits.
+ * \param log_max The largest bit vector has \f$2^{log\_max}\f$ bits; choose log_max > 32 to check
+ *                that there is no slow down for bit vectors with more than \f$2^{32}\f$ bits.
+ * \param times   Number of random queries per bit vector and query type.
+ */
+template<class Rank, class Select>
+void test_rank_select_scaling(uint8_t log_min=28, uint8_t log_max=33, bit_vector::size_type times=10000000)
+{
+    typedef bit_vector::size_type size_type;
+    for (uint8_t l=log_min; l <= log_max; ++l) {
+        size_type size = 1ULL<<l;
+        std::cout<<"# bit vector size of rank and select scaling : "<<size<<std::endl;
+        bit_vector b(size);
+        util::set_random_bits(b, 17);
+        Rank rank(&b);
+        Select select(&b);
+        uint64_t mask;
+        int_vector<64> rands = get_rnd_positions(20, mask, size+1);
+        size_type cnt=0;
+        write_R_output("rank","scaling","begin",times,cnt);
+        for (size_type i=0; i<times; ++i) {
+            cnt += rank.rank(rands[ i&mask ]);
+        }
+        write_R_output("rank","scaling","end",times,cnt);
+        size_type ones = rank.rank(size);
+        for (size_type i=0; i<rands.size(); ++i)
+            rands[i] = rands[i]%ones + 1;
+        cnt=0;
+        write_R_output("select","scaling","begin",times,cnt);
+        for (size_type i=0; i<times; ++i) {
+            cnt += select.select(rands[ i&mask ]);
+        }
+        write_R_output("select","scaling","end",times,cnt);
+    }
 }
 
 template<class Csa>
@@ -192,6 +386,89 @@ void test_csa_access(const Csa& csa, typename Csa::size_type times=1000000)
     write_R_output("csa","csa[]","end",times,cnt);
 }
 
+//! A task which answers csa[] queries for test_csa_access_threads.
+template<class Csa>
+struct csa_access_task {
+    typedef typename Csa::size_type size_type;
+    const Csa* csa;
+    const int_vector<64>* rands;
+    uint64_t mask;
+    size_type begin, times, cnt;
+    void operator()() {
+        cnt = 0;
+        for (size_type i=begin; i<begin+times; ++i) {
+            cnt += (*csa)[ (*rands)[ i&mask ] ];
+        }
+    }
+};
+
+//! Test the throughput of csa[] with several query threads on one csa
+/*!
+ * \param times       Number of random queries per thread.
+ * \param max_threads The throughput is measured with 1, 2, 4, ... threads up to max_threads.
+ * The reported times are the total number of queries, so the time stays constant if the
+ * throughput scales linearly with the number of threads.
+ */
+template<class Csa>
+void test_csa_access_threads(const Csa& csa, typename Csa::size_type times=1000000, uint32_t max_threads=1)
+{
+    typedef typename Csa::size_type size_type;
+    uint64_t mask;
+    int_vector<64> rands = get_rnd_positions(20, mask, csa.size());
+    for (uint32_t threads=1; threads <= max_threads; threads*=2) {
+        std::vector<csa_access_task<Csa> > tasks(threads);
+        for (uint32_t t=0; t < threads; ++t) {
+            tasks[t].csa = &csa;
+            tasks[t].rands = &rands;
+            tasks[t].mask = mask;
+            tasks[t].begin = t*times; // each thread queries other positions
+            tasks[t].times = times;
+        }
+        std::string action = "csa[] " + util::to_string(threads) + " threads";
+        write_R_output("csa",action,"begin",threads*times,0);
+        parallel::run(tasks);
+        size_type cnt = 0;
+        for (uint32_t t=0; t < threads; ++t)
+            cnt += tasks[t].cnt;
+        write_R_output("csa",action,"end",threads*times,cnt);
+    }
+}
+
+//! Compare the extraction of single snippets with the extraction of a batch of snippets
+/*!
+ * \param times Number of snippets.
+ * \param len   Length of a snippet.
+ */
+template<class Csa>
+void test_csa_extract(const Csa& csa, typename Csa::size_type times=100000, typename Csa::size_type len=100)
+{
+    typedef typename Csa::size_type size_type;
+    if (csa.size() < len)
+        return;
+    size_type cnt=0;
+    uint64_t mask;
+    int_vector<64> rands = get_rnd_positions(20, mask, csa.size()-len+1);
+    std::vector<unsigned char> text(len+1);
+    write_R_output("csa","extract","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        algorithm::extract(csa, rands[i&mask], rands[i&mask]+len-1, &text[0]);
+        cnt += text[0];
+    }
+    write_R_output("csa","extract","end",times,cnt);
+    std::vector<std::pair<size_type, size_type> > snippets(times);
+    for (size_type i=0; i<times; ++i) {
+        snippets[i] = std::make_pair(rands[i&mask], rands[i&mask]+len-1);
+    }
+    std::vector<std::string> result;
+    cnt = 0;
+    write_R_output("csa","extract_many","begin",times,cnt);
+    algorithm::extract_many(csa, snippets, result);
+    for (size_type i=0; i<times; ++i) {
+        cnt += (unsigned char)result[i][0];
+    }
+    write_R_output("csa","extract_many","end",times,cnt);
+}
+
 template<class Csa>
 void test_icsa_access(const Csa& csa, typename Csa::size_type times=1000000)
 {
@@ -206,7 +483,10 @@ void test_icsa_access(const Csa& csa, typename Csa::size_type times=1000000)
     write_R_output("csa","csa()","end",times,cnt);
 }
 
-// Test random access on \f$\Psi\f$ function
+//! Test random access on \f$\Psi\f$ function
+/*! Reports the time of times random accesses ("psi[]") and of times dependent accesses
+ *  \f$i=\Psi(i)\f$, which walk forward over the text like the suffix links of a cst ("psi[] walk").
+ */
 template<class Csa>
 void test_psi_access(const Csa& csa, typename Csa::size_type times=1000000)
 {
@@ -219,6 +499,13 @@ void test_psi_access(const Csa& csa, typename Csa::size_type times=1000000)
         cnt += csa.psi[rands[ i&mask ]];
     }
     write_R_output("csa","psi[]","end",times,cnt);
+    size_type j = rands[0];
+    write_R_output("csa","psi[] walk","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        j = csa.psi[j];
+        cnt += j;
+    }
+    write_R_output("csa","psi[] walk","end",times,cnt);
 }
 
 //! Test random access on LF function
@@ -294,6 +581,62 @@ void test_pattern_matching(const Csa& csa,
 }
 
 
+//! Test the throughput of locate depending on the number of occurrences
+/*!
+ * \param pattern_len Length of the patterns, which are extracted from random positions of the text.
+ * \param times       Maximal number of patterns per class.
+ * \par Selection of patterns: The patterns are grouped by the magnitude \f$10^k\f$ of their
+ *      number of occurrences. For each class the suffix array values are once calculated by single
+ *      accesses to csa[] and once by algorithm::locate, which batches the accesses for some csas.
+ *      The reported times are the number of occurrences.
+ */
+template<class Csa>
+void test_locate(const Csa& csa, typename Csa::size_type pattern_len=3, typename Csa::size_type times=10000)
+{
+    typedef typename Csa::size_type size_type;
+    if (csa.size() <= pattern_len)
+        return;
+    uint64_t mask;
+    int_vector<64> rands = get_rnd_positions(14, mask, csa.size()-pattern_len);
+    std::vector<std::vector<std::string> > patterns; // patterns[k] contains patterns with [10^k..10^{k+1}) occurrences
+    for (size_type i=0; i<rands.size(); ++i) {
+        std::string pattern = algorithm::extract(csa, rands[i], rands[i]+pattern_len-1);
+        if (pattern.find('\0') != std::string::npos)
+            continue;
+        size_type occs = algorithm::count(csa, (const unsigned char*)pattern.c_str(), pattern_len), k=0;
+        for (; occs >= 10; occs /= 10) ++k;
+        if (k >= patterns.size())
+            patterns.resize(k+1);
+        if (patterns[k].size() < times)
+            patterns[k].push_back(pattern);
+    }
+    std::vector<size_type> occ;
+    for (size_type k=0; k<patterns.size(); ++k) {
+        if (patterns[k].empty())
+            continue;
+        std::string action = "locate 10^" + util::to_string(k);
+        size_type cnt=0, occs=0;
+        for (size_type i=0; i<patterns[k].size(); ++i) {
+            occs += algorithm::count(csa, (const unsigned char*)patterns[k][i].c_str(), pattern_len);
+        }
+        write_R_output("csa",action+" csa[]","begin",occs,cnt);
+        for (size_type i=0, l_res=0, r_res=0; i<patterns[k].size(); ++i) {
+            algorithm::backward_search(csa, 0, csa.size()-1, (const unsigned char*)patterns[k][i].c_str(), pattern_len, l_res, r_res);
+            for (size_type j=l_res; j<=r_res; ++j)
+                cnt += csa[j];
+        }
+        write_R_output("csa",action+" csa[]","end",occs,cnt);
+        cnt = 0;
+        write_R_output("csa",action,"begin",occs,cnt);
+        for (size_type i=0; i<patterns[k].size(); ++i) {
+            algorithm::locate(csa, (const unsigned char*)patterns[k][i].c_str(), pattern_len, occ);
+            for (size_type j=0; j<occ.size(); ++j)
+                cnt += occ[j];
+        }
+        write_R_output("csa",action,"end",occs,cnt);
+    }
+}
+
 template<class Csa>
 void test_rank_bwt_access(const Csa& csa, typename Csa::size_type times=1000000)
 {
@@ -337,6 +680,160 @@ void test_select_bwt_access(const Csa& csa, typename Csa::size_type times=500000
     write_R_output("csa","select_bwt","end",times,cnt);
 }
 
+//! Test random access, rank and select on a wavelet tree over an integer alphabet (e.g. wt_int or wt_matrix)
+/*! The symbols of the rank and select queries are taken from random positions of the sequence.
+ */
+template<class Wt>
+void test_wt_int_access(const Wt& wt, typename Wt::size_type times=1000000)
+{
+    typedef typename Wt::size_type size_type;
+    uint64_t mask;
+    int_vector<64> rands = get_rnd_positions(20, mask, wt.size());
+    int_vector<64> c_rands(rands.size()), k_rands(rands.size());
+    for (size_type i=0; i<rands.size(); ++i) {
+        c_rands[i] = wt[ rands[i] ];
+        k_rands[i] = wt.rank(rands[i]+1, c_rands[i]);
+    }
+    size_type cnt=0;
+    write_R_output("wt","[]","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        cnt += wt[ rands[ i&mask ] ];
+    }
+    write_R_output("wt","[]","end",times,cnt);
+    write_R_output("wt","rank","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        cnt += wt.rank(rands[ i&mask ], c_rands[ i&mask ]);
+    }
+    write_R_output("wt","rank","end",times,cnt);
+    write_R_output("wt","select","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        cnt += wt.select(k_rands[ i&mask ], c_rands[ i&mask ]);
+    }
+    write_R_output("wt","select","end",times,cnt);
+}
+
+template<class T1, class T2>
+bool _greater_second(const std::pair<T1, T2>& a, const std::pair<T1, T2>& b)
+{
+    return a.second > b.second;
+}
+
+//! Test range_search_2d on a wavelet tree over an integer alphabet
+/*!
+ * \param idx_len Length of the index interval of the queries.
+ * \param val_len Length of the value interval of the queries.
+ * \param report  If true, the indices and values of the points are reported, otherwise only counted.
+ * \param max_results Maximal number of points reported per query.
+ */
+template<class Wt>
+void test_wt_int_range_search_2d(const Wt& wt, typename Wt::size_type times=100000,
+                                 typename Wt::size_type idx_len=1000, typename Wt::size_type val_len=1000, bool report=true,
+                                 typename Wt::size_type max_results=std::numeric_limits<typename Wt::size_type>::max())
+{
+    typedef typename Wt::size_type size_type;
+    typedef typename Wt::value_type value_type;
+    uint64_t mask;
+    int_vector<64> rands = get_rnd_positions(20, mask, wt.size()-std::min(wt.size()-1, idx_len-1));
+    std::vector<size_type> idx;
+    std::vector<value_type> val;
+    size_type cnt=0;
+    write_R_output("wt","range_search_2d","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        size_type lb = rands[ i&mask ];
+        value_type vlb = wt[lb];
+        vlb -= std::min(vlb, (value_type)val_len/2);
+        cnt += wt.range_search_2d(lb, std::min(wt.size()-1, lb+idx_len-1), vlb, vlb+val_len-1,
+                                  report ? &idx : NULL, report ? &val : NULL, max_results);
+        idx.clear(); val.clear();
+    }
+    write_R_output("wt","range_search_2d","end",times,cnt);
+}
+
+//! Test range_quantile, range_top_k and range_next_value on a wavelet tree over an integer alphabet
+/*!
+ * \param idx_len Length of the index interval of the queries.
+ * \param k       Number of values reported by range_top_k.
+ * \par Details
+ *      For comparison, each query is also answered by enumerating the
+ *      values of the index interval with range_search_2d.
+ */
+template<class Wt>
+void test_wt_int_range_queries(const Wt& wt, typename Wt::size_type times=100000,
+                               typename Wt::size_type idx_len=1000, typename Wt::size_type k=10)
+{
+    typedef typename Wt::size_type size_type;
+    typedef typename Wt::value_type value_type;
+    uint64_t mask;
+    int_vector<64> rands = get_rnd_positions(20, mask, wt.size()-std::min(wt.size()-1, idx_len-1));
+    value_type max_val = 0;
+    for (size_type i=0; i < wt.size(); ++i)
+        max_val = std::max(max_val, (value_type)wt[i]);
+    std::vector<value_type> val;
+    std::vector<std::pair<value_type, size_type> > top_k;
+    size_type cnt=0;
+    write_R_output("wt","range_quantile","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        size_type lb = rands[ i&mask ], rb = std::min(wt.size()-1, lb+idx_len-1);
+        cnt += wt.range_quantile(lb, rb, (rb-lb)/2).first;
+    }
+    write_R_output("wt","range_quantile","end",times,cnt);
+    cnt=0;
+    write_R_output("wt","range_quantile_2d","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        size_type lb = rands[ i&mask ], rb = std::min(wt.size()-1, lb+idx_len-1);
+        wt.range_search_2d(lb, rb, 0, max_val, NULL, &val);
+        std::nth_element(val.begin(), val.begin()+(rb-lb)/2, val.end());
+        cnt += val[(rb-lb)/2];
+        val.clear();
+    }
+    write_R_output("wt","range_quantile_2d","end",times,cnt);
+    cnt=0;
+    write_R_output("wt","range_top_k","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        size_type lb = rands[ i&mask ], rb = std::min(wt.size()-1, lb+idx_len-1);
+        wt.range_top_k(lb, rb, k, top_k);
+        cnt += top_k[0].second;
+    }
+    write_R_output("wt","range_top_k","end",times,cnt);
+    cnt=0;
+    write_R_output("wt","range_top_k_2d","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        size_type lb = rands[ i&mask ], rb = std::min(wt.size()-1, lb+idx_len-1);
+        wt.range_search_2d(lb, rb, 0, max_val, NULL, &val);
+        std::sort(val.begin(), val.end());
+        top_k.clear();
+        for (size_type j=0, l=0; j < val.size(); j=l) {
+            for (l=j+1; l < val.size() and val[l] == val[j]; ++l) {}
+            top_k.push_back(std::make_pair(val[j], l-j));
+        }
+        size_type kk = std::min((size_type)top_k.size(), k);
+        std::partial_sort(top_k.begin(), top_k.begin()+kk, top_k.end(), _greater_second<value_type, size_type>);
+        cnt += top_k[0].second;
+        val.clear();
+    }
+    write_R_output("wt","range_top_k_2d","end",times,cnt);
+    cnt=0;
+    value_type y = 0;
+    write_R_output("wt","range_next_value","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        size_type lb = rands[ i&mask ], rb = std::min(wt.size()-1, lb+idx_len-1);
+        if (wt.range_next_value(lb, rb, rands[ (i+1)&mask ]%(max_val+1), y))
+            cnt += y;
+    }
+    write_R_output("wt","range_next_value","end",times,cnt);
+    cnt=0;
+    write_R_output("wt","range_next_value_2d","begin",times,cnt);
+    for (size_type i=0; i<times; ++i) {
+        size_type lb = rands[ i&mask ], rb = std::min(wt.size()-1, lb+idx_len-1);
+        value_type x = rands[ (i+1)&mask ]%(max_val+1);
+        wt.range_search_2d(lb, rb, x, max_val, NULL, &val);
+        if (!val.empty())
+            cnt += *std::min_element(val.begin(), val.end());
+        val.clear();
+    }
+    write_R_output("wt","range_next_value_2d","end",times,cnt);
+}
+
 //! Test performance of the depth first iterator of a CST
 /*!
  * \param cst The CST that should be tested.
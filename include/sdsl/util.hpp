@@ -84,6 +84,16 @@ void set_zero_bits(int_vector_type& v);
 //! Sets all bits of the int_vector to 1-bits.
 template<class int_vector_type>
 void set_one_bits(int_vector_type& v);
+//! Atomically sets the len <= 64 bits starting at bit position idx of the int_vector to 1-bits.
+/*! Threads which set bits in the same 64-bit word of v have to use this method.
+ */
+template<class int_vector_type>
+void set_one_bits_atomic(int_vector_type& v, uint64_t idx, uint8_t len);
+//! Atomically ORs the len <= 64 lowest bits of x into the bits starting at bit position idx of the int_vector.
+/*! If these bits are 0, x is written. Threads which write to the same 64-bit word of v have to use this method.
+ */
+template<class int_vector_type>
+void or_bits_atomic(int_vector_type& v, uint64_t idx, uint64_t x, uint8_t len);
 
 //! Bit compress the int_vector
 /*! Determine the biggest value X and then set the
@@ -108,6 +118,14 @@ void all_elements_mod(int_vector_type& v, size_type_class m);
 template<class int_vector_type>
 void set_all_values_to_k(int_vector_type& v, uint64_t k);
 
+//! Throws std::length_error if the integers of v are too narrow to store max_value.
+/*! This detects vectors with a fixed int width (e.g. int_vector<32>), on which set_int_width
+ *  has no effect, that should store positions of a text with more than \f$2^{32}\f$ characters.
+ *  \param name Name of the data structure for the error message.
+ */
+template<class int_vector_type>
+void check_int_width(const int_vector_type& v, uint64_t max_value, const std::string& name);
+
 //! Sets each entry of the numerical vector v at position \$fi\f$ to value \$fi\$f
 template<class int_vector_type>
 void set_to_id(int_vector_type& v);
@@ -352,6 +370,18 @@ void init_support(S& s, const X* x)
     s.set_vector(x);    // set the support object's  pointer to x
 }
 
+//! Initialise support data structure with several threads
+/*! \param s       Support structure which should be initialized
+ *  \param x       Pointer to the data structure which should be supported.
+ *  \param threads Number of threads. Support structures without a multi-threaded
+ *                 initialization ignore it, the others overload this function.
+ */
+template<class S, class X>
+void init_support(S& s, const X* x, uint32_t)
+{
+    init_support(s, x);
+}
+
 template<format_type F, class X>
 void write_structure(const X& x, std::ostream& out)
 {
@@ -512,6 +542,27 @@ void util::set_one_bits(int_vector_type& v)
     }
 }
 
+template<class int_vector_type>
+void util::set_one_bits_atomic(int_vector_type& v, uint64_t idx, uint8_t len)
+{
+    or_bits_atomic(v, idx, 0xFFFFFFFFFFFFFFFFULL, len);
+}
+
+template<class int_vector_type>
+void util::or_bits_atomic(int_vector_type& v, uint64_t idx, uint64_t x, uint8_t len)
+{
+    if (len == 0)
+        return;
+    uint64_t* data = v.m_data + (idx>>6);
+    uint8_t offset = idx&0x3F;
+    if (len < 64)
+        x &= (1ULL<<len)-1;
+    __sync_fetch_and_or(data, x << offset);
+    if (offset + len > 64) {
+        __sync_fetch_and_or(data+1, x >> (64-offset));
+    }
+}
+
 template<class int_vector_type>
 void util::bit_compress(int_vector_type& v)
 {
@@ -538,6 +589,15 @@ void util::bit_compress(int_vector_type& v)
 }
 
 
+template<class int_vector_type>
+void util::check_int_width(const int_vector_type& v, uint64_t max_value, const std::string& name)
+{
+    if (max_value > 0 and bit_magic::l1BP(max_value)+1 > v.get_int_width()) {
+        throw std::length_error(name+": the value "+util::to_string(max_value)+" does not fit into the int width "
+                                +util::to_string((uint32_t)v.get_int_width()));
+    }
+}
+
 template<class int_vector_type>
 void util::set_all_values_to_k(int_vector_type& v, uint64_t k)
 {
@@ -587,10 +647,8 @@ typename int_vector_type::size_type util::get_one_bits(const int_vector_type& v)
     const uint64_t* data = v.data();
     if (v.empty())
         return 0;
-    typename int_vector_type::size_type result = bit_magic::b1Cnt(*data);
-    for (typename int_vector_type::size_type i=1; i < (v.capacity()>>6); ++i) {
-        result += bit_magic::b1Cnt(*(++data));
-    }
+    typename int_vector_type::size_type result = bit_magic::b1Cnt(data, v.capacity()>>6);
+    data += (v.capacity()>>6)-1;
     if (v.bit_size()&0x3F) {
         result -= bit_magic::b1Cnt((*data) & (~bit_magic::Li1Mask[v.bit_size()&0x3F]));
     }
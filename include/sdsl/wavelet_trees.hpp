@@ -26,12 +26,15 @@
  *    - []-operator
  *    - rank(i, c)
  *    - select(i, c)
- *    - rank_ith_symbol(i)
+ *    - rank_ith_symbol(i, c)
+ *   The free function inverse_select(wt, i) (wt_helper.hpp) returns the pair (rank_ith_symbol(i, c), c).
  */
 
 #include "wt.hpp"
 #include "wt_int.hpp"
+#include "wt_matrix.hpp"
 #include "wt_huff.hpp"
+#include "wt_multiary.hpp"
 #include "wt_rlmn.hpp"
 #include "wt_rlg.hpp"
 #include "wt_rlg8.hpp"
@@ -26,11 +26,15 @@
 #include "int_vector.hpp"
 #include "bitmagic.hpp"
 #include "util.hpp" // for util::ssign
+#include "wt_helper.hpp"
 #include <set> // for calculating the alphabet size
 #include <map> // for mapping a symbol to its lexicographical index
 #include <algorithm> // for std::swap
 #include <stdexcept>
 #include <vector>
+#include <queue> // for range_top_k
+#include <utility> // for pair
+#include <limits> // for numeric_limits
 
 #ifdef SDSL_DEBUG
 #define SDSL_DEBUG_WT
@@ -392,6 +396,99 @@ class wt
             }
         }
 
+        // the positions [lb..rb-1] of a node, which represents the sigma symbols starting with lex_idx
+        struct range_node {
+            size_type node, sigma, lex_idx, lb, rb;
+            bool operator<(const range_node& v)const {
+                return rb-lb < v.rb-v.lb;
+            }
+        };
+
+        // calculates the positions of the points of v in the left and right child of v
+        void expand(const range_node& v, range_node& left, range_node& right)const {
+            size_type ones_before_lb = m_tree_rank(m_node_pointers[v.node]+v.lb) - m_node_pointers_rank[v.node];
+            size_type ones_before_rb = m_tree_rank(m_node_pointers[v.node]+v.rb) - m_node_pointers_rank[v.node];
+            left.node = 2*v.node+1; left.sigma = (v.sigma+1)/2; left.lex_idx = v.lex_idx;
+            left.lb = v.lb - ones_before_lb; left.rb = v.rb - ones_before_rb;
+            right.node = 2*v.node+2; right.sigma = v.sigma - left.sigma; right.lex_idx = v.lex_idx + left.sigma;
+            right.lb = ones_before_lb; right.rb = ones_before_rb;
+        }
+
+        range_node root_node(size_type lb, size_type rb)const {
+            range_node v;
+            v.node = 0; v.sigma = m_sigma; v.lex_idx = 0; v.lb = lb; v.rb = rb+1;
+            return v;
+        }
+
+        // number of symbols smaller than c
+        size_type lex_lower_bound(value_type c)const {
+            size_type l = 0, r = m_sigma;
+            while (l < r) {
+                size_type mid = (l+r)/2;
+                if ((value_type)m_inv_char_map[mid] < c)
+                    l = mid+1;
+                else
+                    r = mid;
+            }
+            return l;
+        }
+
+        // number of symbols smaller than or equal to c
+        size_type lex_upper_bound(value_type c)const {
+            size_type l = 0, r = m_sigma;
+            while (l < r) {
+                size_type mid = (l+r)/2;
+                if (!(c < (value_type)m_inv_char_map[mid]))
+                    l = mid+1;
+                else
+                    r = mid;
+            }
+            return l;
+        }
+
+        // maps position i of the node to its position in the root
+        size_type position_in_root(size_type node, size_type i)const {
+            while (node != 0) {
+                if (node&1) {// node is a left child
+                    node = (node-1)/2;
+                    i = m_tree_select0(m_node_pointers[node]-m_node_pointers_rank[node]+i+1)-m_node_pointers[node];
+                } else { //node is a right child
+                    node = (node-1)/2;
+                    i = m_tree_select1(m_node_pointers_rank[node]+i+1)-m_node_pointers[node];
+                }
+            }
+            return i;
+        }
+
+        // number of points of v with lexicographic index in [lex_lb..lex_rb-1]
+        size_type _range_count_2d(const range_node& v, size_type lex_lb, size_type lex_rb)const {
+            if (v.lb == v.rb or lex_rb <= v.lex_idx or v.lex_idx+v.sigma <= lex_lb)
+                return 0;
+            if (lex_lb <= v.lex_idx and v.lex_idx+v.sigma <= lex_rb)
+                return v.rb - v.lb;
+            range_node left, right;
+            expand(v, left, right);
+            return _range_count_2d(left, lex_lb, lex_rb) + _range_count_2d(right, lex_lb, lex_rb);
+        }
+
+        template<class t_report>
+        void _range_report_2d(const range_node& v, size_type lex_lb, size_type lex_rb, t_report& report, size_type& remaining)const {
+            if (v.lb == v.rb or remaining == 0 or lex_rb <= v.lex_idx or v.lex_idx+v.sigma <= lex_lb)
+                return;
+            if (v.sigma < 2) {
+                size_type cnt = std::min(v.rb - v.lb, remaining);
+                value_type c = m_inv_char_map[v.lex_idx];
+                for (size_type j=v.lb; j < v.lb+cnt; ++j)
+                    report(position_in_root(v.node, j), c);
+                remaining -= cnt;
+                return;
+            }
+            range_node left, right;
+            expand(v, left, right);
+            _range_report_2d(left, lex_lb, lex_rb, report, remaining);
+            _range_report_2d(right, lex_lb, lex_rb, report, remaining);
+        }
+
     public:
 
         const size_type& sigma;
@@ -975,69 +1072,109 @@ class wt
                 }
             }
             // second phase go up and select the right position
-            size_type result = i-1;
-            while (node != 0) {
-                if (node&1) {// node is a left child
-                    node = (node-1)/2;
-                    result = m_tree_select0(m_node_pointers[node]-m_node_pointers_rank[node]+result+1)-m_node_pointers[node];
-                } else { //node is a right child
-                    node = (node-1)/2;
-                    result = m_tree_select1(m_node_pointers_rank[node]+result+1)-m_node_pointers[node];
-                }
-            }
-            return result;
+            return position_in_root(node, i-1);
         };
 
-        //!
-        void range_search_2d(size_type lb, size_type rb, value_type c1, value_type c2, std::vector<size_type>& result) const {
-            size_type lex_idx_1 = m_char_map[c1];
-            size_type lex_idx_2 = m_char_map[c2];
-            _range_search_2d(0, lb, rb, lex_idx_1, lex_idx_2, m_sigma, result);
+        //! range_search_2d searches the positions in [lb..rb] of the symbols in [c1..c2].
+        /*! \param lb Left bound of index interval (inclusive)
+         *  \param rb Right bound of index interval (inclusive)
+         *  \param c1 Smallest symbol of the symbol interval (inclusive)
+         *  \param c2 Largest symbol of the symbol interval (inclusive)
+         *  \param result Reference to a vector to which the resulting positions are added.
+         *  \param max_results Maximal number of positions which are added; see range_report_2d.
+         *  \returns The number of added positions.
+         */
+        size_type range_search_2d(size_type lb, size_type rb, value_type c1, value_type c2, std::vector<size_type>& result,
+                                  size_type max_results=std::numeric_limits<size_type>::max()) const {
+            range_report_to_vectors<size_type, value_type> report(&result, NULL);
+            return range_report_2d(lb, rb, c1, c2, report, max_results);
         }
 
-        // add parameter path
-        void _range_search_2d(size_type node, size_type lb, size_type rb, size_type lex_idx_1, size_type lex_idx_2, size_type sigma, std::vector<size_type>& result)const {
-//		std::cerr<<"lb="<<lb<<" rb="<<rb<<" lex_idx_1="<<lex_idx_1<<" lex_idx_2="<<lex_idx_2<<" sigma="<<sigma<<" node="<<node<<std::endl;
-            // [lex_idx_1..lex_idx_2] in [0..sigma]
-            if (lb > rb)
-                return;
-            if (sigma <= 1) {
-                // result[i]...
-                size_type r = 0;
-                while (node != 0) {
-                    if (node&1) {// node is a left child
-                        node = (node-1)/2;
-                        size_type node_idx = m_node_pointers[node];
-                        r = m_tree_select0(node_idx-m_tree_rank(node_idx)+r+1)-node_idx;
-                    } else { //node is a right child
-                        node = (node-1)/2;
-                        r = m_tree_select1(m_tree_rank(m_node_pointers[node])+r+1)-m_node_pointers[node];
-                    }
-                }
-                result.push_back(r);
-                return;
-            }
-            size_type lex_mid = (sigma+1)/2;
-            size_type lsigma = lex_mid;
-            size_type rsigma = sigma - lex_mid;
-
-            size_type ones_lb_1 = m_tree_rank(m_node_pointers[node]+lb) -  m_node_pointers_rank[node];  // ones in [0,lb)
-            size_type ones_rb 	= m_tree_rank(m_node_pointers[node]+rb+1) -	m_node_pointers_rank[node]; // ones in [0,rb]
-            size_type zeros_lb_1 = lb-ones_lb_1; // zeros in [0,lb)
-            size_type zeros_rb	= rb+1-ones_rb; // zeros in [0,rb]
+        //! Counts the positions in [lb..rb] of the symbols in [c1..c2].
+        /*! \param lb Left bound of index interval (inclusive)
+         *  \param rb Right bound of index interval (inclusive)
+         *  \param c1 Smallest symbol of the symbol interval (inclusive)
+         *  \param c2 Largest symbol of the symbol interval (inclusive)
+         *  \par Time complexity
+         *		\f$ \Order{\log |\Sigma|} \f$, since the search stops at nodes whose symbols all lie in [c1..c2].
+         */
+        size_type range_count_2d(size_type lb, size_type rb, value_type c1, value_type c2)const {
+            size_type lex_lb = lex_lower_bound(c1), lex_rb = lex_upper_bound(c2);
+            if (lb > rb or lex_lb >= lex_rb)
+                return 0;
+            return _range_count_2d(root_node(lb, rb), lex_lb, lex_rb);
+        }
 
-//		std::cerr<<"ones_lb_1="<<ones_lb_1<<" ones_rb="<<ones_rb<<std::endl;
-//		std::cerr<<"zeros_lb_1="<<zeros_lb_1<<" zeros_rb="<<zeros_rb<<std::endl;
+        //! Reports the positions in [lb..rb] of the symbols in [c1..c2] to a callback.
+        /*! \param lb Left bound of index interval (inclusive)
+         *  \param rb Right bound of index interval (inclusive)
+         *  \param c1 Smallest symbol of the symbol interval (inclusive)
+         *  \param c2 Largest symbol of the symbol interval (inclusive)
+         *  \param report A functor which is called as report(idx, symbol) for each position; see wt_helper.hpp.
+         *  \param max_results The search stops after max_results positions.
+         *  \returns The number of reported positions.
+         *  \par Details
+         *       The positions are reported in increasing order of their symbols and
+         *       positions of equal symbols in increasing order.
+         */
+        template<class t_report>
+        size_type range_report_2d(size_type lb, size_type rb, value_type c1, value_type c2, t_report& report,
+                                  size_type max_results=std::numeric_limits<size_type>::max())const {
+            size_type lex_lb = lex_lower_bound(c1), lex_rb = lex_upper_bound(c2);
+            if (lb > rb or lex_lb >= lex_rb)
+                return 0;
+            size_type remaining = max_results;
+            _range_report_2d(root_node(lb, rb), lex_lb, lex_rb, report, remaining);
+            return max_results - remaining;
+        }
 
-            if (lex_idx_1 < lex_mid and zeros_rb) {
-                _range_search_2d(2*node+1, zeros_lb_1, zeros_rb-1, lex_idx_1, std::min(lex_idx_2,lex_mid-1), lsigma, result);
+        //! Calculates the q-th smallest symbol in wt[lb..rb].
+        /*! \param lb Left bound of the index interval (inclusive)
+         *  \param rb Right bound of the index interval (inclusive)
+         *  \param q  Rank of the symbol in the sorted interval, \f$q\in[0..rb-lb]\f$.
+         *  \returns The symbol and its number of occurrences in wt[lb..rb].
+         *  \par Time complexity
+         *		\f$ \Order{\log |\Sigma|} \f$
+         */
+        std::pair<value_type, size_type> range_quantile(size_type lb, size_type rb, size_type q)const {
+            range_node v = root_node(lb, rb), left, right;
+            while (v.sigma >= 2) {
+                expand(v, left, right);
+                if (q < left.rb - left.lb) {
+                    v = left;
+                } else {
+                    q -= left.rb - left.lb;
+                    v = right;
+                }
             }
+            return std::make_pair((value_type)m_inv_char_map[v.lex_idx], v.rb - v.lb);
+        }
 
-            if (lex_idx_2 >= lex_mid  and  ones_rb) {
-                size_type _lex_idx_1 = 0;
-                if (lex_idx_1 > lex_mid)
-                    _lex_idx_1 = lex_idx_1 - lex_mid;
-                _range_search_2d(2*node+2, ones_lb_1, ones_rb-1, _lex_idx_1, lex_idx_2-lex_mid, rsigma, result);
+        //! Calculates the k most frequent symbols in wt[lb..rb].
+        /*! \param lb Left bound of the index interval (inclusive)
+         *  \param rb Right bound of the index interval (inclusive)
+         *  \param k  Number of symbols to report.
+         *  \param result Reference to a vector which contains the pairs (symbol, frequency) in decreasing order of
+         *                frequency afterwards; there are fewer than k pairs if wt[lb..rb] contains fewer distinct symbols.
+         */
+        void range_top_k(size_type lb, size_type rb, size_type k, std::vector<std::pair<value_type, size_type> >& result)const {
+            result.clear();
+            if (lb > rb or k == 0)
+                return;
+            std::priority_queue<range_node> pq;
+            pq.push(root_node(lb, rb));
+            range_node left, right;
+            while (!pq.empty() and result.size() < k) {
+                range_node v = pq.top(); pq.pop();
+                if (v.sigma < 2) {
+                    result.push_back(std::make_pair((value_type)m_inv_char_map[v.lex_idx], v.rb - v.lb));
+                    continue;
+                }
+                expand(v, left, right);
+                if (left.lb < left.rb)
+                    pq.push(left);
+                if (right.lb < right.rb)
+                    pq.push(right);
             }
         }
 
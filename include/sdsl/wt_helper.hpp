@@ -2,6 +2,8 @@
 #define INCLUDED_SDSL_WT_HELPER
 
 #include "int_vector.hpp"
+#include <vector>
+#include <utility> // for pair
 
 namespace sdsl
 {
@@ -40,5 +42,64 @@ void calculate_effective_alphabet_size(const size_type* C, size_type& sigma)
             ++sigma;				 // exists in the text
 }
 
+//! Construct the wavelet tree wt from the first size elements of buf
+/*! Wavelet trees which support a multi-threaded construction overload
+ *  this function and use threads threads; all others ignore threads.
+ */
+template<class WaveletTree, class Buffer, class size_type>
+void construct_wavelet_tree(WaveletTree& wt, Buffer& buf, size_type size, uint32_t threads)
+{
+    wt.construct(buf, size);
+}
+
+//! Calculates the symbol wt[i] and the number of its occurrences in the prefix [0..i-1].
+/*! \param wt The wavelet tree.
+ *  \param i  The index of the symbol, \f$i\in [0..wt.size()-1]\f$.
+ *  \return The pair (wt.rank_ith_symbol(i, c), c), where c=wt[i].
+ *  Wavelet trees which determine both in one traversal (wt_int and wt_matrix)
+ *  overload this function and forward to their member inverse_select.
+ */
+template<class WaveletTree>
+std::pair<typename WaveletTree::size_type, typename WaveletTree::value_type>
+inverse_select(const WaveletTree& wt, typename WaveletTree::size_type i)
+{
+    typename WaveletTree::value_type c;
+    typename WaveletTree::size_type r = wt.rank_ith_symbol(i, c);
+    return std::make_pair(r, c);
+}
+
+//! A reporter for range_report_2d which appends the indices and values of the points to vectors.
+/*! A reporter is a functor which is called with the index and the value of each reported point.
+ *  Either of the two vectors may be NULL.
+ */
+template<class size_type, class value_type>
+struct range_report_to_vectors {
+    std::vector<size_type>*  idx;
+    std::vector<value_type>* val;
+
+    range_report_to_vectors(std::vector<size_type>* idx_result, std::vector<value_type>* val_result):idx(idx_result), val(val_result) {}
+
+    void operator()(size_type i, value_type v) {
+        if (idx != NULL)
+            idx->push_back(i);
+        if (val != NULL)
+            val->push_back(v);
+    }
+};
+
+//! A reporter for range_report_2d which appends only the values of the points to a vector.
+/*! The wavelet trees recognize this reporter and do not calculate the indices of the points.
+ */
+template<class size_type, class value_type>
+struct range_report_values {
+    std::vector<value_type>* val;
+
+    range_report_values(std::vector<value_type>* val_result):val(val_result) {}
+
+    void operator()(size_type, value_type v) {
+        val->push_back(v);
+    }
+};
+
 } // end namespace sdsl
 #endif
@@ -30,6 +30,7 @@
 #include "util.hpp"
 #include "wt_helper.hpp"
 #include "wt.hpp"
+#include "parallel.hpp"
 #include <algorithm> // for std::swap
 #include <stdexcept>
 #include <vector>
@@ -179,19 +180,129 @@ class wt_huff
 //			m_check = wt.m_check;
         }
 
-        // insert a character into the wavelet tree, see constuct method
-        void insert_char(uint8_t old_chr, size_type* tree_pos, size_type times, bit_vector& f_tree) {
+        // insert a character into the wavelet tree, see constuct method;
+        // if shared is not NULL, the bits in the words shared[2*node] and shared[2*node+1]
+        // of each node are set atomically, as other threads write to these words too
+        void insert_char(uint8_t old_chr, size_type* tree_pos, size_type times, bit_vector& f_tree, const size_type* shared=NULL)const {
             uint32_t path_len = (m_path[old_chr]>>56);
             uint64_t p = m_path[old_chr];
             for (uint32_t node=0, l=0; l<path_len; ++l, p >>= 1) {
                 if (p&1) {
-                    f_tree.set_int(tree_pos[node], 0xFFFFFFFFFFFFFFFFULL,times);
+                    if (shared != NULL and ((tree_pos[node]>>6) <= shared[2*node] or ((tree_pos[node]+times-1)>>6) >= shared[2*node+1]))
+                        util::set_one_bits_atomic(f_tree, tree_pos[node], times);
+                    else
+                        f_tree.set_int(tree_pos[node], 0xFFFFFFFFFFFFFFFFULL,times);
                 }
                 tree_pos[node] += times;
                 node = m_nodes[node].child[p&1];
             }
         }
 
+        // insert the characters rac[b..e-1] into the wavelet tree
+        template<class Container>
+        void insert_chars(const Container& rac, size_type b, size_type e, size_type* tree_pos, bit_vector& f_tree, const size_type* shared=NULL)const {
+            if (b >= e)
+                return;
+            uint8_t old_chr = rac[b], times = 0;
+            for (size_type i=b; i < e; ++i) {
+                uint8_t chr = rac[i];
+                if (chr	!= old_chr) {
+                    insert_char(old_chr, tree_pos, times, f_tree, shared);
+                    times = 1;
+                    old_chr = chr;
+                } else { // chr == old_chr
+                    ++times;
+                    if (times == 64) {
+                        insert_char(old_chr, tree_pos, times, f_tree, shared);
+                        times = 0;
+                    }
+                }
+            }
+            if (times > 0) {
+                insert_char(old_chr, tree_pos, times, f_tree, shared);
+            }
+        }
+
+        // task of insert_chars_parallel: counts the characters of its part or inserts them
+        template<class Container>
+        struct insert_task {
+            const wt_huff* wt;
+            const Container* rac;
+            bit_vector* f_tree;
+            size_type b, e;
+            bool count;
+            size_type C[256];
+            size_type tree_pos[511];
+            size_type shared[2*511];
+
+            void operator()() {
+                if (count) {
+                    for (size_type i=b; i < e; ++i)
+                        ++C[(*rac)[i]];
+                } else {
+                    wt->insert_chars(*rac, b, e, tree_pos, *f_tree, shared);
+                }
+            }
+        };
+
+        // insert the characters rac[b..e-1] into the wavelet tree with several threads:
+        // each thread first counts the characters of its part, which determines where
+        // the part starts in each node, and then inserts its part; only the first and
+        // last word of a part in a node are shared with other threads
+        template<class Container>
+        void insert_chars_parallel(const Container& rac, size_type b, size_type e, size_type* tree_pos, bit_vector& f_tree, uint32_t threads)const {
+            const size_type min_part = 1<<16;
+            if (threads > (e-b)/min_part)
+                threads = (e-b)/min_part;
+            if (threads <= 1) {
+                insert_chars(rac, b, e, tree_pos, f_tree);
+                return;
+            }
+            std::vector<insert_task<Container> > tasks(threads);
+            for (uint32_t t=0; t < threads; ++t) {
+                tasks[t].wt = this; tasks[t].rac = &rac; tasks[t].f_tree = &f_tree;
+                tasks[t].b = b + parallel::part_begin(e-b, threads, t);
+                tasks[t].e = b + parallel::part_begin(e-b, threads, t+1);
+                tasks[t].count = true;
+                std::fill(tasks[t].C, tasks[t].C+256, 0);
+            }
+            parallel::run(tasks);
+            for (uint32_t t=0; t < threads; ++t) {
+                size_type node_cnt[511] = {0};
+                for (size_type c=0; c < 256; ++c) {
+                    if (tasks[t].C[c] == 0)
+                        continue;
+                    uint32_t path_len = (m_path[c]>>56);
+                    uint64_t p = m_path[c];
+                    for (uint32_t node=0, l=0; l<path_len; ++l, p >>= 1) {
+                        node_cnt[node] += tasks[t].C[c];
+                        node = m_nodes[node].child[p&1];
+                    }
+                }
+                for (size_type node=0; node < 2*m_sigma-1; ++node) {
+                    tasks[t].tree_pos[node] = tree_pos[node];
+                    tasks[t].shared[2*node]   = tree_pos[node]>>6;
+                    tasks[t].shared[2*node+1] = (tree_pos[node]+node_cnt[node]-1)>>6;
+                    tree_pos[node] += node_cnt[node];
+                }
+                tasks[t].count = false;
+            }
+            parallel::run(tasks);
+        }
+
+        void construct_init_rank_select(uint32_t threads=1) {
+            if (threads > 1) {
+                parallel::init_support_task<RankSupport, bit_vector_type> rank_task(m_tree_rank, &m_tree);
+                parallel::init_support_task<SelectSupportZero, bit_vector_type> select0_task(m_tree_select0, &m_tree);
+                parallel::init_support_task<SelectSupport, bit_vector_type> select1_task(m_tree_select1, &m_tree);
+                parallel::run(rank_task, select0_task, select1_task);
+                return;
+            }
+            util::init_support(m_tree_rank, &m_tree);
+            util::init_support(m_tree_select0, &m_tree);
+            util::init_support(m_tree_select1, &m_tree);
+        }
+
         // calculates the Huffman tree and returns the size of the WT bit vector
         size_type construct_huffman_tree(size_type* C) {
             tMPQPII pq; // priority queue
@@ -288,12 +399,6 @@ class wt_huff
             return tree_size;
         }
 
-        void construct_init_rank_select() {
-            util::init_support(m_tree_rank, &m_tree);
-            util::init_support(m_tree_select0, &m_tree);
-            util::init_support(m_tree_select1, &m_tree);
-        }
-
         void construct_precalc_node_ranks() {
             for (size_type i=0; i<2*m_sigma-1; ++i) {
                 if (m_nodes[i].child[0] != _undef_node)  // if node is not a leaf
@@ -337,6 +442,14 @@ class wt_huff
             }
         }
 
+        // the positions [lb..rb-1] of a node of the Huffman tree
+        struct range_node {
+            size_type lb, rb;
+            uint16_t node;
+            bool operator<(const range_node& v)const {
+                return rb-lb < v.rb-v.lb;
+            }
+        };
 
     public:
 
@@ -352,12 +465,13 @@ class wt_huff
         /*!
          *	\param rac Reference to the vector (or unsigned char array) for which the wavelet tree should be build.
          *	\param size Size of the prefix of the vector (or unsigned char array) for which the wavelet tree should be build.
+         *	\param threads Number of threads used for the construction.
          *	\par Time complexity
          *		\f$ \Order{n\log|\Sigma|}\f$, where \f$n=size\f$
          */
         template<typename RandomAccessContainer>
-        wt_huff(const RandomAccessContainer& rac, size_type size):m_size(size), m_sigma(0), sigma(m_sigma), tree(m_tree) {
-            construct(rac, size);
+        wt_huff(const RandomAccessContainer& rac, size_type size, uint32_t threads=1):m_size(size), m_sigma(0), sigma(m_sigma), tree(m_tree) {
+            construct(rac, size, threads);
         }
 
         template<uint8_t w>
@@ -366,8 +480,15 @@ class wt_huff
         }
 
 
+        //! Construct the wavelet tree from a random access container
+        /*! \param rac     Reference to the vector (or unsigned char array) for which the wavelet tree should be build.
+         *	\param size    Size of the prefix of the vector (or unsigned char array) for which the wavelet tree should be build.
+         *	\param threads Number of threads used for the construction. The threads insert disjoint parts of
+         *	               rac into the tree and initialize the rank and select structures concurrently. The result
+         *	               does not depend on the number of threads.
+         */
         template<typename RandomAccessContainer>
-        void construct(const RandomAccessContainer& rac, size_type size) {
+        void construct(const RandomAccessContainer& rac, size_type size, uint32_t threads=1) {
             m_size = size;
             if (m_size == 0)
                 return;
@@ -389,42 +510,27 @@ class wt_huff
             for (size_type i=0; i < 2*sigma-1; ++i) {
                 tree_pos[i] = m_nodes[i].tree_pos;
             }
-            uint8_t old_chr = rac[0], times = 0;
-            for (size_type i=0; i < m_size; ++i) {
-                uint8_t chr = rac[i];
-                if (chr	!= old_chr) {
-                    insert_char(old_chr, tree_pos, times, tmp_tree);
-                    times = 1;
-                    old_chr = chr;
-                } else { // chr == old_chr
-                    ++times;
-                    if (times == 64) {
-                        insert_char(old_chr, tree_pos, times, tmp_tree);
-                        times = 0;
-                    }
-                }
-            }
-            if (times > 0) {
-                insert_char(old_chr, tree_pos, times, tmp_tree);
-            }
+            insert_chars_parallel(rac, 0, m_size, tree_pos, tmp_tree, threads);
             util::assign(m_tree, tmp_tree);
             // 5. Initialize rank and select data structures for m_tree
-            construct_init_rank_select();
+            construct_init_rank_select(threads);
             // 6. Finish inner nodes by precalculating the tree_pos_rank values
             construct_precalc_node_ranks();
         }
 
         template<class size_type_class>
-        wt_huff(int_vector_file_buffer<8, size_type_class>& rac, size_type size):m_size(size), m_sigma(0), sigma(m_sigma), tree(m_tree) {
-            construct(rac, size);
+        wt_huff(int_vector_file_buffer<8, size_type_class>& rac, size_type size, uint32_t threads=1):m_size(size), m_sigma(0), sigma(m_sigma), tree(m_tree) {
+            construct(rac, size, threads);
         }
 
         //! Construct the wavelet tree from a random access container
         /*! \param rac A random access container
          *	\param size The length of the prefix of the random access container, for which the wavelet tree should be build
+         *	\param threads Number of threads used for the construction. For more than one thread, the buffer of rac is
+         *	               enlarged to threads MB, which are inserted in parallel.
          */
         template<class size_type_class>
-        void construct(int_vector_file_buffer<8, size_type_class>& rac, size_type size) {
+        void construct(int_vector_file_buffer<8, size_type_class>& rac, size_type size, uint32_t threads=1) {
 //		m_check.construct(rac, size);
             m_size = size;
             if (m_size == 0)
@@ -445,38 +551,25 @@ class wt_huff
             for (size_type i=0; i < 2*sigma-1; ++i) {
                 tree_pos[i] = m_nodes[i].tree_pos;
             }
-            rac.reset();
+            // enlarge the buffer for the parallel insertion and restore the callers buffer size afterwards
+            size_type old_buffersize = rac.buffersize();
+            rac.reset(threads > 1 ? ((size_type)threads)<<20 : 0);
             if (rac.int_vector_size < size) {
+                rac.reset(old_buffersize);
                 throw std::logic_error("wt_huff::construct: stream size is smaller than size!");
                 return;
             }
-            for (size_type i=0, r_sum=0, r = rac.load_next_block(); r_sum < m_size;) {
+            for (size_type r_sum=0, r = rac.load_next_block(); r_sum < m_size;) {
                 if (r_sum + r > size) {  // read not more than size chars in the next loop
                     r = size-r_sum;
                 }
-                uint8_t old_chr = rac[i-r_sum], times = 0;
-                for (; i < r_sum+r; ++i) {
-                    uint8_t chr = rac[i-r_sum];
-                    if (chr	!= old_chr) {
-                        insert_char(old_chr, tree_pos, times, tmp_tree);
-                        times = 1;
-                        old_chr = chr;
-                    } else { // chr == old_chr
-                        ++times;
-                        if (times == 64) {
-                            insert_char(old_chr, tree_pos, times, tmp_tree);
-                            times = 0;
-                        }
-                    }
-                }
-                if (times > 0) {
-                    insert_char(old_chr, tree_pos, times, tmp_tree);
-                }
+                insert_chars_parallel(rac, 0, r, tree_pos, tmp_tree, threads);
                 r_sum += r; r = rac.load_next_block();
             }
+            rac.reset(old_buffersize);
             util::assign(m_tree, tmp_tree);
             // 5. Initialize rank and select data structures for m_tree
-            construct_init_rank_select();
+            construct_init_rank_select(threads);
             // 6. Finish inner nodes by precalculating the tree_pos_rank values
             construct_precalc_node_ranks();
         }
@@ -606,6 +699,52 @@ class wt_huff
             return i;
         }
 
+        //! Answers n rank_ith_symbol queries.
+        /*!
+         *  \param idx  Array of the n query positions.
+         *  \param n    Number of queries.
+         *  \param rank Array of size n; rank[k] is set to rank_ith_symbol(idx[k], c[k]).
+         *  \param c    Array of size n; c[k] is set to the symbol at position idx[k].
+         *  The queries traverse the tree level by level and the rank queries of a level are
+         *  answered by the batched rank method of the rank support, which prefetches the memory of
+         *  later queries.
+         */
+        void rank_ith_symbol(const size_type* idx, size_type n, size_type* rank, value_type* c)const {
+            std::vector<uint32_t>  node(n, 0);
+            std::vector<size_type> active(n), tree_pos(n), tree_rank(n);
+            for (size_type k=0; k < n; ++k) {
+                assert(idx[k] < size());
+                rank[k] = idx[k];
+                active[k] = k;
+            }
+            size_type m = n; // number of queries which have not reached a leaf
+            while (m > 0) {
+                size_type mm = 0;
+                for (size_type j=0; j < m; ++j) {
+                    size_type k = active[j];
+                    if (m_nodes[node[k]].child[0] == _undef_node) { // the query reached a leaf
+                        c[k] = m_nodes[node[k]].tree_pos_rank;
+                    } else {
+                        active[mm] = k;
+                        tree_pos[mm++] = m_nodes[node[k]].tree_pos + rank[k];
+                    }
+                }
+                m = mm;
+                m_tree_rank.rank(&tree_pos[0], m, &tree_rank[0]);
+                for (size_type j=0; j < m; ++j) {
+                    size_type k = active[j];
+                    const _node<size_type>& v = m_nodes[node[k]];
+                    if (m_tree[tree_pos[j]]) { // goto right child
+                        rank[k] = tree_rank[j] - v.tree_pos_rank;
+                        node[k] = v.child[1];
+                    } else { // goto left child
+                        rank[k] -= tree_rank[j] - v.tree_pos_rank;
+                        node[k] = v.child[0];
+                    }
+                }
+            }
+        }
+
         //! Calculates the ith occurrence of the symbol c in the supported vector.
         /*!
          *  \param i The ith occurrence. \f$i\in [1..rank(size(),c)]\f$.
@@ -704,6 +843,43 @@ class wt_huff
             }
         }
 
+        //! Calculates the k most frequent symbols in wt[lb..rb].
+        /*! \param lb Left bound of the index interval (inclusive)
+         *  \param rb Right bound of the index interval (inclusive)
+         *  \param k  Number of symbols to report.
+         *  \param result Reference to a vector which contains the pairs (symbol, frequency) in decreasing order of
+         *                frequency afterwards; there are fewer than k pairs if wt[lb..rb] contains fewer distinct symbols.
+         *  \par Note
+         *       The Huffman shape does not preserve the order of the symbols, so wt_huff does not provide the
+         *       order based range queries range_quantile and range_next_value of wt and wt_int.
+         */
+        void range_top_k(size_type lb, size_type rb, size_type k, std::vector<std::pair<value_type, size_type> >& result)const {
+            result.clear();
+            if (lb > rb or k == 0 or m_size == 0)
+                return;
+            std::priority_queue<range_node> pq;
+            range_node v;
+            v.lb = lb; v.rb = rb+1; v.node = 0;
+            pq.push(v);
+            while (!pq.empty() and result.size() < k) {
+                v = pq.top(); pq.pop();
+                const _node<size_type>& nd = m_nodes[v.node];
+                if (nd.child[0] == _undef_node) { // leaf
+                    result.push_back(std::make_pair((value_type)nd.tree_pos_rank, v.rb - v.lb));
+                    continue;
+                }
+                size_type ones_before_lb = m_tree_rank(nd.tree_pos + v.lb) - nd.tree_pos_rank;
+                size_type ones_before_rb = m_tree_rank(nd.tree_pos + v.rb) - nd.tree_pos_rank;
+                range_node child;
+                child.lb = v.lb - ones_before_lb; child.rb = v.rb - ones_before_rb; child.node = nd.child[0];
+                if (child.lb < child.rb)
+                    pq.push(child);
+                child.lb = ones_before_lb; child.rb = ones_before_rb; child.node = nd.child[1];
+                if (child.lb < child.rb)
+                    pq.push(child);
+            }
+        }
+
 
 
         //! Serializes the data structure into the given ostream
@@ -744,6 +920,13 @@ class wt_huff
 
 };
 
+//! Construct a wt_huff with threads threads (see construct_wavelet_tree in wt_helper.hpp)
+template<class BitVector, class RankSupport, class SelectSupport, class SelectSupportZero, bool dfs_shape, class Buffer, class size_type>
+void construct_wavelet_tree(wt_huff<BitVector, RankSupport, SelectSupport, SelectSupportZero, dfs_shape>& wt, Buffer& buf, size_type size, uint32_t threads)
+{
+    wt.construct(buf, size, threads);
+}
+
 typedef wt_huff<rrr_vector<>,
         rrr_vector<>::rank_1_type,
         rrr_vector<>::select_1_type,
@@ -30,11 +30,16 @@
 #include "testutils.hpp"
 #include "temp_write_read_buffer.hpp"
 #include "util.hpp"
+#include "parallel.hpp"
+#include "wt_helper.hpp"
 #include <set> // for calculating the alphabet size
 #include <map> // for mapping a symbol to its lexicographical index
 #include <algorithm> // for std::swap
 #include <stdexcept>
 #include <vector>
+#include <queue> // for range_top_k
+#include <utility> // for pair
+#include <limits> // for numeric_limits
 
 //! Namespace for the succinct data structure library.
 namespace sdsl
@@ -95,6 +100,254 @@ class wt_int
             m_logn			= wt.m_logn;
         }
 
+        // task of construct_levels_parallel, which processes the part [b..e-1] of a level
+        template<uint8_t w>
+        struct level_task {
+            const int_vector<w>* act;  // permutation of the current level
+            int_vector<w>*       next; // permutation of the next level
+            bit_vector*          tree;
+            size_type            tree_off, b, e;
+            uint64_t             mask_old, mask_new;
+            bool                 write_next;
+            bool                 first_pass;
+            // results of the first pass
+            size_type            zeros;       // number of 0-bits in the part
+            size_type            starts;      // number of nodes which start in the part
+            size_type            first_start; // first node start in the part and the number of 0-bits before it
+            size_type            z_first;
+            size_type            last_start;  // last node start in the part and the number of 0-bits before it
+            size_type            z_last;
+            // input of the second pass: number of 0-bits before b, start of the node which contains b, and
+            // end of the node which contains e-1 with the corresponding number of 0-bits in the level
+            size_type            z_base, in_s, z_in_s, out_e, z_out_e;
+
+            bool node_start(size_type i)const {
+                return i == 0 or (((*act)[i]^(*act)[i-1])&mask_old) != 0;
+            }
+
+            void operator()() {
+                if (first_pass) {
+                    zeros = starts = z_first = z_last = 0;
+                    first_start = last_start = e;
+                    for (size_type i=b; i < e; ++i) {
+                        if (node_start(i)) {
+                            if (starts++ == 0) {
+                                first_start = i; z_first = zeros;
+                            }
+                            last_start = i; z_last = zeros;
+                        }
+                        if ((*act)[i]&mask_new)
+                            (*tree)[tree_off+i] = 1;
+                        else
+                            ++zeros;
+                    }
+                    return;
+                }
+                if (!write_next)
+                    return;
+                // 0-bits keep their order at the start of the node
+                size_type s = in_s, z_s = z_in_s, z = z_base;
+                for (size_type i=b; i < e; ++i) {
+                    if (node_start(i)) {
+                        s = i; z_s = z;
+                    }
+                    if (((*act)[i]&mask_new) == 0)
+                        (*next)[s + (z++) - z_s] = (*act)[i];
+                }
+                // 1-bits keep their order at the end of the node
+                size_type z_e = z_out_e;
+                z = z_base + zeros;
+                for (size_type i=e; i > b; --i) {
+                    if ((*act)[i-1]&mask_new)
+                        (*next)[z_e + (i-1) - z] = (*act)[i-1];
+                    else
+                        --z;
+                    if (node_start(i-1))
+                        z_e = z;
+                }
+            }
+        };
+
+        // builds the levels of tree with several threads; perms[0] contains the input.
+        // Each level is split into parts, which start at word boundaries of tree.
+        // A first pass sets the bits of the level and counts the 0-bits of each part;
+        // the prefix sums of the counts determine the positions of the elements in
+        // the next level, which are moved in a second pass.
+        template<uint8_t w>
+        void construct_levels_parallel(int_vector<w>* perms, bit_vector& tree, uint32_t threads) {
+            const size_type n = m_size;
+            std::vector<level_task<w> > tasks(threads);
+            uint64_t mask_old = 1ULL<<(m_logn);
+            for (uint32_t k=0; k<m_logn; ++k) {
+                const uint64_t mask_new = 1ULL<<(m_logn-k-1);
+                const size_type tree_off = k*n;
+                for (uint32_t t=0; t < threads; ++t) {
+                    level_task<w>& task = tasks[t];
+                    task.act = &perms[k%2]; task.next = &perms[1-(k%2)]; task.tree = &tree;
+                    task.tree_off = tree_off;
+                    task.mask_old = mask_old; task.mask_new = mask_new;
+                    task.write_next = (k+1 < m_logn);
+                    task.first_pass = true;
+                    task.b = (t == 0) ? 0 : std::min(n, ((tree_off+parallel::part_begin(n, threads, t)+63)&~(size_type)63) - tree_off);
+                    task.e = (t+1 == threads) ? n : std::min(n, ((tree_off+parallel::part_begin(n, threads, t+1)+63)&~(size_type)63) - tree_off);
+                }
+                parallel::run(tasks);
+                size_type z = 0, s = 0, z_s = 0;
+                for (uint32_t t=0; t < threads; ++t) {
+                    level_task<w>& task = tasks[t];
+                    task.z_base = z; task.in_s = s; task.z_in_s = z_s;
+                    if (task.starts > 0) {
+                        s = task.last_start; z_s = z + task.z_last;
+                    }
+                    z += task.zeros;
+                    task.first_pass = false;
+                    if (!task.write_next)
+                        m_sigma += task.starts; // one leaf for each node of the last level
+                }
+                size_type e = n, z_e = z;
+                for (uint32_t t=threads; t > 0; --t) {
+                    level_task<w>& task = tasks[t-1];
+                    task.out_e = e; task.z_out_e = z_e;
+                    if (task.starts > 0) {
+                        e = task.first_start; z_e = task.z_base + task.z_first;
+                    }
+                }
+                if (k+1 < m_logn)
+                    parallel::run(tasks);
+                mask_old += mask_new;
+            }
+        }
+
+        // builds tree with several threads from the first n elements of rac
+        template<uint8_t w, class Container>
+        void construct_parallel_width(const Container& rac, bit_vector& tree, uint32_t threads) {
+            int_vector<w> perms[2];
+            perms[0].resize(m_size); perms[1].resize(m_size);
+            for (size_type i=0; i < m_size; ++i) { // copy original array to perms[0]
+                perms[0][i] = rac[i];
+            }
+            construct_levels_parallel(perms, tree, threads);
+        }
+
+        // builds tree with several threads, if threads > 1 and the input is large enough; returns false otherwise
+        template<class Container>
+        bool construct_parallel(const Container& rac, bit_vector& tree, uint32_t threads) {
+            threads = std::min((size_type)threads, m_size>>16);
+            if (threads <= 1)
+                return false;
+            if (m_logn <= 8)
+                construct_parallel_width<8>(rac, tree, threads);
+            else if (m_logn <= 16)
+                construct_parallel_width<16>(rac, tree, threads);
+            else if (m_logn <= 32)
+                construct_parallel_width<32>(rac, tree, threads);
+            else
+                construct_parallel_width<64>(rac, tree, threads);
+            return true;
+        }
+
+        void construct_init_rank_select(uint32_t threads) {
+            if (threads > 1) {
+                parallel::init_support_task<rank_1_type, bit_vector_type> rank_task(m_tree_rank, &m_tree);
+                parallel::init_support_task<select_0_type, bit_vector_type> select0_task(m_tree_select0, &m_tree);
+                parallel::init_support_task<select_1_type, bit_vector_type> select1_task(m_tree_select1, &m_tree);
+                parallel::run(rank_task, select0_task, select1_task);
+                return;
+            }
+            util::init_support(m_tree_rank, &m_tree);
+            util::init_support(m_tree_select0, &m_tree);
+            util::init_support(m_tree_select1, &m_tree);
+        }
+
+        // the positions [lb..rb-1] of a node, which starts at offset in m_tree and contains the values with prefix path
+        struct range_node {
+            size_type offset, node_size, lb, rb;
+            value_type path;
+            uint32_t depth;
+            bool operator<(const range_node& v)const {
+                return rb-lb < v.rb-v.lb;
+            }
+        };
+
+        // calculates the positions of the points of v in the left and right child of v
+        void expand(const range_node& v, range_node& left, range_node& right)const {
+            size_type ones_before_o   = m_tree_rank(v.offset);
+            size_type ones_before_lb  = m_tree_rank(v.offset + v.lb) - ones_before_o;
+            size_type ones_before_rb  = m_tree_rank(v.offset + v.rb) - ones_before_o;
+            size_type ones_before_end = m_tree_rank(v.offset + v.node_size) - ones_before_o;
+            left.offset  = v.offset + m_size;
+            left.node_size = v.node_size - ones_before_end;
+            left.lb = v.lb - ones_before_lb; left.rb = v.rb - ones_before_rb;
+            left.path = v.path<<1; left.depth = v.depth+1;
+            right.offset = left.offset + left.node_size;
+            right.node_size = ones_before_end;
+            right.lb = ones_before_lb; right.rb = ones_before_rb;
+            right.path = (v.path<<1)|1; right.depth = v.depth+1;
+        }
+
+        range_node root_node(size_type lb, size_type rb)const {
+            range_node v;
+            v.offset = 0; v.node_size = m_size; v.lb = lb; v.rb = rb+1; v.path = 0; v.depth = 0;
+            return v;
+        }
+
+        // smallest value >= x of the points of v
+        bool _range_next_value(const range_node& v, value_type x, value_type& y)const {
+            if (v.lb == v.rb)
+                return false;
+            if (v.depth == m_logn) {
+                y = v.path;
+                return true;
+            }
+            value_type mid = (v.path<<(m_logn-v.depth)) + (1ULL<<(m_logn-v.depth-1)); // smallest value in the right child
+            range_node left, right;
+            expand(v, left, right);
+            if (x < mid and _range_next_value(left, x, y))
+                return true;
+            return _range_next_value(right, x, y);
+        }
+
+        // number of points of v with values in [vlb..vrb]
+        size_type _range_count_2d(const range_node& v, value_type vlb, value_type vrb)const {
+            if (v.lb == v.rb)
+                return 0;
+            uint32_t h = m_logn - v.depth;
+            value_type nlb = v.path << h; // smallest and largest value of v
+            value_type nrb = nlb + bit_magic::Li1Mask[h];
+            if (vlb <= nlb and nrb <= vrb)
+                return v.rb - v.lb;
+            if (vrb < nlb or nrb < vlb)
+                return 0;
+            range_node left, right;
+            expand(v, left, right);
+            return _range_count_2d(left, vlb, vrb) + _range_count_2d(right, vlb, vrb);
+        }
+
+        // reports the points lb..lb+cnt-1 of the leaf of value path
+        template<class t_report>
+        void _report_leaf(size_type lb, size_type cnt, value_type path, const size_type offsets[], const size_type ones_before_os[], t_report& report)const {
+            for (size_type j=lb+1; j <= lb+cnt; ++j) {
+                size_type i = j;
+                size_type c = path;
+                for (uint32_t k=m_logn; k>0; --k) {
+                    size_type offset = offsets[k-1];
+                    size_type ones_before_o = ones_before_os[k-1];
+                    if (c&1) {
+                        i = m_tree_select1(ones_before_o + i) - offset + 1;
+                    } else {
+                        i = m_tree_select0(offset - ones_before_o + i) - offset + 1;
+                    }
+                    c >>= 1;
+                }
+                report(i-1, path); // -1 cause of 0 based indexing
+            }
+        }
+
+        void _report_leaf(size_type, size_type cnt, value_type path, const size_type*, const size_type*,
+                          range_report_values<size_type, value_type>& report)const {
+            report.val->insert(report.val->end(), cnt, path);
+        }
+
     public:
 
         const size_type& sigma;	//!< Effective alphabet size of the wavelet tree.
@@ -107,14 +360,16 @@ class wt_int
         //! Constructor
         /*!	\param rac Reference a random access container of integer values for which the wavelet tree should be build.
          *	\param logn Let x > 0 be the biggest value in rac. logn should be bit_magic::l1BP(x-1)+1 to represent all values of rac.
+         *	\param threads Number of threads used for the construction. The result does not depend on the number of threads.
          *	\par Time complexity
          *		\f$ \Order{n\log|\Sigma|}\f$, where \f$n=size\f$
          *		I.e. we nee \Order{n\log n} if rac is a permutation of 0..n-1.
          *	\par Space complexity
          *		\f$ 3n\log|\Sigma| \f$ bits, where \f$n=size\f$.
          *		I.e. we need \f$3n\log n \f$ if rac is a permutation of 0..n-1.
+         *		The parallel construction stores the permutations with 8, 16, 32, or 64 bits per element.
          */
-        wt_int(const RandomAccessContainer& rac, uint32_t logn=0):m_size(rac.size()), m_sigma(0), sigma(m_sigma), tree(m_tree) {
+        wt_int(const RandomAccessContainer& rac, uint32_t logn=0, uint32_t threads=1):m_size(rac.size()), m_sigma(0), sigma(m_sigma), tree(m_tree) {
 #ifdef SDSL_DEBUG_INT_WAVELET_TREE
             std::cerr<<"wt_int construct: size="<<m_size<<std::endl;
 #endif
@@ -129,6 +384,11 @@ class wt_int
                 m_logn = logn;
             }
             bit_vector tree(n*m_logn, 0);  // initialize the tree
+            if (construct_parallel(rac, tree, threads)) {
+                util::assign(m_tree, tree);
+                construct_init_rank_select(threads);
+                return;
+            }
 
             int_vector<> 	perms[2];
             perms[0].set_int_width(m_logn); perms[1].set_int_width(m_logn);
@@ -177,15 +437,15 @@ class wt_int
             }
 #endif
             util::assign(m_tree, tree);
-            util::init_support(m_tree_rank, &m_tree);
-            util::init_support(m_tree_select0, &m_tree);
-            util::init_support(m_tree_select1, &m_tree);
+            construct_init_rank_select(1);
         }
 
         //! Semi-external constructor
         /*!	\param buf	int_vector_file_buffer which contains the vector v for which a wt_int should be build.
          *	\param logn Let x > 0 be the biggest value in v. logn should be bit_magic::l1BP(x-1)+1 to represent all values of v.
          *	\param dir	Directory in which temporary files should be stored during the construction.
+         *	\param threads Number of threads used for the construction. For more than one thread, the
+         *	               levels are built in main memory as in the in-memory constructor.
          *	\par Time complexity
          *		\f$ \Order{n\log|\Sigma|}\f$, where \f$n=size\f$
          *		I.e. we nee \Order{n\log n} if rac is a permutation of 0..n-1.
@@ -193,15 +453,15 @@ class wt_int
          *		\f$ n\log|\Sigma| + O(1)\f$ bits, where \f$n=size\f$.
          */
         template<uint8_t int_width>
-        wt_int(int_vector_file_buffer<int_width>& buf, uint32_t logn=0, std::string dir="./")
+        wt_int(int_vector_file_buffer<int_width>& buf, uint32_t logn=0, std::string dir="./", uint32_t threads=1)
             : m_size(0),m_sigma(0), m_logn(0), sigma(m_sigma), tree(m_tree) {
-            construct(buf, logn, dir);
+            construct(buf, logn, dir, threads);
         }
 
 
         // TODO external construction method which occupies only additional constant memory
         template<uint8_t int_width>
-        void construct(int_vector_file_buffer<int_width>& buf, uint32_t logn=0, std::string dir="./") {
+        void construct(int_vector_file_buffer<int_width>& buf, uint32_t logn=0, std::string dir="./", uint32_t threads=1) {
             buf.reset();
             size_type n = buf.int_vector_size;  // set n
             m_size = n;				// set sigma and size
@@ -224,6 +484,15 @@ class wt_int
             } else {
                 m_logn = logn;
             }
+            {
+                bit_vector tree(threads > 1 ? n*m_logn : 0, 0);
+                if (construct_parallel(rac, tree, threads)) {
+                    rac.resize(0);
+                    util::assign(m_tree, tree);
+                    construct_init_rank_select(threads);
+                    return;
+                }
+            }
             std::string tree_out_buf_file_name = (dir+"m_tree"+util::to_string(util::get_pid())+"_"+util::to_string(util::get_id()));
             std::ofstream tree_out_buf(tree_out_buf_file_name.c_str(),
                                        std::ios::binary | std::ios::trunc | std::ios::out);   // open buffer for tree
@@ -286,9 +555,7 @@ class wt_int
             }
 #endif
             util::assign(m_tree, tree);
-            util::init_support(m_tree_rank, &m_tree);
-            util::init_support(m_tree_select0, &m_tree);
-            util::init_support(m_tree_select1, &m_tree);
+            construct_init_rank_select(1);
         }
 
         //! Copy constructor
@@ -393,6 +660,36 @@ class wt_int
             return i;
         };
 
+        //! Calculates the symbol wt[i] and the number of its occurrences in the prefix [0..i-1].
+        /*! Symbol and rank are determined in one traversal of the tree.
+         *  \param i The index of the symbol, \f$i\in [0..size()-1]\f$.
+         *  \return The pair (rank(i, wt[i]), wt[i]).
+         *  \par Time complexity
+         *		\f$ \Order{\log |\Sigma|} \f$
+         */
+        std::pair<size_type, value_type> inverse_select(size_type i)const {
+            size_type offset = 0;
+            value_type res = 0;
+            size_type node_size = m_size;
+            for (uint32_t k=0; k < m_logn; ++k) {
+                res <<= 1;
+                size_type ones_before_o	  = m_tree_rank(offset);
+                size_type ones_before_i   = m_tree_rank(offset + i) - ones_before_o;
+                size_type ones_before_end = m_tree_rank(offset + node_size) - ones_before_o;
+                if (m_tree[offset+i]) { // one at position i => follow right child
+                    offset += (node_size - ones_before_end);
+                    node_size = ones_before_end;
+                    i = ones_before_i;
+                    res |= 1;
+                } else { // zero at position i => follow left child
+                    node_size = (node_size - ones_before_end);
+                    i = (i-ones_before_i);
+                }
+                offset += m_size;
+            }
+            return std::make_pair(i, res); // i is now the position of wt[i] in its leaf
+        }
+
         //! Calculates the ith occurence of the symbol c in the supported vector.
         /*!
          *  \param i The ith occurence. \f$i\in [1..rank(size(),c)]\f$.
@@ -449,11 +746,55 @@ class wt_int
          *  \param vrb Right bound of value interval (inclusive)
          *  \param idx_result Reference to a vector to which the resulting indices should be added
          *  \param val_result Reference to a vector to which the resulting values should be added
+         *  \param max_results Maximal number of points which are added; see range_report_2d.
+         *  \returns The number of points in the query rectangle, but at most max_results.
+         *  \par Note
+         *       If neither indices nor values are requested, the points are counted by range_count_2d.
          */
         size_type range_search_2d(size_type lb, size_type rb, value_type vlb, value_type vrb,
                                   std::vector<size_type>* idx_result=NULL,
-                                  std::vector<value_type>* val_result=NULL
+                                  std::vector<value_type>* val_result=NULL,
+                                  size_type max_results=std::numeric_limits<size_type>::max()
                                  ) const {
+            if (idx_result == NULL and val_result == NULL)
+                return std::min(range_count_2d(lb, rb, vlb, vrb), max_results);
+            if (idx_result == NULL) {
+                range_report_values<size_type, value_type> report(val_result);
+                return range_report_2d(lb, rb, vlb, vrb, report, max_results);
+            }
+            range_report_to_vectors<size_type, value_type> report(idx_result, val_result);
+            return range_report_2d(lb, rb, vlb, vrb, report, max_results);
+        }
+
+        //! Counts the points in the index interval [lb..rb] and value interval [vlb..vrb].
+        /*! \param lb Left bound of index interval (inclusive)
+         *  \param rb Right bound of index interval (inclusive)
+         *  \param vlb Left bound of value interval (inclusive)
+         *  \param vrb Right bound of value interval (inclusive)
+         *  \par Time complexity
+         *		\f$ \Order{\log |\Sigma|} \f$, since the search stops at nodes whose values all lie in [vlb..vrb].
+         */
+        size_type range_count_2d(size_type lb, size_type rb, value_type vlb, value_type vrb)const {
+            if (lb > rb or vlb > vrb)
+                return 0;
+            return _range_count_2d(root_node(lb, rb), vlb, vrb);
+        }
+
+        //! Reports the points in the index interval [lb..rb] and value interval [vlb..vrb] to a callback.
+        /*! \param lb Left bound of index interval (inclusive)
+         *  \param rb Right bound of index interval (inclusive)
+         *  \param vlb Left bound of value interval (inclusive)
+         *  \param vrb Right bound of value interval (inclusive)
+         *  \param report A functor which is called as report(idx, val) for each point; see wt_helper.hpp.
+         *  \param max_results The search stops after max_results points.
+         *  \returns The number of reported points.
+         *  \par Details
+         *       The points are reported in increasing order of their values and
+         *       points with equal values in increasing order of their indices.
+         */
+        template<class t_report>
+        size_type range_report_2d(size_type lb, size_type rb, value_type vlb, value_type vrb, t_report& report,
+                                  size_type max_results=std::numeric_limits<size_type>::max())const {
             size_type offsets[m_logn+1];
             size_type ones_before_os[m_logn+1];
             offsets[0] = 0;
@@ -461,44 +802,25 @@ class wt_int
                 vrb = (1ULL << m_logn);
             if (vlb > vrb)
                 return 0;
-            size_type cnt_answers = 0;
-            _range_search_2d(lb, rb, vlb, vrb, 0, 0, m_size, offsets, ones_before_os, 0, idx_result, val_result, cnt_answers);
-            return cnt_answers;
+            size_type remaining = max_results;
+            _range_search_2d(lb, rb, vlb, vrb, 0, 0, m_size, offsets, ones_before_os, 0, report, remaining);
+            return max_results - remaining;
         }
 
         // add parameter path
         // ilb interval left bound
         // irb interval right bound
+        template<class t_report>
         void _range_search_2d(size_type lb, size_type rb, value_type vlb, value_type vrb, size_type depth,
                               size_type ilb, size_type node_size, size_type offsets[], size_type ones_before_os[], size_type path,
-                              std::vector<size_type>* idx_result, std::vector<size_type>* val_result, size_type& cnt_answers)
+                              t_report& report, size_type& remaining)
         const {
-            if (lb > rb)
+            if (lb > rb or remaining == 0)
                 return;
             if (depth == m_logn) {
-                if (idx_result != NULL) {
-                    for (size_type j=1; j <= node_size; ++j) {
-                        size_type i = j;
-                        size_type c = path;
-                        for (uint32_t k=m_logn; k>0; --k) {
-                            size_type offset = offsets[k-1];
-                            size_type ones_before_o = ones_before_os[k-1];
-                            if (c&1) {
-                                i = m_tree_select1(ones_before_o + i) - offset + 1;
-                            } else {
-                                i = m_tree_select0(offset - ones_before_o + i) - offset + 1;
-                            }
-                            c >>= 1;
-                        }
-                        idx_result->push_back(i-1); // add resulting index; -1 cause of 0 based indexing
-                    }
-                }
-                if (val_result != NULL) {
-                    for (size_type j=1; j <= node_size; ++j) {
-                        val_result->push_back(path);
-                    }
-                }
-                cnt_answers += node_size;
+                size_type cnt = std::min(rb-lb+1, remaining);
+                _report_leaf(lb, cnt, path, offsets, ones_before_os, report);
+                remaining -= cnt;
                 return;
             }
             size_type irb = ilb + (1ULL << (m_logn-depth));
@@ -520,17 +842,85 @@ class wt_int
                 size_type nrb 			= zeros_before_rb - zeros_before_o;
                 offsets[depth+1] 		= offset + m_size;
                 if (nrb)
-                    _range_search_2d(nlb, nrb-1, vlb, std::min(vrb,mid-1), depth+1, ilb, zeros_before_end - zeros_before_o, offsets, ones_before_os, path<<1, idx_result, val_result, cnt_answers);
+                    _range_search_2d(nlb, nrb-1, vlb, std::min(vrb,mid-1), depth+1, ilb, zeros_before_end - zeros_before_o, offsets, ones_before_os, path<<1, report, remaining);
             }
             if (vrb >= mid) {
                 size_type nlb			= ones_before_lb - ones_before_o;
                 size_type nrb			= ones_before_rb - ones_before_o;
                 offsets[depth+1]		= offset + m_size + (zeros_before_end - zeros_before_o);
                 if (nrb)
-                    _range_search_2d(nlb, nrb-1, std::max(mid, vlb), vrb, depth+1, mid, ones_before_end - ones_before_o, offsets, ones_before_os, (path<<1)+1 ,idx_result, val_result, cnt_answers);
+                    _range_search_2d(nlb, nrb-1, std::max(mid, vlb), vrb, depth+1, mid, ones_before_end - ones_before_o, offsets, ones_before_os, (path<<1)+1 ,report, remaining);
             }
         }
 
+        //! Calculates the q-th smallest value in wt[lb..rb].
+        /*! \param lb Left bound of the index interval (inclusive)
+         *  \param rb Right bound of the index interval (inclusive)
+         *  \param q  Rank of the value in the sorted interval, \f$q\in[0..rb-lb]\f$; q=(rb-lb)/2 gives the median.
+         *  \returns The value and its number of occurrences in wt[lb..rb].
+         *  \par Time complexity
+         *		\f$ \Order{\log |\Sigma|} \f$
+         */
+        std::pair<value_type, size_type> range_quantile(size_type lb, size_type rb, size_type q)const {
+            range_node v = root_node(lb, rb), left, right;
+            while (v.depth < m_logn) {
+                expand(v, left, right);
+                if (q < left.rb - left.lb) {
+                    v = left;
+                } else {
+                    q -= left.rb - left.lb;
+                    v = right;
+                }
+            }
+            return std::make_pair(v.path, v.rb - v.lb);
+        }
+
+        //! Calculates the k most frequent values in wt[lb..rb].
+        /*! \param lb Left bound of the index interval (inclusive)
+         *  \param rb Right bound of the index interval (inclusive)
+         *  \param k  Number of values to report.
+         *  \param result Reference to a vector which contains the pairs (value, frequency) in decreasing order of
+         *                frequency afterwards; there are fewer than k pairs if wt[lb..rb] contains fewer distinct values.
+         *  \par Time complexity
+         *		Nodes are expanded in the order of the number of points they contain, so only the nodes
+         *		which contain at least as many points as the k-th result are visited.
+         */
+        void range_top_k(size_type lb, size_type rb, size_type k, std::vector<std::pair<value_type, size_type> >& result)const {
+            result.clear();
+            if (lb > rb or k == 0)
+                return;
+            std::priority_queue<range_node> pq;
+            pq.push(root_node(lb, rb));
+            range_node left, right;
+            while (!pq.empty() and result.size() < k) {
+                range_node v = pq.top(); pq.pop();
+                if (v.depth == m_logn) {
+                    result.push_back(std::make_pair(v.path, v.rb - v.lb));
+                    continue;
+                }
+                expand(v, left, right);
+                if (left.lb < left.rb)
+                    pq.push(left);
+                if (right.lb < right.rb)
+                    pq.push(right);
+            }
+        }
+
+        //! Calculates the smallest value y >= x in wt[lb..rb].
+        /*! \param lb Left bound of the index interval (inclusive)
+         *  \param rb Right bound of the index interval (inclusive)
+         *  \param x  Lower bound for the value.
+         *  \param y  Reference to the resulting value.
+         *  \returns If wt[lb..rb] contains a value >= x.
+         *  \par Time complexity
+         *		\f$ \Order{\log |\Sigma|} \f$
+         */
+        bool range_next_value(size_type lb, size_type rb, value_type x, value_type& y)const {
+            if (lb > rb or (m_logn < 64 and x >= (1ULL<<m_logn)))
+                return false;
+            return _range_next_value(root_node(lb, rb), x, y);
+        }
+
         //! Serializes the data structure into the given ostream
         size_type serialize(std::ostream& out, structure_tree_node* v=NULL, std::string name="")const {
             structure_tree_node* child = structure_tree::add_child(v, name, util::class_name(*this));
@@ -567,6 +957,16 @@ class wt_int
 
 };
 
+//! Forwards to the member inverse_select (see inverse_select in wt_helper.hpp)
+template<class RandomAccessContainer, class BitVector, class RankSupport, class SelectSupport, class SelectSupportZero>
+std::pair<typename wt_int<RandomAccessContainer, BitVector, RankSupport, SelectSupport, SelectSupportZero>::size_type,
+    typename wt_int<RandomAccessContainer, BitVector, RankSupport, SelectSupport, SelectSupportZero>::value_type>
+inverse_select(const wt_int<RandomAccessContainer, BitVector, RankSupport, SelectSupport, SelectSupportZero>& wt,
+               typename wt_int<RandomAccessContainer, BitVector, RankSupport, SelectSupport, SelectSupportZero>::size_type i)
+{
+    return wt.inverse_select(i);
+}
+
 }// end namespace sds
 
 #endif // end file 
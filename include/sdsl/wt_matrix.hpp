@@ -0,0 +1,708 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2012 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file wt_matrix.hpp
+    \brief wt_matrix.hpp contains the class wt_matrix, a wavelet matrix for sequences over big alphabets.
+	\author Simon Gog
+*/
+#ifndef INCLUDED_SDSL_WT_MATRIX
+#define INCLUDED_SDSL_WT_MATRIX
+
+#include "int_vector.hpp"
+#include "rank_support_v.hpp"
+#include "select_support_mcl.hpp"
+#include "bitmagic.hpp"
+#include "temp_write_read_buffer.hpp"
+#include "util.hpp"
+#include "parallel.hpp"
+#include "wt_helper.hpp"
+#include <algorithm> // for std::swap
+#include <stdexcept>
+#include <vector>
+#include <queue> // for range_top_k
+#include <utility> // for pair
+#include <limits> // for numeric_limits
+
+//! Namespace for the succinct data structure library.
+namespace sdsl
+{
+
+//! A wavelet matrix for sequences of big alphabet size (like integer alphabet)
+/*!
+ * The wavelet matrix provides the same methods as wt_int, but the bits of a level are not
+ * grouped by the nodes of the wavelet tree. Level k contains the (k+1)-th highest bit of each
+ * value in the order of the stable sort of the values by their k highest bits reversed: all
+ * values with a 0-bit at level k are moved to the front of level k+1, all values with a 1-bit
+ * to the back. So a position is mapped to the next level by a single rank query and the
+ * number of 0-bits of the level; no node boundaries have to be calculated.
+ *   - The "[]"-operator and select need one rank query per level (wt_int needs three).
+ *   - rank needs two rank queries per level (wt_int needs three).
+ *   - range_search_2d needs two rank queries per visited node (wt_int needs four).
+ *
+ *	\par Space complexity
+ *		\f$\Order{n\log|\Sigma|}\f$ bits, where \f$n\f$ is the size of the vector the wavelet matrix was build for.
+ *
+ *  \tparam RandomAccessContainer 	Type of the input sequence.
+ *  \tparam BitVector				Type of the bitvector used for representing the levels.
+ *  \tparam RankSupport				Type of the support structure for rank on ones.
+ *  \tparam SelectSupport			Type of the support structure for select on ones.
+ *  \tparam SelectSupportZero		Type of the support structure for select on zeros.
+ *
+ *   @ingroup wt
+ */
+template<class RandomAccessContainer=int_vector<>,
+         class BitVector   		 = bit_vector,
+         class RankSupport 		 = typename BitVector::rank_1_type,
+         class SelectSupport	 = typename BitVector::select_1_type,
+         class SelectSupportZero = typename BitVector::select_0_type>
+class wt_matrix
+{
+    public:
+        typedef typename RandomAccessContainer::size_type 		size_type;
+        typedef typename RandomAccessContainer::value_type 		value_type;
+        typedef BitVector										bit_vector_type;
+        typedef RankSupport										rank_1_type;
+        typedef SelectSupport									select_1_type;
+        typedef SelectSupportZero								select_0_type;
+    protected:
+        size_type 			m_size;
+        size_type 			m_sigma; 		//<- \f$ |\Sigma| \f$
+        bit_vector_type 	m_tree;			// concatenation of the levels
+        rank_1_type			m_tree_rank;	// rank support for the levels
+        select_1_type		m_tree_select1;	// select support for the levels
+        select_0_type		m_tree_select0;
+        uint32_t			m_logn;
+        int_vector<64>		m_zeros;		// number of 0-bits in each level
+        int_vector<64>		m_ones_before;	// number of 1-bits before each level in m_tree
+
+        void copy(const wt_matrix& wt) {
+            m_size 			= wt.m_size;
+            m_sigma 		= wt.m_sigma;
+            m_tree			= wt.m_tree;
+            m_tree_rank 	= wt.m_tree_rank;
+            m_tree_rank.set_vector(&m_tree);
+            m_tree_select1	= wt.m_tree_select1;
+            m_tree_select1.set_vector(&m_tree);
+            m_tree_select0	= wt.m_tree_select0;
+            m_tree_select0.set_vector(&m_tree);
+            m_logn			= wt.m_logn;
+            m_zeros			= wt.m_zeros;
+            m_ones_before	= wt.m_ones_before;
+        }
+
+        // number of 1-bits in the prefix [0..i-1] of level k
+        size_type rank1_level(uint32_t k, size_type i)const {
+            return m_tree_rank(k*m_size + i) - m_ones_before[k];
+        }
+
+        // maps position i of level m_logn (below the last level) of a value c to its position in level 0
+        size_type position_in_first_level(size_type i, value_type c)const {
+            uint64_t mask = 1ULL;
+            for (uint32_t k=m_logn; k > 0; --k) {
+                size_type offset = (k-1)*m_size;
+                if (c & mask) { // i is the (i-zeros+1)-th 1-bit of level k-1
+                    i = m_tree_select1(m_ones_before[k-1] + i - m_zeros[k-1] + 1) - offset;
+                } else { // i is the (i+1)-th 0-bit of level k-1
+                    i = m_tree_select0(offset - m_ones_before[k-1] + i + 1) - offset;
+                }
+                mask <<= 1;
+            }
+            return i;
+        }
+
+        // counts the distinct values in perm, in which equal values are adjacent
+        template<class Container>
+        void count_sigma(const Container& perm) {
+            m_sigma = 0;
+            for (size_type i=0; i < m_size; ++i) {
+                if (i == 0 or perm[i] != perm[i-1])
+                    ++m_sigma;
+            }
+        }
+
+        void construct_init_rank_select(uint32_t threads) {
+            if (threads > 1) {
+                parallel::init_support_task<rank_1_type, bit_vector_type> rank_task(m_tree_rank, &m_tree);
+                parallel::init_support_task<select_0_type, bit_vector_type> select0_task(m_tree_select0, &m_tree);
+                parallel::init_support_task<select_1_type, bit_vector_type> select1_task(m_tree_select1, &m_tree);
+                parallel::run(rank_task, select0_task, select1_task);
+            } else {
+                util::init_support(m_tree_rank, &m_tree);
+                util::init_support(m_tree_select0, &m_tree);
+                util::init_support(m_tree_select1, &m_tree);
+            }
+            m_ones_before.resize(m_logn);
+            for (uint32_t k=0; k < m_logn; ++k) {
+                m_ones_before[k] = m_tree_rank(k*m_size);
+            }
+        }
+
+        // the positions [lb..rb-1] in level depth of the values with prefix path
+        struct range_node {
+            size_type lb, rb;
+            value_type path;
+            uint32_t depth;
+            bool operator<(const range_node& v)const {
+                return rb-lb < v.rb-v.lb;
+            }
+        };
+
+        // calculates the positions of the points of v in the next level
+        void expand(const range_node& v, range_node& left, range_node& right)const {
+            size_type ones_before_lb = rank1_level(v.depth, v.lb);
+            size_type ones_before_rb = rank1_level(v.depth, v.rb);
+            left.lb = v.lb - ones_before_lb; left.rb = v.rb - ones_before_rb;
+            left.path = v.path<<1; left.depth = v.depth+1;
+            right.lb = m_zeros[v.depth] + ones_before_lb; right.rb = m_zeros[v.depth] + ones_before_rb;
+            right.path = (v.path<<1)|1; right.depth = v.depth+1;
+        }
+
+        range_node root_node(size_type lb, size_type rb)const {
+            range_node v;
+            v.lb = lb; v.rb = rb+1; v.path = 0; v.depth = 0;
+            return v;
+        }
+
+        // smallest value >= x of the points of v
+        bool _range_next_value(const range_node& v, value_type x, value_type& y)const {
+            if (v.lb == v.rb)
+                return false;
+            if (v.depth == m_logn) {
+                y = v.path;
+                return true;
+            }
+            value_type mid = (v.path<<(m_logn-v.depth)) + (1ULL<<(m_logn-v.depth-1)); // smallest value in the right child
+            range_node left, right;
+            expand(v, left, right);
+            if (x < mid and _range_next_value(left, x, y))
+                return true;
+            return _range_next_value(right, x, y);
+        }
+
+        // number of points of v with values in [vlb..vrb]
+        size_type _range_count_2d(const range_node& v, value_type vlb, value_type vrb)const {
+            if (v.lb == v.rb)
+                return 0;
+            uint32_t h = m_logn - v.depth;
+            value_type nlb = v.path << h; // smallest and largest value of v
+            value_type nrb = nlb + bit_magic::Li1Mask[h];
+            if (vlb <= nlb and nrb <= vrb)
+                return v.rb - v.lb;
+            if (vrb < nlb or nrb < vlb)
+                return 0;
+            range_node left, right;
+            expand(v, left, right);
+            return _range_count_2d(left, vlb, vrb) + _range_count_2d(right, vlb, vrb);
+        }
+
+        // reports the points lb..lb+cnt-1 of the last level, which have value path
+        template<class t_report>
+        void _report_leaf(size_type lb, size_type cnt, value_type path, t_report& report)const {
+            for (size_type j=lb; j < lb+cnt; ++j) {
+                report(position_in_first_level(j, path), path);
+            }
+        }
+
+        void _report_leaf(size_type, size_type cnt, value_type path, range_report_values<size_type, value_type>& report)const {
+            report.val->insert(report.val->end(), cnt, path);
+        }
+
+    public:
+
+        const size_type& sigma;	//!< Effective alphabet size of the wavelet matrix.
+        const bit_vector_type& tree; //!< A concatenation of all levels of the wavelet matrix.
+
+        //! Default constructor
+        wt_matrix():m_size(0),m_sigma(0), m_logn(0), sigma(m_sigma), tree(m_tree) {};
+
+        //! Constructor
+        /*!	\param rac Reference a random access container of integer values for which the wavelet matrix should be build.
+         *	\param logn Let x > 0 be the biggest value in rac. logn should be bit_magic::l1BP(x-1)+1 to represent all values of rac.
+         *	\param threads Number of threads used for the construction of the rank and select supports.
+         *	\par Time complexity
+         *		\f$ \Order{n\log|\Sigma|}\f$, where \f$n=size\f$
+         *	\par Space complexity
+         *		\f$ 3n\log|\Sigma| \f$ bits, where \f$n=size\f$.
+         */
+        wt_matrix(const RandomAccessContainer& rac, uint32_t logn=0, uint32_t threads=1):m_size(rac.size()), m_sigma(0), sigma(m_sigma), tree(m_tree) {
+            size_type n	=	m_size;
+            if (logn == 0) { // detect the biggest value in rac and set logn properly
+                value_type x = 1;
+                for (size_type i=0; i < n; ++i)
+                    if (rac[i] > x)
+                        x = rac[i];
+                m_logn	= bit_magic::l1BP(x)+1; // we need logn bits to represent all values in the range [0..x]
+            } else {
+                m_logn = logn;
+            }
+            bit_vector tree(n*m_logn, 0);
+            m_zeros = int_vector<64>(m_logn, 0);
+
+            int_vector<> 	perms[2];
+            perms[0].set_int_width(m_logn); perms[1].set_int_width(m_logn);
+            perms[0].resize(n);	perms[1].resize(n);
+            for (size_type i=0; i < n; ++i) { // copy original array to perms[0]
+                perms[0][i] = rac[i];
+            }
+            for (uint32_t k=0; k<m_logn; ++k) {
+                int_vector<>& 	act_perm	 = perms[k%2];
+                int_vector<>& 	next_perm	 = perms[1-(k%2)];
+                const uint64_t	mask		 = 1ULL<<(m_logn-k-1);
+                size_type		tree_pos	 = k*n;
+                size_type		cnt0		 = 0;
+                for (size_type i=0; i < n; ++i, ++tree_pos) {
+                    if (act_perm[i]&mask)
+                        tree[tree_pos] = 1;
+                    else
+                        ++cnt0;
+                }
+                m_zeros[k] = cnt0;
+                size_type idxs[2] = {0, cnt0}; // stable partition: 0-bits first, then 1-bits
+                for (size_type i=0; i < n; ++i) {
+                    next_perm[idxs[(act_perm[i]&mask)>0]++] = act_perm[i];
+                }
+            }
+            count_sigma(perms[m_logn%2]);
+            util::assign(m_tree, tree);
+            construct_init_rank_select(threads);
+        }
+
+        //! Semi-external constructor
+        /*!	\param buf	int_vector_file_buffer which contains the vector v for which a wt_matrix should be build.
+         *	\param logn Let x > 0 be the biggest value in v. logn should be bit_magic::l1BP(x-1)+1 to represent all values of v.
+         *	\param dir	Directory in which temporary files should be stored during the construction.
+         *	\param threads Number of threads used for the construction of the rank and select supports.
+         *	\par Time complexity
+         *		\f$ \Order{n\log|\Sigma|}\f$, where \f$n=size\f$
+         *	\par Space complexity
+         *		\f$ n\log|\Sigma| + O(1)\f$ bits, where \f$n=size\f$.
+         */
+        template<uint8_t int_width>
+        wt_matrix(int_vector_file_buffer<int_width>& buf, uint32_t logn=0, std::string dir="./", uint32_t threads=1)
+            : m_size(0),m_sigma(0), m_logn(0), sigma(m_sigma), tree(m_tree) {
+            construct(buf, logn, dir, threads);
+        }
+
+        template<uint8_t int_width>
+        void construct(int_vector_file_buffer<int_width>& buf, uint32_t logn=0, std::string dir="./", uint32_t threads=1) {
+            buf.reset();
+            size_type n = buf.int_vector_size;
+            m_size = n;
+            temp_write_read_buffer<> buf1(5000000, buf.int_width, dir);   // buffer for the elements with a 1-bit
+            int_vector<int_width> rac(n, 0, buf.int_width);
+
+            value_type x = 1;  // variable for the biggest value in rac
+            for (size_type i=0,r=0,r_sum=0; i<n;) { // detect the biggest value in rac
+                for (; i < r+r_sum; ++i) {
+                    if (buf[i-r_sum] > x)
+                        x = buf[i-r_sum];
+                    rac[i] = buf[i-r_sum];
+                }
+                r_sum += r; r = buf.load_next_block();
+            }
+            if (logn == 0) {
+                m_logn	= bit_magic::l1BP(x)+1; // we need logn bits to represent all values in the range [0..x]
+            } else {
+                m_logn = logn;
+            }
+            m_zeros = int_vector<64>(m_logn, 0);
+
+            std::string tree_out_buf_file_name = (dir+"m_tree"+util::to_string(util::get_pid())+"_"+util::to_string(util::get_id()));
+            std::ofstream tree_out_buf(tree_out_buf_file_name.c_str(),
+                                       std::ios::binary | std::ios::trunc | std::ios::out);   // open buffer for tree
+            size_type bit_size = n*m_logn;
+            tree_out_buf.write((char*) &bit_size, sizeof(bit_size));    // write size of bit_vector
+
+            size_type tree_pos = 0;
+            uint64_t tree_word = 0;
+            for (uint32_t k=0; k<m_logn; ++k) {
+                const uint64_t	mask = 1ULL<<(m_logn-k-1);
+                size_type		cnt0 = 0;
+                uint64_t		y;
+                buf1.reset();
+                for (size_type i=0; i < n; ++i) {
+                    y = rac[i];
+                    if (y&mask) {
+                        tree_word |= (1ULL << (tree_pos&0x3FULL));
+                        buf1 << y;
+                    } else {
+                        rac[cnt0++] = y;
+                    }
+                    ++tree_pos;
+                    if ((tree_pos & 0x3FULL) == 0) { // if tree_pos % 64 == 0 write old word
+                        tree_out_buf.write((char*) &tree_word, sizeof(tree_word));
+                        tree_word = 0;
+                    }
+                }
+                buf1.write_close();
+                m_zeros[k] = cnt0;
+                for (size_type i=cnt0; i < n; ++i) { // the elements with a 1-bit follow in their order
+                    buf1 >> y;
+                    rac[i] = y;
+                }
+            }
+            if ((tree_pos & 0x3FULL) != 0) { // if tree_pos % 64 > 0 => there are remaining entries we have to write
+                tree_out_buf.write((char*) &tree_word, sizeof(tree_word));
+            }
+            tree_out_buf.close();
+            count_sigma(rac);
+            rac.resize(0);
+            bit_vector tree;
+            util::load_from_file(tree, tree_out_buf_file_name.c_str());
+            std::remove(tree_out_buf_file_name.c_str());
+            util::assign(m_tree, tree);
+            construct_init_rank_select(threads);
+        }
+
+        //! Copy constructor
+        wt_matrix(const wt_matrix& wt):sigma(m_sigma), tree(m_tree) {
+            copy(wt);
+        }
+
+        //! Assignment operator
+        wt_matrix& operator=(const wt_matrix& wt) {
+            if (this != &wt) {
+                copy(wt);
+            }
+            return *this;
+        }
+
+        //! Swap operator
+        void swap(wt_matrix& wt) {
+            if (this != &wt) {
+                std::swap(m_size, wt.m_size);
+                std::swap(m_sigma,  wt.m_sigma);
+                m_tree.swap(wt.m_tree);
+                m_tree_rank.swap(wt.m_tree_rank); // rank swap after the swap of the bit vector m_tree
+                m_tree_rank.set_vector(&m_tree);
+                m_tree_select1.swap(wt.m_tree_select1); // select1 swap after the swap of the bit vector m_tree
+                m_tree_select1.set_vector(&m_tree);
+                m_tree_select0.swap(wt.m_tree_select0); // select0 swap after the swap of the bit vector m_tree
+                m_tree_select0.set_vector(&m_tree);
+                std::swap(m_logn,  wt.m_logn);
+                m_zeros.swap(wt.m_zeros);
+                m_ones_before.swap(wt.m_ones_before);
+            }
+        }
+
+        //! Returns the size of the original vector.
+        size_type size()const {
+            return m_size;
+        }
+
+        //! Returns whether the wavelet matrix contains no data.
+        bool empty()const {
+            return m_size == 0;
+        }
+
+        //! Recovers the ith symbol of the original vector.
+        /*! \param i The index of the symbol in the original vector. \f$i \in [0..size()-1]\f$
+         *	\returns The ith symbol of the original vector.
+         *  \par Time complexity
+         *		\f$ \Order{\log |\Sigma|} \f$, one rank query per level.
+         */
+        value_type operator[](size_type i)const {
+            value_type res = 0;
+            for (uint32_t k=0; k < m_logn; ++k) {
+                res <<= 1;
+                size_type ones_before_i = rank1_level(k, i);
+                if (m_tree[k*m_size + i]) { // one at position i => the 1-bits follow the 0-bits in the next level
+                    i = m_zeros[k] + ones_before_i;
+                    res |= 1;
+                } else {
+                    i = i - ones_before_i;
+                }
+            }
+            return res;
+        }
+
+        //! Calculates how many symbols c are in the prefix [0..i-1] of the supported vector.
+        /*!
+         *  \param i The exclusive index of the prefix range [0..i-1], so \f$i\in[0..size()]\f$.
+         *  \param c The symbol to count the occurences in the prefix.
+         *	\returns The number of occurences of symbol c in the prefix [0..i-1] of the supported vector.
+         *  \par Time complexity
+         *		\f$ \Order{\log |\Sigma|} \f$, two rank queries per level.
+         */
+        size_type rank(size_type i, value_type c)const {
+            size_type b = 0; // start of the positions of the values with the prefix of c in the current level
+            uint64_t mask = (1ULL) << (m_logn-1);
+            for (uint32_t k=0; k < m_logn and i > b; ++k) {
+                if (c & mask) {
+                    b = m_zeros[k] + rank1_level(k, b);
+                    i = m_zeros[k] + rank1_level(k, i);
+                } else {
+                    b = b - rank1_level(k, b);
+                    i = i - rank1_level(k, i);
+                }
+                mask >>= 1;
+            }
+            return i > b ? i-b : 0;
+        }
+
+        //! Calculates the symbol wt[i] and the number of its occurrences in the prefix [0..i-1].
+        /*! Symbol and rank are determined in one traversal of the levels.
+         *  \param i The index of the symbol, \f$i\in [0..size()-1]\f$.
+         *  \return The pair (rank(i, wt[i]), wt[i]).
+         *  \par Time complexity
+         *		\f$ \Order{\log |\Sigma|} \f$, two rank queries per level.
+         */
+        std::pair<size_type, value_type> inverse_select(size_type i)const {
+            value_type res = 0;
+            size_type b = 0; // start of the positions of the values with the prefix of wt[i] in the current level
+            for (uint32_t k=0; k < m_logn; ++k) {
+                res <<= 1;
+                if (m_tree[k*m_size + i]) {
+                    b = m_zeros[k] + rank1_level(k, b);
+                    i = m_zeros[k] + rank1_level(k, i);
+                    res |= 1;
+                } else {
+                    b = b - rank1_level(k, b);
+                    i = i - rank1_level(k, i);
+                }
+            }
+            return std::make_pair(i-b, res);
+        }
+
+        //! Calculates the ith occurence of the symbol c in the supported vector.
+        /*!
+         *  \param i The ith occurence. \f$i\in [1..rank(size(),c)]\f$.
+         *  \param c The symbol c.
+         *  \par Time complexity
+         *		\f$ \Order{\log |\Sigma|} \f$, one rank and one select query per level.
+         */
+        size_type select(size_type i, value_type c)const {
+            size_type b = 0; // start of the positions of the values with the prefix of c in the current level
+            uint64_t mask = (1ULL) << (m_logn-1);
+            for (uint32_t k=0; k < m_logn; ++k) {
+                if (c & mask) {
+                    b = m_zeros[k] + rank1_level(k, b);
+                } else {
+                    b = b - rank1_level(k, b);
+                }
+                mask >>= 1;
+            }
+            return position_in_first_level(b + i - 1, c);
+        }
+
+        //! range_search_2d searches points in the index interval [lb..rb] and value interval [vlb..vrb].
+        /*! \param lb Left bound of index interval (inclusive)
+         *  \param rb Right bound of index interval (inclusive)
+         *  \param vlb Left bound of value interval (inclusive)
+         *  \param vrb Right bound of value interval (inclusive)
+         *  \param idx_result Reference to a vector to which the resulting indices should be added
+         *  \param val_result Reference to a vector to which the resulting values should be added
+         *  \param max_results Maximal number of points which are added; see range_report_2d.
+         *  \returns The number of points in the query rectangle, but at most max_results.
+         *  \par Note
+         *       If neither indices nor values are requested, the points are counted by range_count_2d.
+         */
+        size_type range_search_2d(size_type lb, size_type rb, value_type vlb, value_type vrb,
+                                  std::vector<size_type>* idx_result=NULL,
+                                  std::vector<value_type>* val_result=NULL,
+                                  size_type max_results=std::numeric_limits<size_type>::max()
+                                 ) const {
+            if (idx_result == NULL and val_result == NULL)
+                return std::min(range_count_2d(lb, rb, vlb, vrb), max_results);
+            if (idx_result == NULL) {
+                range_report_values<size_type, value_type> report(val_result);
+                return range_report_2d(lb, rb, vlb, vrb, report, max_results);
+            }
+            range_report_to_vectors<size_type, value_type> report(idx_result, val_result);
+            return range_report_2d(lb, rb, vlb, vrb, report, max_results);
+        }
+
+        //! Counts the points in the index interval [lb..rb] and value interval [vlb..vrb].
+        /*! \param lb Left bound of index interval (inclusive)
+         *  \param rb Right bound of index interval (inclusive)
+         *  \param vlb Left bound of value interval (inclusive)
+         *  \param vrb Right bound of value interval (inclusive)
+         *  \par Time complexity
+         *		\f$ \Order{\log |\Sigma|} \f$, since the search stops at nodes whose values all lie in [vlb..vrb].
+         */
+        size_type range_count_2d(size_type lb, size_type rb, value_type vlb, value_type vrb)const {
+            if (lb > rb or vlb > vrb)
+                return 0;
+            return _range_count_2d(root_node(lb, rb), vlb, vrb);
+        }
+
+        //! Reports the points in the index interval [lb..rb] and value interval [vlb..vrb] to a callback.
+        /*! \param lb Left bound of index interval (inclusive)
+         *  \param rb Right bound of index interval (inclusive)
+         *  \param vlb Left bound of value interval (inclusive)
+         *  \param vrb Right bound of value interval (inclusive)
+         *  \param report A functor which is called as report(idx, val) for each point; see wt_helper.hpp.
+         *  \param max_results The search stops after max_results points.
+         *  \returns The number of reported points.
+         *  \par Details
+         *       The points are reported in increasing order of their values and
+         *       points with equal values in increasing order of their indices.
+         */
+        template<class t_report>
+        size_type range_report_2d(size_type lb, size_type rb, value_type vlb, value_type vrb, t_report& report,
+                                  size_type max_results=std::numeric_limits<size_type>::max())const {
+            if (vrb > (1ULL << m_logn))
+                vrb = (1ULL << m_logn);
+            if (vlb > vrb or lb > rb)
+                return 0;
+            size_type remaining = max_results;
+            _range_search_2d(lb, rb+1, vlb, vrb, 0, 0, 0, report, remaining);
+            return max_results - remaining;
+        }
+
+        // [lb..rb-1] is the interval of the points in level depth,
+        // ilb is the smallest value of the current node and path its prefix of the values
+        template<class t_report>
+        void _range_search_2d(size_type lb, size_type rb, value_type vlb, value_type vrb, size_type depth,
+                              value_type ilb, value_type path, t_report& report, size_type& remaining)
+        const {
+            if (remaining == 0)
+                return;
+            if (depth == m_logn) {
+                size_type cnt = std::min(rb-lb, remaining);
+                _report_leaf(lb, cnt, path, report);
+                remaining -= cnt;
+                return;
+            }
+            value_type mid = ilb + (1ULL << (m_logn-depth-1));
+            size_type ones_before_lb = rank1_level(depth, lb);
+            size_type ones_before_rb = rank1_level(depth, rb);
+            if (vlb < mid) {
+                size_type nlb = lb - ones_before_lb;
+                size_type nrb = rb - ones_before_rb;
+                if (nrb > nlb)
+                    _range_search_2d(nlb, nrb, vlb, std::min(vrb, mid-1), depth+1, ilb, path<<1, report, remaining);
+            }
+            if (vrb >= mid) {
+                size_type nlb = m_zeros[depth] + ones_before_lb;
+                size_type nrb = m_zeros[depth] + ones_before_rb;
+                if (nrb > nlb)
+                    _range_search_2d(nlb, nrb, std::max(mid, vlb), vrb, depth+1, mid, (path<<1)+1, report, remaining);
+            }
+        }
+
+        //! Calculates the q-th smallest value in wt[lb..rb].
+        /*! \param lb Left bound of the index interval (inclusive)
+         *  \param rb Right bound of the index interval (inclusive)
+         *  \param q  Rank of the value in the sorted interval, \f$q\in[0..rb-lb]\f$; q=(rb-lb)/2 gives the median.
+         *  \returns The value and its number of occurrences in wt[lb..rb].
+         *  \par Time complexity
+         *		\f$ \Order{\log |\Sigma|} \f$, two rank queries per level.
+         */
+        std::pair<value_type, size_type> range_quantile(size_type lb, size_type rb, size_type q)const {
+            range_node v = root_node(lb, rb), left, right;
+            while (v.depth < m_logn) {
+                expand(v, left, right);
+                if (q < left.rb - left.lb) {
+                    v = left;
+                } else {
+                    q -= left.rb - left.lb;
+                    v = right;
+                }
+            }
+            return std::make_pair(v.path, v.rb - v.lb);
+        }
+
+        //! Calculates the k most frequent values in wt[lb..rb].
+        /*! \param lb Left bound of the index interval (inclusive)
+         *  \param rb Right bound of the index interval (inclusive)
+         *  \param k  Number of values to report.
+         *  \param result Reference to a vector which contains the pairs (value, frequency) in decreasing order of
+         *                frequency afterwards; there are fewer than k pairs if wt[lb..rb] contains fewer distinct values.
+         *  \par Time complexity
+         *		Nodes are expanded in the order of the number of points they contain, so only the nodes
+         *		which contain at least as many points as the k-th result are visited.
+         */
+        void range_top_k(size_type lb, size_type rb, size_type k, std::vector<std::pair<value_type, size_type> >& result)const {
+            result.clear();
+            if (lb > rb or k == 0)
+                return;
+            std::priority_queue<range_node> pq;
+            pq.push(root_node(lb, rb));
+            range_node left, right;
+            while (!pq.empty() and result.size() < k) {
+                range_node v = pq.top(); pq.pop();
+                if (v.depth == m_logn) {
+                    result.push_back(std::make_pair(v.path, v.rb - v.lb));
+                    continue;
+                }
+                expand(v, left, right);
+                if (left.lb < left.rb)
+                    pq.push(left);
+                if (right.lb < right.rb)
+                    pq.push(right);
+            }
+        }
+
+        //! Calculates the smallest value y >= x in wt[lb..rb].
+        /*! \param lb Left bound of the index interval (inclusive)
+         *  \param rb Right bound of the index interval (inclusive)
+         *  \param x  Lower bound for the value.
+         *  \param y  Reference to the resulting value.
+         *  \returns If wt[lb..rb] contains a value >= x.
+         *  \par Time complexity
+         *		\f$ \Order{\log |\Sigma|} \f$
+         */
+        bool range_next_value(size_type lb, size_type rb, value_type x, value_type& y)const {
+            if (lb > rb or (m_logn < 64 and x >= (1ULL<<m_logn)))
+                return false;
+            return _range_next_value(root_node(lb, rb), x, y);
+        }
+
+        //! Serializes the data structure into the given ostream
+        size_type serialize(std::ostream& out, structure_tree_node* v=NULL, std::string name="")const {
+            structure_tree_node* child = structure_tree::add_child(v, name, util::class_name(*this));
+            size_type written_bytes = 0;
+            written_bytes += util::write_member(m_size, out, child, "size");
+            written_bytes += util::write_member(m_sigma, out, child, "sigma");
+            written_bytes += m_tree.serialize(out, child, "tree");
+            written_bytes += m_tree_rank.serialize(out, child, "tree_rank");
+            written_bytes += m_tree_select1.serialize(out, child, "tree_select_1");
+            written_bytes += m_tree_select0.serialize(out, child, "tree_select_0");
+            written_bytes += util::write_member(m_logn, out, child, "log_n");
+            written_bytes += m_zeros.serialize(out, child, "zeros");
+            written_bytes += m_ones_before.serialize(out, child, "ones_before");
+            structure_tree::add_size(child, written_bytes);
+            return written_bytes;
+        }
+
+        //! Loads the data structure from the given istream.
+        void load(std::istream& in) {
+            util::read_member(m_size, in);
+            util::read_member(m_sigma, in);
+            m_tree.load(in);
+            m_tree_rank.load(in, &m_tree);
+            m_tree_select1.load(in, &m_tree);
+            m_tree_select0.load(in, &m_tree);
+            util::read_member(m_logn, in);
+            m_zeros.load(in);
+            m_ones_before.load(in);
+        }
+};
+
+//! Forwards to the member inverse_select (see inverse_select in wt_helper.hpp)
+template<class RandomAccessContainer, class BitVector, class RankSupport, class SelectSupport, class SelectSupportZero>
+std::pair<typename wt_matrix<RandomAccessContainer, BitVector, RankSupport, SelectSupport, SelectSupportZero>::size_type,
+    typename wt_matrix<RandomAccessContainer, BitVector, RankSupport, SelectSupport, SelectSupportZero>::value_type>
+inverse_select(const wt_matrix<RandomAccessContainer, BitVector, RankSupport, SelectSupport, SelectSupportZero>& wt,
+               typename wt_matrix<RandomAccessContainer, BitVector, RankSupport, SelectSupport, SelectSupportZero>::size_type i)
+{
+    return wt.inverse_select(i);
+}
+
+}// end namespace sdsl
+
+#endif // end file
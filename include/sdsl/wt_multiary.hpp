@@ -0,0 +1,530 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2012 Simon Gog
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see http://www.gnu.org/licenses/ .
+*/
+/*! \file wt_multiary.hpp
+    \brief wt_multiary.hpp contains the class wt_multiary, a balanced multiary wavelet tree for byte alphabets.
+	\author Simon Gog
+*/
+#ifndef INCLUDED_SDSL_WT_MULTIARY
+#define INCLUDED_SDSL_WT_MULTIARY
+
+#include "int_vector.hpp"
+#include "bitmagic.hpp"
+#include "util.hpp"
+#include "wt_helper.hpp"
+#include "compatibility.hpp" // for SDSL_PREFETCH
+#include <algorithm> // for std::swap
+#include <stdexcept>
+#include <vector>
+
+//! Namespace for the succinct data structure library.
+namespace sdsl
+{
+
+//! A balanced wavelet tree with \f$2^{bits\_per\_level}\f$ children per inner node.
+/*!
+ * The symbols are mapped to the codes \f$[0..\sigma-1]\f$ in lexicographic order and each level
+ * of the tree stores one digit of bits_per_level bits of the codes. So a byte alphabet needs
+ * \f$\lceil\log\sigma/bits\_per\_level\rceil\f$ levels (e.g. 2 for bits_per_level=4) instead of
+ * \f$\lceil\log\sigma\rceil\f$ levels of a binary wavelet tree, and the "[]"-operator, rank and
+ * rank_ith_symbol access one block per level.
+ *
+ * The digits of all levels are stored packed in blocks of 16 64-bit words. Each block is
+ * preceded by 16-bit counters of the occurrences of each digit in the superblock (64 blocks)
+ * before the block, so the counters and the digits of a rank query are read from adjacent memory.
+ * The occurrences of a digit in a word are counted by a broadword comparison of all digits of
+ * the word followed by a popcount.
+ *
+ *	\par Space complexity
+ *		\f$ n\cdot bits\_per\_level\cdot\lceil\log\sigma/bits\_per\_level\rceil(1+\frac{2^{bits\_per\_level}}{64}) \f$ bits.
+ *
+ *  \tparam bits_per_level Number of bits of the digit stored at each level; 1, 2, 4 or 8.
+ *
+ *   @ingroup wt
+ */
+template<uint8_t bits_per_level=4>
+class wt_multiary
+{
+    public:
+        typedef int_vector<>::size_type	size_type;
+        typedef unsigned char		 	value_type;
+
+        enum { degree = 1<<bits_per_level }; // number of children of an inner node
+    private:
+        enum { digits_per_word		= 64/bits_per_level,
+               data_words			= 16,
+               block_digits			= data_words*digits_per_word,
+               counter_words		= (degree*16+63)/64, // words for the 16-bit counters of a block
+               block_words			= counter_words + data_words,
+               superblock_blocks	= 64
+             };
+
+        size_type		m_size;
+        size_type		m_sigma;
+        uint32_t		m_levels;			// number of levels of the tree
+        int_vector<64>	m_data;				// the blocks of the digit sequence of all levels
+        int_vector<64>	m_sb_rank;			// m_sb_rank[s*degree+d] = number of digits d before superblock s
+        int_vector<64>	m_node_start;		// position of the first digit of each node in the digit sequence
+        int_vector<64>	m_node_rank;		// m_node_rank[v*degree+d] = number of digits d before node v
+        uint16_t		m_char2code[256];	// code of each symbol, or _undef_node if the symbol does not occur
+        unsigned char	m_code2char[256];
+
+        void copy(const wt_multiary& wt) {
+            m_size			= wt.m_size;
+            m_sigma			= wt.m_sigma;
+            m_levels		= wt.m_levels;
+            m_data			= wt.m_data;
+            m_sb_rank		= wt.m_sb_rank;
+            m_node_start	= wt.m_node_start;
+            m_node_rank		= wt.m_node_rank;
+            for (size_type i=0; i<256; ++i) {
+                m_char2code[i] = wt.m_char2code[i];
+                m_code2char[i] = wt.m_code2char[i];
+            }
+        }
+
+        // word with the lowest bit of each digit set
+        static uint64_t low_bits() {
+            switch (bits_per_level) {
+                case 1: return 0xFFFFFFFFFFFFFFFFULL;
+                case 2: return 0x5555555555555555ULL;
+                case 4: return 0x1111111111111111ULL;
+                default: return 0x0101010101010101ULL;
+            }
+        }
+
+        // word in which the lowest bit of each digit of w is set iff the digit equals d
+        static uint64_t digit_matches(uint64_t w, uint64_t d) {
+            uint64_t x = ~(w ^ (d*low_bits()));
+            for (uint32_t s=1; s < bits_per_level; s <<= 1)
+                x &= x >> s;
+            return x & low_bits();
+        }
+
+        // number of digits d in the superblock before block blk
+        size_type block_counter(size_type blk, uint64_t d)const {
+            return (m_data[blk*block_words + d/4] >> ((d%4)*16)) & 0xFFFF;
+        }
+
+        // number of digits d in the first r digits of block blk plus the digits d before the block
+        size_type block_rank(size_type blk, size_type r, uint64_t d)const {
+            const uint64_t* b = m_data.data() + blk*block_words;
+            size_type res = m_sb_rank[(blk/superblock_blocks)*degree + d] + ((b[d/4] >> ((d%4)*16)) & 0xFFFF);
+            b += counter_words;
+            for (; r >= (size_type)digits_per_word; r -= digits_per_word, ++b)
+                res += bit_magic::b1Cnt(digit_matches(*b, d));
+            if (r)
+                res += bit_magic::b1Cnt(digit_matches(*b, d) & bit_magic::Li1Mask[r*bits_per_level]);
+            return res;
+        }
+
+        // number of digits d in the prefix [0..p-1] of the digit sequence
+        size_type digit_rank(size_type p, uint64_t d)const {
+            return block_rank(p/block_digits, p%block_digits, d);
+        }
+
+        // sets d to the digit at position p and returns the number of digits d in [0..p-1]
+        size_type digit_access_rank(size_type p, uint64_t& d)const {
+            size_type blk = p/block_digits, r = p%block_digits;
+            uint64_t w = m_data[blk*block_words + counter_words + r/digits_per_word];
+            d = (w >> ((r%digits_per_word)*bits_per_level)) & (degree-1);
+            return block_rank(blk, r, d);
+        }
+
+        // position of the k-th digit d in the digit sequence, k >= 1
+        size_type digit_select(size_type k, uint64_t d)const {
+            size_type lb = 0, rb = m_sb_rank.size()/degree; // binary search for the last superblock with less than k digits d before it
+            while (rb-lb > 1) {
+                size_type mid = (lb+rb)/2;
+                if (m_sb_rank[mid*degree + d] < k)
+                    lb = mid;
+                else
+                    rb = mid;
+            }
+            k -= m_sb_rank[lb*degree + d];
+            size_type blk = lb*superblock_blocks, end = std::min(blk+superblock_blocks, m_data.size()/block_words);
+            while (blk+1 < end and block_counter(blk+1, d) < k)
+                ++blk;
+            k -= block_counter(blk, d);
+            const uint64_t* b = m_data.data() + blk*block_words + counter_words;
+            for (size_type j=0; ; ++j) {
+                uint64_t m = digit_matches(b[j], d);
+                size_type cnt = bit_magic::b1Cnt(m);
+                if (cnt >= k)
+                    return blk*block_digits + j*digits_per_word + bit_magic::i1BP(m, k)/bits_per_level;
+                k -= cnt;
+            }
+        }
+
+        void set_digit(size_type p, uint64_t d) {
+            size_type r = p%block_digits;
+            m_data[(p/block_digits)*block_words + counter_words + r/digits_per_word] |= d << ((r%digits_per_word)*bits_per_level);
+        }
+
+        // maps the symbols which occur to codes, calculates the node boundaries and allocates the blocks
+        void construct_alphabet_and_nodes(const size_type* C) {
+            m_sigma = 0;
+            for (size_type c=0; c < 256; ++c) {
+                m_code2char[c] = 0;
+                if (C[c] > 0) {
+                    m_char2code[c] = m_sigma;
+                    m_code2char[m_sigma++] = c;
+                } else {
+                    m_char2code[c] = _undef_node;
+                }
+            }
+            uint32_t bits = 0;
+            while ((1ULL<<bits) < m_sigma)
+                ++bits;
+            m_levels = std::max((uint32_t)1, (bits + bits_per_level - 1)/bits_per_level);
+            size_type nodes = 0;
+            for (size_type k=0, level_nodes=1; k < m_levels; ++k, level_nodes *= degree)
+                nodes += level_nodes;
+            std::vector<size_type> node_size(nodes, 0);
+            for (size_type code=0; code < m_sigma; ++code) {
+                for (size_type k=0, v=0; k < m_levels; ++k) {
+                    node_size[v] += C[m_code2char[code]];
+                    v = v*degree + 1 + ((code >> ((m_levels-1-k)*bits_per_level)) & (degree-1));
+                }
+            }
+            // the nodes of a level are numbered in the order of their prefixes
+            m_node_start = int_vector<64>(nodes, 0);
+            size_type pos = 0;
+            for (size_type v=0; v < nodes; ++v) {
+                m_node_start[v] = pos;
+                pos += node_size[v];
+            }
+            m_data = int_vector<64>((pos/block_digits + 1)*block_words, 0); // one block more for rank queries at the end
+        }
+
+        // appends the digits of symbol c to the nodes on its path
+        void insert_char(unsigned char c, size_type* cursor) {
+            uint64_t code = m_char2code[c];
+            for (size_type k=0, v=0; k < m_levels; ++k) {
+                uint64_t d = (code >> ((m_levels-1-k)*bits_per_level)) & (degree-1);
+                set_digit(cursor[v]++, d);
+                v = v*degree + 1 + d;
+            }
+        }
+
+        // calculates the counters of the blocks and superblocks and the node ranks
+        void construct_counters() {
+            size_type blocks = m_data.size()/block_words, n = m_levels*m_size;
+            m_sb_rank = int_vector<64>(((blocks + superblock_blocks - 1)/superblock_blocks)*degree, 0);
+            std::vector<size_type> cnt(degree, 0), sb_cnt(degree, 0);
+            for (size_type blk=0; blk < blocks; ++blk) {
+                if (blk % superblock_blocks == 0) {
+                    for (size_type d=0; d < degree; ++d)
+                        m_sb_rank[(blk/superblock_blocks)*degree + d] = sb_cnt[d] = cnt[d];
+                }
+                for (size_type d=0; d < degree; ++d)
+                    m_data[blk*block_words + d/4] |= ((uint64_t)(cnt[d]-sb_cnt[d])) << ((d%4)*16);
+                size_type digits = std::min((size_type)block_digits, n - std::min(n, blk*block_digits));
+                for (size_type j=0; j*digits_per_word < digits; ++j) {
+                    uint64_t w = m_data[blk*block_words + counter_words + j];
+                    uint64_t mask = bit_magic::Li1Mask[std::min((size_type)digits_per_word, digits - j*digits_per_word)*bits_per_level];
+                    for (size_type d=0; d < degree; ++d)
+                        cnt[d] += bit_magic::b1Cnt(digit_matches(w, d) & mask);
+                }
+            }
+            m_node_rank = int_vector<64>(m_node_start.size()*degree, 0);
+            for (size_type v=0; v < m_node_start.size(); ++v) {
+                for (size_type d=0; d < degree; ++d)
+                    m_node_rank[v*degree + d] = digit_rank(m_node_start[v], d);
+            }
+        }
+
+        void clear() {
+            m_sigma = 0;
+            m_levels = 0;
+            util::clear(m_data);
+            util::clear(m_sb_rank);
+            util::clear(m_node_start);
+            util::clear(m_node_rank);
+            for (size_type c=0; c < 256; ++c) {
+                m_char2code[c] = _undef_node;
+                m_code2char[c] = 0;
+            }
+        }
+
+    public:
+
+        const size_type& sigma;
+
+        // Default constructor
+        wt_multiary():m_size(0), m_sigma(0), m_levels(0), sigma(m_sigma) {
+            clear();
+        };
+
+        //! Constructor
+        /*!
+         *	\param rac Reference to the vector (or unsigned char array) for which the wavelet tree should be build.
+         *	\param size Size of the prefix of the vector (or unsigned char array) for which the wavelet tree should be build.
+         *	\par Time complexity
+         *		\f$ \Order{n\log|\Sigma|/bits\_per\_level}\f$, where \f$n=size\f$
+         */
+        template<typename RandomAccessContainer>
+        wt_multiary(const RandomAccessContainer& rac, size_type size):m_size(size), m_sigma(0), m_levels(0), sigma(m_sigma) {
+            construct(rac, size);
+        }
+
+        template<uint8_t w>
+        wt_multiary(const int_vector<w>& rac):m_size(rac.size()), m_sigma(0), m_levels(0), sigma(m_sigma) {
+            construct(rac, rac.size());
+        }
+
+        //! Construct the wavelet tree from a random access container
+        /*! \param rac     Reference to the vector (or unsigned char array) for which the wavelet tree should be build.
+         *	\param size    Size of the prefix of the vector (or unsigned char array) for which the wavelet tree should be build.
+         */
+        template<typename RandomAccessContainer>
+        void construct(const RandomAccessContainer& rac, size_type size) {
+            clear();
+            m_size = size;
+            if (m_size == 0)
+                return;
+            size_type C[256] = {0};
+            for (size_type i=0; i < size; ++i) {
+                ++C[(unsigned char)rac[i]];
+            }
+            construct_alphabet_and_nodes(C);
+            std::vector<size_type> cursor(m_node_start.begin(), m_node_start.end());
+            for (size_type i=0; i < size; ++i) {
+                insert_char(rac[i], &cursor[0]);
+            }
+            construct_counters();
+        }
+
+        template<class size_type_class>
+        wt_multiary(int_vector_file_buffer<8, size_type_class>& rac, size_type size):m_size(size), m_sigma(0), m_levels(0), sigma(m_sigma) {
+            construct(rac, size);
+        }
+
+        //! Construct the wavelet tree from a random access container
+        /*! \param rac A random access container
+         *	\param size The length of the prefix of the random access container, for which the wavelet tree should be build
+         */
+        template<class size_type_class>
+        void construct(int_vector_file_buffer<8, size_type_class>& rac, size_type size) {
+            clear();
+            m_size = size;
+            if (m_size == 0)
+                return;
+            size_type C[256] = {0};
+            calculate_character_occurences(rac, m_size, C);
+            construct_alphabet_and_nodes(C);
+            std::vector<size_type> cursor(m_node_start.begin(), m_node_start.end());
+            rac.reset();
+            for (size_type i=0, r_sum=0, r = rac.load_next_block(); r_sum < m_size;) {
+                if (r_sum + r > size) {  // read not more than size chars in the next loop
+                    r = size-r_sum;
+                }
+                for (; i < r_sum+r; ++i) {
+                    insert_char(rac[i-r_sum], &cursor[0]);
+                }
+                r_sum += r; r = rac.load_next_block();
+            }
+            construct_counters();
+        }
+
+        //! Copy constructor
+        wt_multiary(const wt_multiary& wt):sigma(m_sigma) {
+            copy(wt);
+        }
+
+        //! Assignment operator
+        wt_multiary& operator=(const wt_multiary& wt) {
+            if (this != &wt) {
+                copy(wt);
+            }
+            return *this;
+        }
+
+        //! Swap operator
+        void swap(wt_multiary& wt) {
+            if (this != &wt) {
+                std::swap(m_size, wt.m_size);
+                std::swap(m_sigma,  wt.m_sigma);
+                std::swap(m_levels, wt.m_levels);
+                m_data.swap(wt.m_data);
+                m_sb_rank.swap(wt.m_sb_rank);
+                m_node_start.swap(wt.m_node_start);
+                m_node_rank.swap(wt.m_node_rank);
+                for (size_type i=0; i<256; ++i) {
+                    std::swap(m_char2code[i], wt.m_char2code[i]);
+                    std::swap(m_code2char[i], wt.m_code2char[i]);
+                }
+            }
+        }
+
+        //! Returns the size of the original vector.
+        size_type size()const {
+            return m_size;
+        }
+
+        //! Returns whether the wavelet tree contains no data.
+        bool empty()const {
+            return m_size == 0;
+        }
+
+        //! Recovers the ith symbol of the original vector.
+        /*! \param i The index of the symbol in the original vector. \f$i \in [0..size()-1]\f$
+         *	\return The ith symbol of the original vector.
+         *  \par Time complexity
+         *		\f$ \Order{\log|\Sigma|/bits\_per\_level} \f$
+         */
+        value_type operator[](size_type i)const {
+            value_type c;
+            rank_ith_symbol(i, c);
+            return c;
+        };
+
+        //! Calculates how many symbols c are in the prefix [0..i-1] of the supported vector.
+        /*!
+         *  \param i The exclusive index of the prefix range [0..i-1], so \f$i\in[0..size()]\f$.
+         *  \param c The symbol to count the occurrences in the prefix.
+         *	\return The number of occurrences of symbol c in the prefix [0..i-1] of the supported vector.
+         *  \par Time complexity
+         *		\f$ \Order{\log|\Sigma|/bits\_per\_level} \f$
+         */
+        size_type rank(size_type i, value_type c)const {
+            if (m_char2code[c] == _undef_node)
+                return 0;
+            uint64_t code = m_char2code[c];
+            for (size_type k=0, v=0; k < m_levels and i; ++k) {
+                uint64_t d = (code >> ((m_levels-1-k)*bits_per_level)) & (degree-1);
+                i = digit_rank(m_node_start[v] + i, d) - m_node_rank[v*degree + d];
+                v = v*degree + 1 + d;
+            }
+            return i;
+        };
+
+        //! Calculates how many occurrences of symbol wt[i] are in the prefix [0..i-1] of the original sequence.
+        /*!
+         *	\param i The index of the symbol.
+         *  \param c Reference that will contain symbol wt[i].
+         *  \return The number of occurrences of symbol wt[i] in the prefix [0..i-1]
+         *	\par Time complexity
+         *		\f$ \Order{\log|\Sigma|/bits\_per\_level} \f$
+         */
+        size_type rank_ith_symbol(size_type i, value_type& c)const {
+            assert(i < size());
+            size_type v = 0;
+            for (size_type k=0; k < m_levels; ++k) {
+                uint64_t d;
+                i = digit_access_rank(m_node_start[v] + i, d) - m_node_rank[v*degree + d];
+                v = v*degree + 1 + d;
+            }
+            c = m_code2char[v - m_node_start.size()];
+            return i;
+        }
+
+        //! Answers n rank_ith_symbol queries.
+        /*!
+         *  \param idx  Array of the n query positions.
+         *  \param n    Number of queries.
+         *  \param rank Array of size n; rank[k] is set to rank_ith_symbol(idx[k], c[k]).
+         *  \param c    Array of size n; c[k] is set to the symbol at position idx[k].
+         *  The queries traverse the tree level by level and the block of the query
+         *  SDSL_PREFETCH_DISTANCE positions ahead is prefetched while a query is answered.
+         */
+        void rank_ith_symbol(const size_type* idx, size_type n, size_type* rank, value_type* c)const {
+            std::vector<size_type> node(n, 0);
+            for (size_type k=0; k < n; ++k) {
+                assert(idx[k] < size());
+                rank[k] = idx[k];
+            }
+            for (size_type l=0; l < m_levels; ++l) {
+                for (size_type k=0; k < n; ++k) {
+                    if (k + SDSL_PREFETCH_DISTANCE < n) {
+                        size_type p = m_node_start[node[k+SDSL_PREFETCH_DISTANCE]] + rank[k+SDSL_PREFETCH_DISTANCE];
+                        const uint64_t* b = m_data.data() + (p/block_digits)*block_words;
+                        SDSL_PREFETCH(b);
+                        SDSL_PREFETCH(b + counter_words + (p%block_digits)/digits_per_word);
+                    }
+                    uint64_t d;
+                    size_type v = node[k];
+                    rank[k] = digit_access_rank(m_node_start[v] + rank[k], d) - m_node_rank[v*degree + d];
+                    node[k] = v*degree + 1 + d;
+                }
+            }
+            for (size_type k=0; k < n; ++k) {
+                c[k] = m_code2char[node[k] - m_node_start.size()];
+            }
+        }
+
+        //! Calculates the ith occurrence of the symbol c in the supported vector.
+        /*!
+         *  \param i The ith occurrence. \f$i\in [1..rank(size(),c)]\f$.
+         *  \param c The symbol c.
+         *  \par Time complexity
+         *		\f$ \Order{\log n\log|\Sigma|/bits\_per\_level} \f$
+         */
+        size_type select(size_type i, value_type c)const {
+            if (m_char2code[c] == _undef_node) { // if c was not present in the original text
+                return m_size;		             // -> return a position right to the end
+            }
+            uint64_t code = m_char2code[c];
+            size_type v = 0;
+            for (size_type k=0; k < m_levels; ++k) { // find the leaf of c
+                v = v*degree + 1 + ((code >> ((m_levels-1-k)*bits_per_level)) & (degree-1));
+            }
+            size_type j = i-1; // position in the current node
+            while (v != 0) {
+                size_type parent = (v-1)/degree;
+                uint64_t d = (v-1)%degree;
+                j = digit_select(m_node_rank[parent*degree + d] + j + 1, d) - m_node_start[parent];
+                v = parent;
+            }
+            return j;
+        };
+
+        //! Serializes the data structure into the given ostream
+        size_type serialize(std::ostream& out, structure_tree_node* v=NULL, std::string name="")const {
+            structure_tree_node* child = structure_tree::add_child(v, name, util::class_name(*this));
+            size_type written_bytes = 0;
+            written_bytes += util::write_member(m_size, out, child, "size");
+            written_bytes += util::write_member(m_sigma, out, child, "sigma");
+            written_bytes += util::write_member(m_levels, out, child, "levels");
+            written_bytes += m_data.serialize(out, child, "data");
+            written_bytes += m_sb_rank.serialize(out, child, "superblock_rank");
+            written_bytes += m_node_start.serialize(out, child, "node_start");
+            written_bytes += m_node_rank.serialize(out, child, "node_rank");
+            out.write((char*) m_char2code, 256*sizeof(m_char2code[0]));
+            written_bytes += 256*sizeof(m_char2code[0]);
+            out.write((char*) m_code2char, 256*sizeof(m_code2char[0]));
+            written_bytes += 256*sizeof(m_code2char[0]);
+            structure_tree::add_size(child, written_bytes);
+            return written_bytes;
+        }
+
+        //! Loads the data structure from the given istream.
+        void load(std::istream& in) {
+            util::read_member(m_size, in);
+            util::read_member(m_sigma, in);
+            util::read_member(m_levels, in);
+            m_data.load(in);
+            m_sb_rank.load(in);
+            m_node_start.load(in);
+            m_node_rank.load(in);
+            in.read((char*) m_char2code, 256*sizeof(m_char2code[0]));
+            in.read((char*) m_code2char, 256*sizeof(m_code2char[0]));
+        }
+};
+
+}// end namespace sdsl
+
+#endif // end file
@@ -324,15 +324,10 @@ class wt_rlmn
                 return 0;
             }
             size_type wt_ex_pos = m_bl_rank(i+1);
+            // position i lies in the run wt_ex_pos-1, which is a run of c=m_wt[wt_ex_pos-1]
             size_type c_runs = m_wt.rank_ith_symbol(wt_ex_pos-1, c)+1;
-            if (c_runs == 0)
-                return 0;
-            if (m_wt[wt_ex_pos-1] == c) {
-                size_type c_run_begin = m_bl_select(wt_ex_pos);
-                return m_bf_select(m_C_bf_rank[c] + c_runs) - m_C[c] + i - c_run_begin;
-            } else {
-                return m_bf_select(m_C_bf_rank[c] + c_runs + 1) - m_C[c];
-            }
+            size_type c_run_begin = m_bl_select(wt_ex_pos);
+            return m_bf_select(m_C_bf_rank[c] + c_runs) - m_C[c] + i - c_run_begin;
         }
 
         //! Calculates the ith occurence of the symbol c in the supported vector.
@@ -1,4 +1,8 @@
 #include "sdsl/algorithms_for_suffix_array_construction.hpp"
+#include "sdsl/parallel.hpp"
+#include <vector>
+#include <utility>   // for std::pair
+#include <algorithm> // for std::sort
 
 namespace sdsl
 {
@@ -40,6 +44,254 @@ bool shift_text(char* c, uint64_t n, bool shift)
     return true;
 }
 
+// Parallel prefix doubling
+//
+// Invariant after the round with prefix length h: sa is sorted by the first h
+// characters of the suffixes and rank[i] equals 1 + the first position in sa of
+// the group of suffixes which share the first h characters with suffix i.
+// Each round sorts the unsorted groups by rank[i+h] (0 if i+h >= n). The groups
+// are independent and are distributed between the threads. The initial groups
+// are built by a parallel bucket sort on the first characters.
+
+namespace
+{
+
+const uint64_t PSA_BUCKET_BITS = 16;
+
+// The initial key of a suffix packs its first chars characters with bits bits
+// each. Characters are mapped to 1..sigma, 0 marks the end of the text, so the
+// end of the text is smaller than every character.
+struct psa_alphabet {
+    uint64_t map[256];
+    uint64_t bits, chars;
+    void init(const unsigned char* c, uint64_t n) {
+        for (int k=0; k < 256; ++k) map[k] = 0;
+        for (uint64_t i=0; i < n; ++i) map[c[i]] = 1;
+        uint64_t sigma = 0;
+        for (int k=0; k < 256; ++k)
+            if (map[k]) map[k] = ++sigma;
+        bits  = bit_magic::l1BP(sigma)+1;
+        chars = 64/bits;
+    }
+    uint64_t key(const unsigned char* c, uint64_t n, uint64_t i)const {
+        uint64_t key = 0;
+        for (uint64_t k=0; k < chars; ++k) {
+            key = (key << bits) | (i+k < n ? map[c[i+k]] : 0);
+        }
+        return key;
+    }
+    // key of suffix i+1, given the key of suffix i
+    uint64_t next_key(const unsigned char* c, uint64_t n, uint64_t i, uint64_t key)const {
+        key = (key << bits) & bit_magic::Li1Mask[bits*chars];
+        return key | (i+chars < n ? map[c[i+chars]] : 0);
+    }
+    uint64_t bucket(uint64_t key)const {
+        return key >> (bits*chars-PSA_BUCKET_BITS);
+    }
+};
+template<class I>
+struct psa_group {
+    I start, len;
+    psa_group(I s=0, I l=0):start(s), len(l) {}
+};
+
+template<class I>
+struct psa_shared {
+    const unsigned char* c;
+    psa_alphabet alpha;
+    I n;
+    I* sa;
+    I* rank;
+    I* next_rank;   // new rank of sa[j] computed in the sort phase
+    I h;
+    uint32_t threads;
+    std::vector<uint64_t> hist; // histogram of the buckets; bucket-major, thread-minor
+    std::vector<psa_group<I> > groups;
+    volatile uint64_t next_group;
+    uint64_t block;  // number of groups a thread takes at once
+};
+
+// Phase 1 of the bucket sort: count the bucket sizes in a part of the text
+// Phase 2: scatter the positions of the part into their buckets
+template<class I>
+struct psa_bucket_task {
+    psa_shared<I>* sh;
+    uint32_t id;
+    bool scatter;
+    void operator()() {
+        const uint64_t B = 1ULL << PSA_BUCKET_BITS;
+        uint64_t begin = parallel::part_begin(sh->n, sh->threads, id);
+        uint64_t end   = parallel::part_begin(sh->n, sh->threads, id+1);
+        if (begin == end)
+            return;
+        const psa_alphabet& a = sh->alpha;
+        uint64_t key = a.key(sh->c, sh->n, begin);
+        if (!scatter) {
+            for (uint64_t b=0; b < B; ++b) sh->hist[b*sh->threads + id] = 0;
+            for (uint64_t i=begin; i < end; key = a.next_key(sh->c, sh->n, i, key), ++i) {
+                ++sh->hist[a.bucket(key)*sh->threads + id];
+            }
+        } else {
+            std::vector<uint64_t> pos(B);
+            for (uint64_t b=0; b < B; ++b) pos[b] = sh->hist[b*sh->threads + id];
+            for (uint64_t i=begin; i < end; key = a.next_key(sh->c, sh->n, i, key), ++i) {
+                sh->sa[pos[a.bucket(key)]++] = i;
+            }
+        }
+    }
+};
+
+// Sorts the groups in sh->groups. For the initial round the groups are the buckets and
+// the key is the packed prefix of the suffix, afterwards the key is rank[i+h].
+// The new ranks are written to next_rank, as rank is read by other threads.
+template<class I>
+struct psa_sort_task {
+    psa_shared<I>* sh;
+    bool initial;
+    void operator()() {
+        std::vector<std::pair<uint64_t, I> > tmp;
+        const uint64_t groups = sh->groups.size();
+        uint64_t g;
+        while ((g = parallel::fetch_and_add(sh->next_group, sh->block)) < groups) {
+            for (uint64_t ge = std::min(g+sh->block, groups); g < ge; ++g) {
+                const I start = sh->groups[g].start, len = sh->groups[g].len;
+                I* sa = sh->sa + start;
+                tmp.resize(len);
+                for (I j=0; j < len; ++j) {
+                    I i = sa[j];
+                    if (initial)
+                        tmp[j].first = sh->alpha.key(sh->c, sh->n, i);
+                    else
+                        tmp[j].first = (i + sh->h < sh->n) ? sh->rank[i + sh->h] : 0;
+                    tmp[j].second = i;
+                }
+                std::sort(tmp.begin(), tmp.end());
+                I r = start+1;
+                for (I j=0; j < len; ++j) {
+                    if (j > 0 and tmp[j].first != tmp[j-1].first)
+                        r = start+j+1;
+                    sa[j] = tmp[j].second;
+                    sh->next_rank[start+j] = r;
+                }
+            }
+        }
+    }
+};
+
+// Copies the new ranks into rank and collects the groups which are still unsorted
+template<class I>
+struct psa_rank_task {
+    psa_shared<I>* sh;
+    std::vector<psa_group<I> > unsorted;
+    void operator()() {
+        const uint64_t groups = sh->groups.size();
+        uint64_t g;
+        unsorted.clear();
+        while ((g = parallel::fetch_and_add(sh->next_group, sh->block)) < groups) {
+            for (uint64_t ge = std::min(g+sh->block, groups); g < ge; ++g) {
+                const I start = sh->groups[g].start, end = start + sh->groups[g].len;
+                for (I j=start; j < end; ++j) {
+                    sh->rank[sh->sa[j]] = sh->next_rank[j];
+                }
+                for (I j=start; j < end;) {
+                    I k = j+1;
+                    while (k < end and sh->next_rank[k] == sh->next_rank[j])
+                        ++k;
+                    if (k-j > 1)
+                        unsorted.push_back(psa_group<I>(j, k-j));
+                    j = k;
+                }
+            }
+        }
+    }
+};
+
+template<class I>
+void psa_run_groups(psa_shared<I>& sh, bool initial)
+{
+    sh.block = std::max((uint64_t)1, (uint64_t)sh.groups.size()/(64*sh.threads));
+    std::vector<psa_sort_task<I> > sort_tasks(sh.threads);
+    for (uint32_t t=0; t < sh.threads; ++t) {
+        sort_tasks[t].sh = &sh;
+        sort_tasks[t].initial = initial;
+    }
+    sh.next_group = 0;
+    parallel::run(sort_tasks);
+
+    std::vector<psa_rank_task<I> > rank_tasks(sh.threads);
+    for (uint32_t t=0; t < sh.threads; ++t) {
+        rank_tasks[t].sh = &sh;
+    }
+    sh.next_group = 0;
+    parallel::run(rank_tasks);
+    sh.groups.clear();
+    for (uint32_t t=0; t < sh.threads; ++t) {
+        sh.groups.insert(sh.groups.end(), rank_tasks[t].unsorted.begin(), rank_tasks[t].unsorted.end());
+    }
+}
+
+template<class I>
+void psa_calculate(const unsigned char* c, I n, I* sa, uint32_t threads)
+{
+    if (n == 0)
+        return;
+    if (threads == 0)
+        threads = 1;
+    psa_shared<I> sh;
+    sh.c = c; sh.n = n; sh.sa = sa; sh.threads = threads;
+    sh.alpha.init(c, n);
+    std::vector<I> rank(n), next_rank(n);
+    sh.rank = &rank[0];
+    sh.next_rank = &next_rank[0];
+
+    // (1) bucket sort by the first characters
+    const uint64_t B = 1ULL << PSA_BUCKET_BITS;
+    sh.hist.resize(B*threads);
+    std::vector<psa_bucket_task<I> > bucket_tasks(threads);
+    for (uint32_t t=0; t < threads; ++t) {
+        bucket_tasks[t].sh = &sh;
+        bucket_tasks[t].id = t;
+        bucket_tasks[t].scatter = false;
+    }
+    parallel::run(bucket_tasks);
+    uint64_t sum = 0;
+    for (uint64_t b=0; b < B; ++b) {
+        uint64_t bucket_begin = sum;
+        for (uint32_t t=0; t < threads; ++t) {
+            uint64_t cnt = sh.hist[b*threads + t];
+            sh.hist[b*threads + t] = sum;
+            sum += cnt;
+        }
+        if (sum > bucket_begin)
+            sh.groups.push_back(psa_group<I>(bucket_begin, sum - bucket_begin));
+    }
+    for (uint32_t t=0; t < threads; ++t) {
+        bucket_tasks[t].scatter = true;
+    }
+    parallel::run(bucket_tasks);
+    std::vector<uint64_t>().swap(sh.hist);
+
+    // (2) sort the buckets by the first alpha.chars characters
+    psa_run_groups(sh, true);
+
+    // (3) prefix doubling on the unsorted groups
+    for (sh.h = sh.alpha.chars; !sh.groups.empty(); sh.h *= 2) {
+        psa_run_groups(sh, false);
+    }
+}
+
+} // end anonymous namespace
+
+void _calcSuffixArrayParallel(const unsigned char* c, uint32_t n, uint32_t* sa, uint32_t threads)
+{
+    psa_calculate(c, n, sa, threads);
+}
+
+void _calcSuffixArrayParallel(const unsigned char* c, uint64_t n, uint64_t* sa, uint32_t threads)
+{
+    psa_calculate(c, n, sa, threads);
+}
+
 } // end namespace algorithm
 
 } // end namespace sdsl
@@ -15,10 +15,137 @@
     along with this program.  If not, see http://www.gnu.org/licenses/ .
 */
 #include "sdsl/bitmagic.hpp"
+#ifdef SDSL_CPU_DISPATCH
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
 
 namespace sdsl
 {
 
+bool bit_magic::cpu_popcnt = false;
+bool bit_magic::cpu_bmi2 = false;
+bool bit_magic::cpu_avx2 = false;
+
+// Detect the CPU features once when the library is loaded. Calls of
+// bit_magic methods during the static initialization of other translation
+// units use the portable implementations, as all flags are false until then.
+static class cpu_detector
+{
+    public:
+        cpu_detector() {
+            bit_magic::detect_cpu();
+        }
+} detector;
+
+bool bit_magic::detect_cpu()
+{
+#ifdef SDSL_CPU_DISPATCH
+    uint32_t eax, ebx, ecx, edx;
+    if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx))
+        return false;
+    uint32_t max_leaf = eax;
+    bool amd = (ebx == 0x68747541); // "Auth"enticAMD
+    __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+    uint32_t family = (eax >> 8) & 0xF;
+    if (family == 0xF)
+        family += (eax >> 20) & 0xFF;
+    cpu_popcnt = (ecx >> 23) & 1;
+    bool os_avx = ((ecx >> 27) & 1) and ((ecx >> 28) & 1); // osxsave and avx
+    if (os_avx) {
+        uint32_t xcr0_lo, xcr0_hi;
+        __asm__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+        os_avx = (xcr0_lo & 6) == 6; // the OS saves the xmm and ymm registers
+    }
+    if (max_leaf >= 7) {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        // pdep is microcoded and very slow on AMD CPUs before Zen 3 (family 0x19)
+        cpu_bmi2 = ((ebx >> 8) & 1) and !(amd and family < 0x19);
+        cpu_avx2 = ((ebx >> 5) & 1) and os_avx;
+    }
+#endif
+    return true;
+}
+
+#ifdef SDSL_CPU_DISPATCH
+__attribute__((target("popcnt")))
+static uint64_t b1Cnt_popcnt(const uint64_t* data, uint64_t n)
+{
+    uint64_t res = 0;
+    for (uint64_t i=0; i < n; ++i)
+        res += __builtin_popcountll(data[i]);
+    return res;
+}
+
+// Nibble lookup with vpshufb, summed up with vpsadbw; see
+// Mula, Kurz, Lemire: Faster Population Counts Using AVX2 Instructions.
+__attribute__((target("avx2,popcnt")))
+static uint64_t b1Cnt_avx2(const uint64_t* data, uint64_t n)
+{
+    const __m256i lookup = _mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4,
+                                            0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0F);
+    __m256i acc = _mm256_setzero_si256();
+    uint64_t i = 0;
+    for (; i+4 <= n; i += 4) {
+        __m256i v  = _mm256_loadu_si256((const __m256i*)(data+i));
+        __m256i lo = _mm256_and_si256(v, low_mask);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+        __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                      _mm256_shuffle_epi8(lookup, hi));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, _mm256_setzero_si256()));
+    }
+    uint64_t res = (uint64_t)_mm256_extract_epi64(acc, 0) + (uint64_t)_mm256_extract_epi64(acc, 1)
+                   + (uint64_t)_mm256_extract_epi64(acc, 2) + (uint64_t)_mm256_extract_epi64(acc, 3);
+    for (; i < n; ++i)
+        res += __builtin_popcountll(data[i]);
+    return res;
+}
+#endif
+
+static uint64_t b1Cnt_portable(const uint64_t* data, uint64_t n)
+{
+    uint64_t res = 0;
+    for (uint64_t i=0; i < n; ++i)
+        res += bit_magic::b1Cnt(data[i]);
+    return res;
+}
+
+#ifdef SDSL_CPU_DISPATCH
+// Uses the AVX2 variant only for arrays which fill at least two vectors.
+static uint64_t b1Cnt_avx2_or_popcnt(const uint64_t* data, uint64_t n)
+{
+    return n >= 8 ? b1Cnt_avx2(data, n) : b1Cnt_popcnt(data, n);
+}
+#endif
+
+typedef uint64_t (*b1Cnt_bulk_type)(const uint64_t*, uint64_t);
+
+static uint64_t b1Cnt_resolve(const uint64_t* data, uint64_t n);
+
+// The bulk variant for this CPU. The pointer is constant initialized with the
+// resolver, so that it is valid before the static initialization of the library.
+static b1Cnt_bulk_type b1Cnt_bulk = b1Cnt_resolve;
+
+static uint64_t b1Cnt_resolve(const uint64_t* data, uint64_t n)
+{
+    bit_magic::detect_cpu(); // the detector of this unit may not have run yet
+    b1Cnt_bulk_type f = b1Cnt_portable;
+#ifdef SDSL_CPU_DISPATCH
+    if (bit_magic::cpu_avx2 and bit_magic::cpu_popcnt)
+        f = b1Cnt_avx2_or_popcnt;
+    else if (bit_magic::cpu_popcnt)
+        f = b1Cnt_popcnt;
+#endif
+    b1Cnt_bulk = f; // all threads store the same value
+    return f(data, n);
+}
+
+uint64_t bit_magic::b1Cnt(const uint64_t* data, uint64_t n)
+{
+    return b1Cnt_bulk(data, n);
+}
+
 const uint8_t bit_magic::B1CntBytes[] = {
     0, 1, 1, 2, 1, 2, 2, 3,
     1, 2, 2, 3, 2, 3, 3, 4,
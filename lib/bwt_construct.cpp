@@ -19,9 +19,12 @@
 	\author Simon Gog
 */
 #include "sdsl/bwt_construct.hpp"
+#include "sdsl/algorithms.hpp" // for _calcSuffixArrayDC3
+#include "sdsl/wt_huff.hpp"
 #include <string>
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 
 
 namespace sdsl
@@ -173,6 +176,155 @@ bool construct_bwt2(tMSS& file_map, const std::string& dir, const std::string& i
 }
 
 
+namespace
+{
+
+// Compares positions d of a block by the pair (char at d, key of the suffix at d+1)
+template<class I>
+class bwt_pair_less
+{
+        const unsigned char* m_text; // characters of the block
+        const uint64_t*      m_key;  // m_key[d] = key of the suffix which starts at block position d
+    public:
+        bwt_pair_less(const unsigned char* text, const uint64_t* key):m_text(text), m_key(key) {}
+
+        bool operator()(I a, I b)const {
+            if (m_text[a] != m_text[b])
+                return m_text[a] < m_text[b];
+            return m_key[a+1] < m_key[b+1];
+        }
+};
+
+// Reads the characters text[a..e-1] of the serialized int_vector<8> in
+void read_text_block(std::ifstream& in, uint64_t a, uint64_t e, unsigned char* buf)
+{
+    in.seekg(sizeof(uint64_t)+a, std::ios::beg); // skip the size of the int_vector<8>
+    if (!in.read((char*)buf, e-a)) {
+        throw std::ios_base::failure("construct_bwt_blockwise: Cannot read text from file system!");
+    }
+}
+
+template<class I>
+void bwt_blockwise(std::ifstream& text_in, uint64_t n, uint64_t block_size, int_vector<8>& bwt)
+{
+    typedef int_vector<>::size_type size_type;
+    unsigned char* text = new unsigned char[block_size];
+    uint64_t*      key  = new uint64_t[block_size+1];        // key of the suffixes in the block and the following one
+    I*             s    = new I[block_size+3];
+    I*             sa   = new I[block_size];
+    size_type      cnt[256] = {0}; // number of processed suffixes starting with a character
+    size_type      C[256]   = {0}; // number of processed suffixes starting with a smaller character
+    size_type      m = 0;          // number of processed suffixes, they start at n-m
+    size_type      R = 0;          // BWT row of the suffix n-m among the processed suffixes
+
+    for (size_type e = n; e > 0;) {
+        size_type js = ((e-1)/block_size)*block_size; // block [js..e-1]
+        size_type b  = e-js;
+        read_text_block(text_in, js, e, text);
+        const unsigned char* t = text;
+        // key[d] = 2*(number of processed suffixes smaller than suffix js+d), key[b] = 2*R+1;
+        // a suffix of the block is smaller than suffix e iff its key is smaller
+        key[b] = 2*R+1;
+        if (m == 0) {
+            for (size_type d=0; d < b; ++d) key[d] = 0;
+        } else {
+            wt_huff<> wt((const unsigned char*)bwt.data()+(n-m), m);
+            for (size_type d=b, p=R; d > 0; --d) {
+                unsigned char c = t[d-1];
+                p = C[c] + wt.rank(p, c);
+                key[d-1] = 2*p;
+            }
+        }
+        // sort the suffixes of the block by the strings of pairs (t[d], key[d+1]),
+        // the pairs are renamed to 1..names
+        for (size_type d=0; d < b; ++d) sa[d] = d;
+        std::sort(sa, sa+b, bwt_pair_less<I>(t, key));
+        I names = 0;
+        for (size_type k=0; k < b; ++k) {
+            if (k == 0 or t[sa[k]] != t[sa[k-1]] or key[sa[k]+1] != key[sa[k-1]+1])
+                ++names;
+            s[sa[k]] = names;
+        }
+        s[b] = s[b+1] = s[b+2] = 0;
+        if (names < b)
+            algorithm::_calcSuffixArrayDC3(s, sa, (I)b, names);
+        else
+            for (size_type d=0; d < b; ++d) sa[s[d]-1] = d;
+        // merge the suffixes of the block into the BWT of the processed suffixes. The
+        // processed BWT is stored in bwt[n-m..n-1], the result in bwt[n-m-b..n-1]
+        if (m > 0)
+            bwt[n-m+R] = t[b-1]; // the character before suffix e is now known
+        size_type o = n-m-b, oi = n-m;
+        for (size_type k=0; k < b; ++k) {
+            size_type d = sa[k];
+            for (size_type old_end = n-m+key[d]/2; oi < old_end;)
+                bwt[o++] = bwt[oi++];
+            if (d == 0)
+                R = o-(n-m-b);
+            // the character before the block is set in the next round; it has to be 0 while
+            // the ranks are calculated. The BWT row of suffix 0 contains text[n-1]=0.
+            bwt[o++] = d ? t[d-1] : 0;
+        }
+        // update the counts for the processed suffixes
+        for (size_type d=0; d < b; ++d) ++cnt[t[d]];
+        for (size_type c=1; c < 256; ++c) C[c] = C[c-1] + cnt[c-1];
+        m += b;
+        e = js;
+    }
+    delete [] text; delete [] key; delete [] s; delete [] sa;
+}
+
+} // end anonymous namespace
+
+/*! Constructs the Burrows and Wheeler Transform (BWT) from the text without the suffix array
+ * \param file_map   A map, which contains the path of the text.
+ * \param dir        Directory in which the result should be written on disk.
+ * \param id         Id which should be used to build a file name for the calculated BWT.
+ * \param block_size Number of suffixes which are sorted at once; if 0, n/16 is used.
+ * \par Space complexity:
+ *        \f$n\f$ bytes for the BWT plus a wavelet tree of it plus about \f$25\cdot block\_size\f$ bytes.
+ */
+bool construct_bwt_blockwise(tMSS& file_map, const std::string& dir, const std::string& id, uint64_t block_size)
+{
+    typedef int_vector<>::size_type size_type;
+    if (file_map.find("bwt") == file_map.end()) { // if bwt is not already registered in file_map
+        std::string bwt_file_name = dir+"bwt_"+id;
+        std::ifstream bwt_in(bwt_file_name.c_str());
+        // check if bwt is already on disk => register it
+        if (bwt_in) {
+            file_map["bwt"] = bwt_file_name;
+            bwt_in.close();
+            return true;
+        }
+        write_R_output("csa", "construct BWT", "begin", 1, 0);
+        size_type n = 0;
+        {
+            int_vector_file_buffer<8> text_buf(file_map["text"].c_str());
+            n = text_buf.int_vector_size;
+        }
+        if (block_size == 0)
+            block_size = std::max(n/16, (size_type)1<<16);
+        block_size = std::min(block_size, std::max(n, (size_type)1));
+
+        std::ifstream text_in(file_map["text"].c_str(), std::ios::binary | std::ios::in);
+        int_vector<8> bwt(n, 0);
+        if (n < 0xFFFFFFFFULL)
+            bwt_blockwise<uint32_t>(text_in, n, block_size, bwt);
+        else
+            bwt_blockwise<uint64_t>(text_in, n, block_size, bwt);
+        text_in.close();
+
+        if (!util::store_to_file(bwt, bwt_file_name.c_str())) {
+            throw std::ios_base::failure("#csa_construct: Cannot store BWT to file system!");
+            return false;
+        }
+        file_map["bwt"] = bwt_file_name;
+        write_R_output("csa", "construct BWT", "end", 1, 0);
+    }
+    return true;
+}
+
+
 /*
 	bool construct_bwt( tMSS &file_map, const std::string &dir, const std::string &id){
 		typedef int_vector<>::size_type size_type;
@@ -328,6 +328,124 @@ bool construct_lcp_PHI(tMSS& file_map, const std::string& dir, const std::string
     return true;
 }
 
+namespace
+{
+
+typedef int_vector<>::size_type size_type;
+
+// Returns the first index of part i of [0..n-1], where the parts start at multiples of 64 so that
+// threads which write to different parts of an int_vector never write to the same 64-bit word.
+size_type aligned_part_begin(size_type n, uint32_t parts, uint32_t i)
+{
+    return std::min(parallel::part_begin((n+63)>>6, parts, i)<<6, n);
+}
+
+// Sets PHI[SA[i]] = SA[i-1] for i in [b..e-1]; PHI has to be initialized with 0.
+struct phi_task {
+    const int_vector<>* sa;
+    int_vector<>* phi;
+    size_type b, e;
+
+    void operator()() {
+        const uint8_t w = phi->get_int_width();
+        for (size_type i=std::max(b, (size_type)1); i < e; ++i)
+            util::or_bits_atomic(*phi, (*sa)[i]*w, (*sa)[i-1], w);
+    }
+};
+
+// Replaces PHI[i] by PLCP[i] for i in [b..e-1].
+struct plcp_task {
+    const unsigned char* text;
+    int_vector<>* plcp;
+    size_type b, e;
+
+    void operator()() {
+        for (size_type i=b, l=0; i < e; ++i) {
+            size_type phii = (*plcp)[i];
+            while (text[i+l] == text[phii+l]) {
+                ++l;
+            }
+            (*plcp)[i] = l;
+            if (l)
+                --l;
+        }
+    }
+};
+
+// Replaces SA[i] by LCP[i] = PLCP[SA[i]] for i in [b..e-1].
+struct lcp_task {
+    const int_vector<>* plcp;
+    int_vector<>* sa;
+    size_type b, e;
+
+    void operator()() {
+        for (size_type i=b; i < e; ++i)
+            (*sa)[i] = (*plcp)[(*sa)[i]];
+    }
+};
+
+} // end anonymous namespace
+
+bool construct_lcp_PHI_parallel(tMSS& file_map, const std::string& dir, const std::string& id, uint32_t threads)
+{
+    int_vector<> sa;
+    if (!util::load_from_file(sa, file_map["sa"].c_str())) {
+        throw std::ios_base::failure("cst_construct: Cannot load SA from file system!");
+    }
+    size_type n = sa.size();
+    threads = std::min((size_type)threads, (n+63)>>6);
+    if (threads <= 1) {
+        sa.resize(0);
+        return construct_lcp_PHI(file_map, dir, id);
+    }
+    write_R_output("lcp", "construct LCP", "begin", threads, 0);
+    int_vector<> plcp(n, 0, sa.get_int_width());
+    std::vector<phi_task> phi_tasks(threads);
+    for (uint32_t t=0; t < threads; ++t) {
+        phi_tasks[t].sa  = &sa;
+        phi_tasks[t].phi = &plcp;
+        phi_tasks[t].b   = parallel::part_begin(n, threads, t);
+        phi_tasks[t].e   = parallel::part_begin(n, threads, t+1);
+    }
+    parallel::run(phi_tasks);
+
+    write_R_output("lcp", "load text", "begin", 1, 0);
+    unsigned char* text = NULL;
+    int_vector_file_buffer<8> text_buf(file_map["text"].c_str());
+    if (!util::load_from_int_vector_buffer(text, text_buf)) { // load text
+        throw std::ios_base::failure("cst_construct: Cannot load text from file system!");
+    }
+    write_R_output("lcp", "load text", "end", 1, 0);
+
+    std::vector<plcp_task> plcp_tasks(threads);
+    for (uint32_t t=0; t < threads; ++t) {
+        plcp_tasks[t].text = text;
+        plcp_tasks[t].plcp = &plcp;
+        plcp_tasks[t].b    = aligned_part_begin(n, threads, t);
+        plcp_tasks[t].e    = std::min(aligned_part_begin(n, threads, t+1), n-1); // PLCP[n-1]=0
+    }
+    parallel::run(plcp_tasks);
+    delete [] text;
+
+    std::vector<lcp_task> lcp_tasks(threads);
+    for (uint32_t t=0; t < threads; ++t) {
+        lcp_tasks[t].plcp = &plcp;
+        lcp_tasks[t].sa   = &sa;
+        lcp_tasks[t].b    = aligned_part_begin(n, threads, t);
+        lcp_tasks[t].e    = aligned_part_begin(n, threads, t+1);
+    }
+    parallel::run(lcp_tasks);
+    sa[0] = 0;
+
+    if (!util::store_to_file(sa, (dir+"lcp_"+id).c_str())) {
+        throw std::ios_base::failure("cst_construct: Cannot store LCP to file system!");
+        return false;
+    }
+    file_map["lcp"] = dir+"lcp_"+id;
+    write_R_output("lcp", "construct LCP", "end", threads, 0);
+    return true;
+}
+
 buffered_char_queue::buffered_char_queue():m_widx(0), m_ridx(0), m_sync(true), m_disk_buffered_blocks(0), m_c('?'),m_rb(0), m_wb(0) {};
 
 void buffered_char_queue::init(const std::string& dir, char c)
@@ -1,7 +1,14 @@
 #include "sdsl/memory_management.hpp"
 
 #include <cstdlib> // for malloc and free
+#include <cstring> // for memcpy
 #include <sys/mman.h>
+#include <sys/stat.h> // for fstat
+#include <fcntl.h>    // for open
+#include <unistd.h>   // for close and sysconf
+#include <sys/syscall.h> // for mbind and getcpu
+#include <cstdio>  // for sscanf
+#include <fstream> // for reading /proc/self/smaps
 
 #ifdef MAP_HUGETLB
 	#define HUGE_LEN 1073741824 
@@ -9,11 +16,23 @@
 	#define HUGE_FLAGS (MAP_HUGETLB | MAP_ANONYMOUS | MAP_PRIVATE)
 #endif
 
+#define HUGE_PAGE_LEN 2097152 // size of a (transparent) huge page
+#ifndef MPOL_BIND
+	#define MPOL_BIND 2
+#endif
+
 //! Namespace for the succinct data structure library
 namespace sdsl
 {
 	static int nifty_counter;
 	std::map<uint64_t, mm_item_base*> mm::m_items;
+	std::map<uint64_t, mm_region> mm::m_regions;
+	mm_policy_type mm::m_policy = MM_MALLOC;
+	uint64_t mm::m_chunk_size = 67108864; // 64 MiB
+	uint64_t mm::m_arena[MM_MAPPED_FILE] = {0};
+	pthread_mutex_t mm::m_mutex = PTHREAD_MUTEX_INITIALIZER;
+	volatile uint64_t mm::m_region_begin = 0;
+	volatile uint64_t mm::m_region_end = 0;
 	uint64_t mm::m_total_memory;
 	uint64_t *mm::m_data;
 
@@ -31,18 +50,370 @@ namespace sdsl
 		}
 	}
 
+	mm::tMRegion::iterator mm::find_region(const void* addr){
+		if ( !may_be_in_region(addr) )
+			return m_regions.end();
+		tMRegion::iterator it = m_regions.upper_bound((uint64_t)addr);
+		if ( it == m_regions.begin() )
+			return m_regions.end();
+		--it;
+		if ( (uint64_t)addr < it->first + it->second.len )
+			return it;
+		return m_regions.end();
+	}
+
+	bool mm::in_region(const void* addr){
+		if ( !may_be_in_region(addr) )
+			return false;
+		lock_guard lock;
+		return find_region(addr) != m_regions.end();
+	}
+
+	mm_policy_type mm::region_kind(const void* addr){
+		if ( !may_be_in_region(addr) )
+			return MM_MALLOC;
+		lock_guard lock;
+		tMRegion::iterator it = find_region(addr);
+		return it == m_regions.end() ? MM_MALLOC : it->second.kind;
+	}
+
+	void mm::insert_region(uint64_t base, const mm_region& region){
+		m_regions[base] = region;
+		update_region_bounds();
+	}
+
+	void mm::update_region_bounds(){
+		if ( m_regions.empty() ){
+			m_region_begin = m_region_end = 0;
+		}else{
+			tMRegion::const_reverse_iterator last = m_regions.rbegin();
+			// Both intermediate states contain all remaining regions, see may_be_in_region.
+			m_region_begin = m_regions.begin()->first;
+			m_region_end = last->first + last->second.len;
+		}
+	}
+
+	void mm::set_policy(mm_policy_type policy, uint64_t chunk_size){
+		if ( policy >= MM_MAPPED_FILE )
+			throw std::logic_error("mm::set_policy: MM_MAPPED_FILE is not an allocation policy.");
+		lock_guard lock;
+		m_policy = policy;
+		if ( chunk_size > 0 )
+			m_chunk_size = chunk_size;
+		for (int kind = MM_HUGEPAGE; kind < MM_MAPPED_FILE; ++kind){
+			if ( kind != policy )
+				drop_arena((mm_policy_type)kind);
+		}
+	}
+
+	char* mm::map_chunk(uint64_t len, mm_policy_type kind){
+		char* base = (char*)MAP_FAILED;
+		if ( kind == MM_HUGEPAGE ){
+#ifdef MAP_HUGETLB
+			base = (char*)mmap(NULL, len, HUGE_PROTECTION, HUGE_FLAGS, -1, 0);
+#endif
+		}else{
+			uint64_t map_len = kind == MM_THP ? len+HUGE_PAGE_LEN : len;
+			base = (char*)mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+			if ( base != MAP_FAILED and kind == MM_THP ){ 
+				// trim the mapping to a 2 MiB aligned range 
+				char* aligned = base + (HUGE_PAGE_LEN - ((uint64_t)base % HUGE_PAGE_LEN)) % HUGE_PAGE_LEN;
+				if ( aligned > base )
+					munmap(base, aligned-base);
+				if ( base+map_len > aligned+len )
+					munmap(aligned+len, (base+map_len)-(aligned+len));
+				base = aligned;
+#ifdef MADV_HUGEPAGE
+				madvise(base, len, MADV_HUGEPAGE);
+#endif
+			}
+			if ( base != MAP_FAILED and kind == MM_NUMA_LOCAL ){
+#if defined(SYS_mbind) && defined(SYS_getcpu)
+				unsigned cpu = 0, node = 0;
+				if ( syscall(SYS_getcpu, &cpu, &node, NULL) == 0 and node < 64 ){
+					unsigned long node_mask = 1UL << node;
+					syscall(SYS_mbind, base, len, MPOL_BIND, &node_mask, 64, 0);
+				}
+#endif
+			}
+		}
+		if ( base == MAP_FAILED ){
+			if ( util::verbose ){
+				std::cerr<<"mm::map_chunk: could not map "<<len<<" bytes for policy "<<kind<<std::endl;
+			}
+			return NULL;
+		}
+		insert_region((uint64_t)base, mm_region(len, 0, kind));
+		return base;
+	}
+
+	uint64_t* mm::arena_alloc(uint64_t size, mm_policy_type kind){
+		size = ((size+7)>>3)<<3;
+		tMRegion::iterator it = m_regions.find(m_arena[kind]);
+		if ( m_arena[kind] == 0 or it == m_regions.end() or it->second.top + size > it->second.len ){
+			uint64_t len = size > m_chunk_size ? size : m_chunk_size;
+			len = ((len+HUGE_PAGE_LEN-1)/HUGE_PAGE_LEN)*HUGE_PAGE_LEN;
+			char* base = map_chunk(len, kind);
+			if ( base == NULL )
+				return NULL;
+			drop_arena(kind);
+			m_arena[kind] = (uint64_t)base;
+			it = m_regions.find(m_arena[kind]);
+		}
+		uint64_t* data = (uint64_t*)(it->first + it->second.top);
+		it->second.top += size;
+		++(it->second.refs);
+		return data;
+	}
+
+	void mm::drop_arena(mm_policy_type kind){
+		tMRegion::iterator it = m_regions.find(m_arena[kind]);
+		m_arena[kind] = 0;
+		if ( it != m_regions.end() and 0 == it->second.refs )
+			unmap_region(it);
+	}
+
+	void mm::unmap_region(tMRegion::iterator it){
+		if ( util::verbose ){
+			std::cerr<<"mm::unmap_region: unmap "<<it->second.len<<" bytes"<<std::endl;
+		}
+		munmap((void*)it->first, it->second.len);
+		m_regions.erase(it);
+		update_region_bounds();
+	}
+
+	uint64_t* mm::realloc_mem(uint64_t* data, uint64_t old_size, uint64_t size){
+		if ( m_policy == MM_MALLOC and !may_be_in_region(data) ){
+			// Method realloc is equivalent to malloc if data == NULL.
+			return (uint64_t*)realloc(data, size);
+		}
+		mm_policy_type kind = MM_MALLOC;
+		uint64_t* new_data = NULL;
+		{
+			lock_guard lock;
+			tMRegion::iterator it = data == NULL ? m_regions.end() : find_region(data);
+			kind = it == m_regions.end() ? MM_MALLOC : it->second.kind;
+			if ( kind == m_policy and kind != MM_MALLOC and it->first == m_arena[kind] ){
+				uint64_t offset = (uint64_t)data - it->first;
+				uint64_t old_len = ((old_size+7)>>3)<<3;
+				uint64_t len = ((size+7)>>3)<<3;
+				if ( offset + old_len == it->second.top and offset + len <= it->second.len ){
+					it->second.top = offset + len; // data is the last allocation of the chunk: resize in place
+					return data;
+				}
+			}
+			if ( m_policy != MM_MALLOC )
+				new_data = arena_alloc(size, m_policy);
+		}
+		// The region of data is referenced by the caller, so it can be read without the lock.
+		if ( new_data == NULL ){ // fall back to malloc
+			if ( kind == MM_MALLOC ){
+				// Method realloc is equivalent to malloc if data == NULL.
+				return (uint64_t*)realloc(data, size);
+			}
+			new_data = (uint64_t*)malloc(size);
+		}
+		if ( data != NULL ){
+			memcpy(new_data, data, old_size < size ? old_size : size);
+			if ( kind == MM_MALLOC )
+				free(data);
+			else
+				release_region(data);
+		}
+		return new_data;
+	}
+
+	void mm::free_mem(uint64_t* data){
+		if ( !may_be_in_region(data) ){
+			free(data);
+			return;
+		}
+		lock_guard lock;
+		free_mem_unlocked(data);
+	}
+
+	void mm::free_mem_unlocked(uint64_t* data){
+		if ( data == NULL )
+			return;
+		if ( find_region(data) != m_regions.end() )
+			release_region_unlocked(data);
+		else
+			free(data);
+	}
+
+	char* mm::map_file(const std::string& file_name, uint64_t& len){
+		int fd = open(file_name.c_str(), O_RDONLY);
+		if ( fd == -1 )
+			return NULL;
+		struct stat fs;
+		if ( fstat(fd, &fs) == -1 ){
+			close(fd);
+			return NULL;
+		}
+		len = fs.st_size;
+		uint64_t page_size = sysconf(_SC_PAGESIZE);
+		uint64_t map_len = ((len+page_size-1)/page_size+1)*page_size; // one additional zero page
+		// reserve the address range with anonymous memory and map the file into its start
+		char* base = (char*)mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if ( base == MAP_FAILED ){
+			close(fd);
+			return NULL;
+		}
+		if ( len > 0 and mmap(base, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED ){
+			munmap(base, map_len);
+			close(fd);
+			return NULL;
+		}
+		close(fd); // the mapping stays valid
+		if ( util::verbose ){
+			std::cerr<<"mm::map_file: map "<<len<<" bytes of "<<file_name<<std::endl;
+		}
+		lock_guard lock;
+		insert_region((uint64_t)base, mm_region(map_len, 1));
+		return base;
+	}
+
+	void mm::retain_region(const void* addr){
+		lock_guard lock;
+		retain_region_unlocked(addr);
+	}
+
+	void mm::retain_region_unlocked(const void* addr){
+		tMRegion::iterator it = find_region(addr);
+		if ( it != m_regions.end() )
+			++(it->second.refs);
+	}
+
+	void mm::release_region(const void* addr){
+		lock_guard lock;
+		release_region_unlocked(addr);
+	}
+
+	void mm::release_region_unlocked(const void* addr){
+		tMRegion::iterator it = find_region(addr);
+		if ( it != m_regions.end() and 0 == --(it->second.refs) ){
+			if ( it->second.kind != MM_MAPPED_FILE and it->first == m_arena[it->second.kind] ){
+				it->second.top = 0; // reuse the current chunk of the arena
+			}else{
+				unmap_region(it);
+			}
+		}
+	}
+
+	uint64_t* mm::map_payload(std::istream& in, uint64_t bit_size, bool bit_vector){
+		mapped_streambuf* buf = dynamic_cast<mapped_streambuf*>(in.rdbuf());
+		if ( buf == NULL )
+			return NULL;
+		uint64_t words = (bit_size+63)>>6;
+		uint64_t bytes = words<<3;
+		uint64_t guard = (buf->alignment() > 0 and (bit_size % 64) == 0) ? 8 : 0;
+		buf->skip(mm::payload_padding(buf->pos(), bytes, buf->alignment()));
+		if ( buf->remaining() < bytes+guard or (((uint64_t)buf->current()) % 8) != 0 )
+			return NULL; // read the payload as usual 
+		uint64_t* data = (uint64_t*)buf->current();
+		// In plain files the word after the payload belongs to the next member.
+		// Rank structures expect that it is zero, if bit_size is a multiple of 64.
+		if ( 0 == buf->alignment() and bit_vector and (bit_size % 64) == 0 and data[words] != 0 )
+			return NULL;
+		buf->skip(bytes+guard);
+		retain_region(data);
+		return data;
+	}
+
+	uint64_t mm::align_payload(std::ostream& out, uint64_t bit_size){
+		aligned_filebuf* buf = dynamic_cast<aligned_filebuf*>(out.rdbuf());
+		if ( buf == NULL )
+			return 0;
+		uint64_t padding = mm::payload_padding(buf->pos(), ((bit_size+63)>>6)<<3, buf->alignment());
+		for (uint64_t i=0; i < padding; ++i)
+			out.put(0);
+		return padding;
+	}
+
+	uint64_t mm::guard_payload(std::ostream& out, uint64_t bit_size){
+		aligned_filebuf* buf = dynamic_cast<aligned_filebuf*>(out.rdbuf());
+		if ( buf == NULL or (bit_size % 64) != 0 )
+			return 0;
+		uint64_t zero = 0;
+		out.write((char*)&zero, sizeof(zero));
+		return sizeof(zero);
+	}
+
+	void mm::skip_guard(std::istream& in, uint64_t bit_size){
+		mapped_streambuf* buf = dynamic_cast<mapped_streambuf*>(in.rdbuf());
+		if ( buf != NULL and buf->alignment() > 0 and (bit_size % 64) == 0 )
+			buf->skip(8);
+	}
+
+	bool mapped_streambuf::open(const char* file_name){
+		close();
+		char* base = mm::map_file(file_name, m_len);
+		if ( base == NULL )
+			return false;
+		setg(base, base, base+m_len);
+		uint64_t magic = 0;
+		if ( m_len >= 2*sizeof(uint64_t) )
+			memcpy(&magic, base, sizeof(magic));
+		if ( magic == SDSL_MMAP_MAGIC ){
+			memcpy(&m_alignment, base+sizeof(magic), sizeof(m_alignment));
+			skip(2*sizeof(uint64_t));
+		}else{
+			m_alignment = 0;
+		}
+		m_base = base;
+		return true;
+	}
+
+	void mapped_streambuf::close(){
+		if ( m_base != NULL ){
+			mm::release_region(m_base);
+			m_base = NULL;
+			m_len = 0;
+			m_alignment = 0;
+			setg(NULL, NULL, NULL);
+		}
+	}
+
+	mapped_streambuf::pos_type mapped_streambuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which){
+		if ( !(which & std::ios_base::in) )
+			return pos_type(off_type(-1));
+		off_type p = off;
+		if ( dir == std::ios_base::cur )
+			p += gptr()-eback();
+		else if ( dir == std::ios_base::end )
+			p += egptr()-eback();
+		return seekpos(pos_type(p), which);
+	}
+
+	mapped_streambuf::pos_type mapped_streambuf::seekpos(pos_type pos, std::ios_base::openmode which){
+		if ( !(which & std::ios_base::in) or off_type(pos) < 0 or off_type(pos) > egptr()-eback() )
+			return pos_type(off_type(-1));
+		setg(eback(), eback()+off_type(pos), egptr());
+		return pos;
+	}
+
 	bool mm::map_hp(){
-#ifdef MAP_HUGETLB		
+		lock_guard lock;
 		m_total_memory = 0; // memory of all int_vectors
 		for(tMVecItem::const_iterator it=m_items.begin(); it!=m_items.end(); ++it){
-			m_total_memory += it->second->size();
+			m_total_memory += it->second->size()+8; // +8 for the padding word
 		}				
 		if(util::verbose){
 			std::cout<<"m_total_memory"<<m_total_memory<<std::endl;
 		}
+		m_data = NULL;
+#ifdef MAP_HUGETLB		
 		size_t hpgs= (m_total_memory+HUGE_LEN-1)/HUGE_LEN; // number of huge pages required to store the int_vectors 
-		m_data = (uint64_t*)mmap(NULL, hpgs*HUGE_LEN, HUGE_PROTECTION, HUGE_FLAGS, 0, 0);
-		if (m_data == MAP_FAILED) {
+		m_data = (uint64_t*)map_chunk(hpgs*HUGE_LEN, MM_HUGEPAGE);
+#endif		
+		if (m_data == NULL) { // fall back to transparent huge pages
+			if( util::verbose ){
+				std::cerr<<"MAP_HUGETLB was not successful, use transparent huge pages" << std::endl; 
+			}
+			size_t thpgs = (m_total_memory+HUGE_PAGE_LEN-1)/HUGE_PAGE_LEN;
+			m_data = (uint64_t*)map_chunk(thpgs*HUGE_PAGE_LEN, MM_THP);
+		}
+		if (m_data == NULL) {
 			std::cout << "mmap was not successful" << std::endl;
 			return false;
 		}else{
@@ -50,6 +421,7 @@ namespace sdsl
 				std::cerr<<"map " << m_total_memory << " bytes" << std::endl; 
 			}
 		}
+		retain_region_unlocked(m_data); // keep the region alive while the int_vectors are mapped
 		// map int_vectors
 		uint64_t *addr = m_data;
 		bool success = true;
@@ -57,15 +429,13 @@ namespace sdsl
 //			std::cerr<<"addr = "<< addr << std::endl;
 			success = success && it->second->map_hp( addr );
 		}
+		m_regions[(uint64_t)m_data].top = (addr-m_data)*8;
+		release_region_unlocked(m_data); // the region is unmapped when the last int_vector is unmapped or destroyed
 		return success;
-#else
-		return false;
-#endif		
 	}
 
 	bool mm::unmap_hp(){
-#ifdef MAP_HUGETLB		
-		size_t hpgs= (m_total_memory+HUGE_LEN-1)/HUGE_LEN; // number of huge pages 
+		lock_guard lock;
 		if (  util::verbose ){
 			std::cerr<<"unmap "<< m_total_memory << " bytes" <<std::endl;
 			std::cerr.flush();
@@ -74,17 +444,100 @@ namespace sdsl
 		for(tMVecItem::const_iterator it=m_items.begin(); it!=m_items.end(); ++it){
 			success = success && it->second->unmap_hp();
 		}
-//		uint64_t* tmp_data = (uint64_t*)malloc(m_total_memory); // allocate memory for int_vectors 
-//		memcpy(tmp_data, m_data, len); // copy data from the mmapped region
-		int ret = munmap((void*)m_data, hpgs*HUGE_LEN ); 
-		if ( ret == -1 ){
-			perror("Unmap failed");
-			return false;
-		}
+		m_data = NULL; // the region was unmapped after the last int_vector was copied
 		return success;
-#else
-		return true;
-#endif
+	}
+
+	bool mm::in_hp_region(const void* addr){
+		lock_guard lock;
+		return in_hp_region_unlocked(addr);
+	}
+
+	bool mm::in_hp_region_unlocked(const void* addr){
+		tMRegion::iterator it = find_region(addr);
+		return m_data != NULL and it != m_regions.end() and it->first == (uint64_t)m_data;
+	}
+
+	// A mapping of the process and the number of its bytes which are backed by huge pages
+	struct smaps_entry{
+		uint64_t begin, end, hugepage_bytes;
+	};
+
+	// Parse /proc/self/smaps
+	static void read_smaps(std::vector<smaps_entry>& entries){
+		std::ifstream in("/proc/self/smaps");
+		std::string line;
+		smaps_entry e = {0, 0, 0};
+		uint64_t kernel_page_kb = 4, anon_huge_kb = 0, hugetlb_kb = 0;
+		bool valid = false;
+		while ( std::getline(in, line) ){
+			unsigned long long b = 0, ee = 0, kb = 0;
+			char field[64];
+			if ( sscanf(line.c_str(), "%llx-%llx", &b, &ee) == 2 and line.find(':') > line.find('-') ){
+				if ( valid ){
+					e.hugepage_bytes = (kernel_page_kb >= 2048 ? hugetlb_kb : anon_huge_kb)*1024;
+					entries.push_back(e);
+				}
+				e.begin = b; e.end = ee;
+				kernel_page_kb = 4; anon_huge_kb = 0; hugetlb_kb = 0;
+				valid = true;
+			}else if ( sscanf(line.c_str(), "%63s %llu", field, &kb) == 2 ){
+				std::string f(field);
+				if ( f == "KernelPageSize:" )
+					kernel_page_kb = kb;
+				else if ( f == "AnonHugePages:" )
+					anon_huge_kb = kb;
+				else if ( f == "Private_Hugetlb:" or f == "Shared_Hugetlb:" )
+					hugetlb_kb += kb;
+			}
+		}
+		if ( valid ){
+			e.hugepage_bytes = (kernel_page_kb >= 2048 ? hugetlb_kb : anon_huge_kb)*1024;
+			entries.push_back(e);
+		}
+	}
+
+	void mm::item_infos(std::vector<mm_item_info>& infos, const void* vector_begin, const void* vector_end){
+		infos.clear();
+		std::vector<smaps_entry> entries;
+		read_smaps(entries); // entries are sorted by address
+		lock_guard lock;
+		for(tMVecItem::const_iterator it=m_items.begin(); it!=m_items.end(); ++it){
+			if ( vector_end != NULL and (it->first < (uint64_t)vector_begin or it->first >= (uint64_t)vector_end) )
+				continue;
+			mm_item_info info;
+			info.vector = (const void*)it->first;
+			info.data = it->second->data();
+			info.bytes = it->second->size();
+			tMRegion::iterator region = find_region(info.data);
+			info.kind = region == m_regions.end() ? MM_MALLOC : region->second.kind;
+			info.hugepage_bytes = 0;
+			uint64_t b = (uint64_t)info.data, e = b + info.bytes;
+			for (size_t i=0; info.data != NULL and i < entries.size() and entries[i].begin < e; ++i){
+				if ( entries[i].end <= b )
+					continue;
+				uint64_t overlap = (e < entries[i].end ? e : entries[i].end) - (b > entries[i].begin ? b : entries[i].begin);
+				uint64_t len = entries[i].end - entries[i].begin;
+				info.hugepage_bytes += (uint64_t)(((double)overlap)*entries[i].hugepage_bytes/len);
+			}
+			infos.push_back(info);
+		}
+	}
+
+	mm_hp_stats mm::hugepage_stats(const void* vector_begin, const void* vector_end){
+		std::vector<mm_item_info> infos;
+		item_infos(infos, vector_begin, vector_end);
+		mm_hp_stats stats;
+		for (size_t i=0; i < infos.size(); ++i){
+			++stats.vectors;
+			stats.bytes += infos[i].bytes;
+			stats.hugepage_bytes += infos[i].hugepage_bytes;
+		}
+		return stats;
+	}
+
+	mm_hp_stats mm::hugepage_stats(){
+		return hugepage_stats(NULL, NULL);
 	}
 
 } // end namespace
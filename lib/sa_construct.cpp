@@ -0,0 +1,375 @@
+/* sdsl - succinct data structures library
+    Copyright (C) 2012 Simon Gog
+*/
+
+#include "sdsl/sa_construct.hpp"
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <cstdio>
+
+namespace sdsl
+{
+
+namespace
+{
+
+typedef int_vector<>::size_type size_type;
+
+//! Sequential reader for a serialized int_vector, which returns 0 after the last element.
+template<uint8_t fixedIntWidth>
+class iv_reader
+{
+        int_vector_file_buffer<fixedIntWidth> m_buf;
+        size_type m_r;   // number of elements in the current block
+        size_type m_idx; // index of the next element in the current block
+    public:
+        iv_reader(const std::string& file_name, size_type buf_len):m_buf(file_name.c_str(), buf_len), m_r(0), m_idx(0) {
+            if (!m_buf.valid()) {
+                throw std::ios_base::failure("construct_sa_extern: Cannot open "+file_name);
+            }
+        }
+
+        size_type size()const {
+            return m_buf.int_vector_size;
+        }
+
+        uint64_t next() {
+            if (m_idx == m_r) {
+                m_idx = 0;
+                if ((m_r = m_buf.load_next_block()) == 0)
+                    return 0;
+            }
+            return m_buf[m_idx++];
+        }
+};
+
+//! Sequential writer for a serialized int_vector of fixed length.
+class iv_writer
+{
+        std::ofstream m_out;
+        int_vector<> m_buf;
+        size_type     m_idx; // number of elements in the buffer
+        size_type     m_wb;  // number of written bytes
+    public:
+        /*! \param file_name Name of the output file.
+         *  \param n         Number of elements, which will be written.
+         *  \param width     Width of the elements.
+         *  \param fixed     If true, the header of an int_vector<width> is written, i.e. without the width.
+         *  \param buf_len   Length of the buffer in elements, a multiple of 64.
+         */
+        iv_writer(const std::string& file_name, size_type n, uint8_t width, bool fixed, size_type buf_len):
+            m_out(file_name.c_str(), std::ios::binary | std::ios::trunc | std::ios::out), m_buf(buf_len, 0, width), m_idx(0), m_wb(0) {
+            if (!m_out) {
+                throw std::ios_base::failure("construct_sa_extern: Cannot create "+file_name);
+            }
+            size_type bit_size = n*width;
+            m_out.write((char*) &bit_size, sizeof(bit_size));     // write size of vector
+            if (!fixed)
+                m_out.write((char*) &width, sizeof(width));        // write int_width of vector
+        }
+
+        void push_back(uint64_t x) {
+            m_buf[m_idx++] = x;
+            if (m_idx == m_buf.size())
+                flush();
+        }
+
+        void flush() {
+            if (m_idx > 0) {
+                size_type cur_wb = (m_idx*m_buf.get_int_width()+7)/8;
+                m_out.write((const char*)m_buf.data(), cur_wb);
+                m_wb += cur_wb;
+                m_idx = 0;
+            }
+        }
+
+        void close() {
+            flush();
+            if (m_wb%8) {
+                m_out.write("\0\0\0\0\0\0\0\0", 8-m_wb%8);
+            }
+            m_out.close();
+        }
+};
+
+//! A record of t_w words, which is compared lexicographically.
+template<uint8_t t_w>
+struct em_record {
+    uint64_t x[t_w];
+
+    bool operator<(const em_record& r)const {
+        for (uint8_t i=0; i < t_w; ++i)
+            if (x[i] != r.x[i])
+                return x[i] < r.x[i];
+        return false;
+    }
+};
+
+//! External merge sort for em_records.
+/*! The records are collected in a buffer of half of the RAM budget. Full buffers are sorted
+ *  and written as runs to temp_write_read_buffers. The runs share the other half of the
+ *  budget and are merged with a priority queue. If all records fit into the buffer, no
+ *  file is written.
+ */
+template<uint8_t t_w>
+class em_sorter
+{
+        typedef em_record<t_w> record_type;
+        typedef temp_write_read_buffer<64> run_type;
+        typedef std::pair<record_type, size_type> head_type; // first record of a run and index of the run
+
+        struct head_greater {
+            bool operator()(const head_type& a, const head_type& b)const {
+                return b.first < a.first;
+            }
+        };
+
+        std::vector<record_type> m_chunk;     // buffer for unsorted records
+        size_type                m_chunk_len; // maximal number of records in the buffer
+        size_type                m_run_len;   // buffer size of a run in words
+        std::string              m_dir;
+        std::vector<run_type*>   m_runs;
+        std::priority_queue<head_type, std::vector<head_type>, head_greater> m_heads;
+        size_type                m_idx;       // read index in m_chunk, if no run was written
+
+        bool read(size_type run, record_type& r) {
+            for (uint8_t i=0; i < t_w; ++i)
+                if (!((*m_runs[run]) >> r.x[i]))
+                    return false;
+            return true;
+        }
+
+        void write_run() {
+            std::sort(m_chunk.begin(), m_chunk.end());
+            run_type* run = new run_type(m_run_len, 64, m_dir);
+            for (size_type i=0; i < m_chunk.size(); ++i)
+                for (uint8_t j=0; j < t_w; ++j)
+                    (*run) << m_chunk[i].x[j];
+            run->write_close();
+            m_runs.push_back(run);
+            m_chunk.clear();
+        }
+
+        em_sorter(const em_sorter&);
+        em_sorter& operator=(const em_sorter&);
+
+    public:
+        //! Constructor
+        /*! \param n          Number of records, which will be pushed.
+         *  \param ram_budget Number of bytes of main memory the sorter may use.
+         *  \param dir        Directory for the runs.
+         */
+        em_sorter(size_type n, uint64_t ram_budget, const std::string& dir):m_dir(dir), m_idx(0) {
+            m_chunk_len = std::max((size_type)(ram_budget/2/sizeof(record_type)), (size_type)1024);
+            m_chunk.reserve(std::min(n, m_chunk_len));
+            size_type runs = (n+m_chunk_len-1)/m_chunk_len;
+            m_run_len = std::max((size_type)(ram_budget/2/8/(runs+1)), (size_type)(t_w*1024));
+        }
+
+        ~em_sorter() {
+            for (size_type i=0; i < m_runs.size(); ++i)
+                delete m_runs[i];
+        }
+
+        void push_back(const record_type& r) {
+            m_chunk.push_back(r);
+            if (m_chunk.size() == m_chunk_len)
+                write_run();
+        }
+
+        //! Has to be called after the last push_back and before the first call of next.
+        void finish() {
+            if (m_runs.empty()) {
+                std::sort(m_chunk.begin(), m_chunk.end());
+                return;
+            }
+            if (!m_chunk.empty())
+                write_run();
+            std::vector<record_type>().swap(m_chunk); // free the buffer before merging
+            record_type r;
+            for (size_type i=0; i < m_runs.size(); ++i) {
+                if (read(i, r))
+                    m_heads.push(head_type(r, i));
+            }
+        }
+
+        //! Returns the next record in sorted order; false if all records were returned.
+        bool next(record_type& r) {
+            if (m_runs.empty()) {
+                if (m_idx == m_chunk.size())
+                    return false;
+                r = m_chunk[m_idx++];
+                return true;
+            }
+            if (m_heads.empty())
+                return false;
+            head_type h = m_heads.top();
+            m_heads.pop();
+            r = h.first;
+            if (read(h.second, h.first))
+                m_heads.push(h);
+            return true;
+        }
+};
+
+} // end anonymous namespace
+
+bool construct_sa_extern(tMSS& file_map, const std::string& dir, const std::string& id, uint64_t ram_budget)
+{
+    typedef em_record<3> tuple_type; // (name[i], name[i+h], i)
+    typedef em_record<2> name_type;  // (i, name[i])
+    write_R_output("sa", "construct SA extern", "begin", 1, 0);
+    ram_budget = std::max(ram_budget, (uint64_t)1<<20);
+    const size_type buf_len = std::max((size_type)(ram_budget/64/8), (size_type)4096) & ~(size_type)63; // for each stream
+    const uint64_t sort_budget = ram_budget - 4*8*buf_len;
+
+    // determine the alphabet of the text
+    uint64_t char2comp[256] = {0};
+    size_type n = 0;
+    {
+        iv_reader<8> text(file_map["text"], buf_len*8);
+        n = text.size();
+        for (size_type i=0; i < n; ++i)
+            char2comp[text.next()] = 1;
+    }
+    uint64_t sigma = 0;
+    for (size_type c=0; c < 256; ++c) {
+        if (char2comp[c])
+            char2comp[c] = ++sigma; // 0 is reserved for positions after the end of the text
+    }
+
+    // the initial name of suffix i is a word which contains the first characters of the suffix
+    const uint8_t  bits  = bit_magic::l1BP(sigma)+1;
+    const size_type chars = 64/bits;
+    const uint64_t mask  = (chars*bits == 64) ? 0xFFFFFFFFFFFFFFFFULL : (1ULL<<(chars*bits))-1;
+    std::string names_file = dir+"sa_names_"+id;
+    {
+        iv_reader<8> text(file_map["text"], buf_len*8);
+        iv_writer names(names_file, n, 64, true, buf_len);
+        uint64_t key = 0;
+        for (size_type j=0; j < chars; ++j)
+            key = (key << bits) | (j < n ? char2comp[text.next()] : 0);
+        for (size_type i=0; i < n; ++i) {
+            names.push_back(key);
+            key = ((key << bits) | (i+chars < n ? char2comp[text.next()] : 0)) & mask;
+        }
+        names.close();
+    }
+
+    std::string sa_file = dir+"sa_"+id;
+    const uint8_t sa_width = bit_magic::l1BP(n+1)+1;
+    bool unique = (n == 0);
+    if (unique) {
+        iv_writer sa(sa_file, 0, sa_width, false, 64);
+        sa.close();
+    }
+    for (size_type h=chars; !unique; h *= 2) {
+        write_R_output("sa", "doubling round", "begin", h, 0);
+        // sort the tuples (name[i], name[i+h], i)
+        em_sorter<3> tuples(n, sort_budget, dir);
+        {
+            iv_reader<64> name_i(names_file, buf_len);
+            iv_reader<64> name_ih(names_file, buf_len);
+            for (size_type i=0; i < h and i < n; ++i)
+                name_ih.next();
+            tuple_type t;
+            for (size_type i=0; i < n; ++i) {
+                t.x[0] = name_i.next();
+                t.x[1] = name_ih.next(); // 0 for i+h >= n
+                t.x[2] = i;
+                tuples.push_back(t);
+            }
+        }
+        tuples.finish();
+        // rename each suffix with the rank of its group; the order of the tuples
+        // is the suffix array, if all groups are singletons
+        em_sorter<2> new_names(n, sort_budget, dir);
+        {
+            iv_writer sa(sa_file, n, sa_width, false, buf_len);
+            tuple_type t, prev;
+            name_type nn;
+            size_type groups = 0;
+            for (size_type p=0; tuples.next(t); ++p) {
+                if (p == 0 or t.x[0] != prev.x[0] or t.x[1] != prev.x[1]) {
+                    ++groups;
+                    nn.x[1] = p+1;
+                    prev = t;
+                }
+                nn.x[0] = t.x[2];
+                new_names.push_back(nn);
+                sa.push_back(t.x[2]);
+            }
+            sa.close();
+            unique = (groups == n);
+        }
+        if (!unique) {
+            // write the new names in text order
+            new_names.finish();
+            iv_writer names(names_file, n, 64, true, buf_len);
+            name_type nn;
+            while (new_names.next(nn))
+                names.push_back(nn.x[1]);
+            names.close();
+        }
+        write_R_output("sa", "doubling round", "end", h, 0);
+    }
+    std::remove(names_file.c_str());
+    file_map["sa"] = sa_file;
+    write_R_output("sa", "construct SA extern", "end", 1, 0);
+    return true;
+}
+
+bool construct_bwt_extern(tMSS& file_map, const std::string& dir, const std::string& id, uint64_t ram_budget)
+{
+    typedef em_record<2> pair_type;
+    if (file_map.find("bwt") != file_map.end())
+        return true;
+    write_R_output("csa", "construct BWT extern", "begin", 1, 0);
+    ram_budget = std::max(ram_budget, (uint64_t)1<<20);
+    const size_type buf_len = std::max((size_type)(ram_budget/64/8), (size_type)4096) & ~(size_type)63; // for each stream
+    const uint64_t sort_budget = ram_budget - 4*8*buf_len;
+    size_type n = 0;
+    {
+        iv_reader<0> sa(file_map["sa"], 64);
+        n = sa.size();
+    }
+    // sort the pairs (SA[i]-1 mod n, i) by the text position
+    em_sorter<2> by_text_pos(n, sort_budget, dir);
+    {
+        iv_reader<0> sa(file_map["sa"], buf_len);
+        pair_type p;
+        for (size_type i=0; i < n; ++i) {
+            uint64_t x = sa.next();
+            p.x[0] = x > 0 ? x-1 : n-1;
+            p.x[1] = i;
+            by_text_pos.push_back(p);
+        }
+    }
+    by_text_pos.finish();
+    // scan the text and sort the pairs (i, T[SA[i]-1 mod n]) by i
+    em_sorter<2> by_sa_pos(n, sort_budget, dir);
+    {
+        iv_reader<8> text(file_map["text"], buf_len*8);
+        pair_type p, q;
+        while (by_text_pos.next(p)) { // p.x[0] equals the position of the next character of text
+            q.x[0] = p.x[1];
+            q.x[1] = text.next();
+            by_sa_pos.push_back(q);
+        }
+    }
+    by_sa_pos.finish();
+    std::string bwt_file = dir+"bwt_"+id;
+    {
+        iv_writer bwt(bwt_file, n, 8, true, buf_len*8);
+        pair_type q;
+        while (by_sa_pos.next(q))
+            bwt.push_back(q.x[1]);
+        bwt.close();
+    }
+    file_map["bwt"] = bwt_file;
+    write_R_output("csa", "construct BWT extern", "end", 1, 0);
+    return true;
+}
+
+}// end namespace
@@ -68,6 +68,42 @@ TEST_F(BitMagicTest, Select)
     }
 }
 
+//! Test the implementations which are selected at run time against the portable ones
+TEST_F(BitMagicTest, RuntimeDispatch)
+{
+    using sdsl::bit_magic;
+    for (size_type i=0; i < 1000000; ++i) {
+        uint64_t x = (((size_type)rand())<<32) + rand();
+        if (i < 64) x = 1ULL<<i;
+        ASSERT_EQ(bit_magic::b1CntSwar(x), (uint64_t)bit_magic::b1CntNaive(x));
+        ASSERT_EQ(bit_magic::b1Cnt(x), (uint64_t)bit_magic::b1CntNaive(x));
+        ASSERT_EQ(bit_magic::l1BP(x), bit_magic::l1BPTable(x));
+        ASSERT_EQ(bit_magic::r1BP(x), bit_magic::r1BPTable(x));
+        if (bit_magic::cpu_popcnt) {
+            ASSERT_EQ(bit_magic::b1CntPopcnt(x), (uint64_t)bit_magic::b1CntNaive(x));
+        }
+        if (bit_magic::cpu_bmi2) {
+            for (uint32_t j=1; j <= bit_magic::b1Cnt(x); ++j) {
+                ASSERT_EQ(bit_magic::i1BPPdep(x, j), bit_magic::i1BP2(x, j));
+            }
+        }
+    }
+}
+
+//! Test the bulk population count for all lengths up to 200 words
+TEST_F(BitMagicTest, BulkRank)
+{
+    std::vector<uint64_t> data(200);
+    for (size_type i=0; i < data.size(); ++i) {
+        data[i] = (((size_type)rand())<<32) + rand();
+    }
+    uint64_t expected = 0;
+    for (size_type n=0; n <= data.size(); ++n) {
+        ASSERT_EQ(sdsl::bit_magic::b1Cnt(data.empty() ? NULL : &data[0], n), expected);
+        if (n < data.size())
+            expected += sdsl::bit_magic::b1CntNaive(data[n]);
+    }
+}
 
 }  // namespace
 
@@ -0,0 +1,123 @@
+#include "sdsl/suffixarrays.hpp"
+#include "sdsl/csa_construct.hpp"
+#include "sdsl/bwt_construct.hpp"
+#include "sdsl/config.hpp" // for CMAKE_SOURCE_DIR
+#include "gtest/gtest.h"
+#include <vector>
+#include <string>
+#include <cstdlib> // for rand()
+#include <cstring> // for strlen
+
+namespace
+{
+
+typedef sdsl::int_vector<>::size_type size_type;
+
+class BwtConstructTest : public ::testing::Test
+{
+    protected:
+
+        BwtConstructTest() {}
+
+        virtual ~BwtConstructTest() {}
+
+        virtual void SetUp() {
+            std::string test_cases_dir = std::string(SDSL_XSTR(CMAKE_SOURCE_DIR)) + "/test/test_cases";
+            const char* files[] = {"/crafted/100a.txt", "/crafted/abc_abc_abc.txt", "/crafted/abc_abc_abc2.txt",
+                                   "/crafted/empty.txt", "/crafted/example01.txt", "/small/faust.txt"
+                                  };
+            for (size_t i=0; i < sizeof(files)/sizeof(files[0]); ++i) {
+                char* text = NULL;
+                uint64_t n = sdsl::file::read_text((test_cases_dir + files[i]).c_str(), text);
+                if (n > 0 and strlen(text)+1 == n) { // read_text appends a 0-byte, which has to be unique
+                    texts.push_back(std::string(text, n));
+                }
+                delete [] text;
+            }
+            srand(17);
+            texts.push_back(std::string(1, '\0'));
+            texts.push_back(std::string("b") + '\0');
+            texts.push_back(std::string(20000, 'a') + '\0');
+            std::string s;
+            for (size_type i=0; i < 50000; ++i) s += (char)('a' + rand()%2);
+            texts.push_back(s + '\0');
+            s.clear();
+            for (size_type i=0; i < 50000; ++i) s += (char)(1 + rand()%254);
+            texts.push_back(s + '\0');
+            s = "abracadabra";
+            while (s.size() < 50000) s += s.substr(0, s.size()/2 + 1);
+            texts.push_back(s + '\0');
+        }
+
+        std::vector<std::string> texts;
+};
+
+//! Test that the blockwise BWT construction equals the BWT calculated from the suffix array
+TEST_F(BwtConstructTest, Blockwise)
+{
+    std::string dir = "./", id = "bwt_construct_test";
+    for (size_type i=0; i < texts.size(); ++i) {
+        const unsigned char* text = (const unsigned char*)texts[i].data();
+        size_type n = texts[i].size();
+        sdsl::int_vector<> sa(n, 0, sdsl::bit_magic::l1BP(n+1)+1);
+        sdsl::algorithm::calculate_sa(text, n, sa);
+        uint64_t block_sizes[] = {1, 7, 1000, 0};
+        for (size_type b=0; b < 4; ++b) {
+            if (block_sizes[b] > 0 and n/block_sizes[b] > 100) // the time is quadratic in the number of blocks
+                continue;
+            sdsl::tMSS file_map;
+            ASSERT_TRUE(sdsl::util::store_to_file(sdsl::char_array_serialize_wrapper<>((unsigned char*)text, n), (dir+"text_"+id).c_str()));
+            file_map["text"] = dir+"text_"+id;
+            ASSERT_TRUE(sdsl::construct_bwt_blockwise(file_map, dir, id, block_sizes[b]));
+            sdsl::int_vector<8> bwt;
+            ASSERT_TRUE(sdsl::util::load_from_file(bwt, file_map["bwt"].c_str()));
+            ASSERT_EQ(n, bwt.size());
+            for (size_type j=0; j < n; ++j) {
+                ASSERT_EQ(text[(sa[j]+n-1)%n], bwt[j]) << " at position " << j << " of text " << i
+                                                       << " of length " << n << " with block size " << block_sizes[b];
+            }
+            sdsl::util::delete_all_files(file_map);
+        }
+    }
+}
+
+//! Test that a csa_wt constructed without suffix array equals the csa_wt constructed with it
+template<class tCsa>
+void test_csa_without_sa(const std::vector<std::string>& texts)
+{
+    std::string dir = "./", file = "bwt_construct_test.txt";
+    for (size_type i=0; i < texts.size(); ++i) {
+        if (texts[i].size() < 2)
+            continue;
+        sdsl::file::write_text(file.c_str(), texts[i].data(), texts[i].size()-1);
+        tCsa csa1, csa2;
+        sdsl::tMSS file_map1, file_map2;
+        ASSERT_TRUE(sdsl::construct_csa(file, csa1, file_map1, true, dir, "bwt_construct_test1"));
+        ASSERT_TRUE(sdsl::construct_csa_without_sa(file, csa2, file_map2, true, dir, "bwt_construct_test2"));
+        ASSERT_EQ(csa1.size(), csa2.size());
+        ASSERT_TRUE(csa1.sa_sample == csa2.sa_sample) << " for text " << i;
+        ASSERT_TRUE(csa1.isa_sample == csa2.isa_sample) << " for text " << i;
+        for (size_type j=0; j < csa1.size(); ++j) {
+            ASSERT_EQ(csa1[j], csa2[j]) << " at position " << j << " of text " << i;
+        }
+    }
+    std::remove(file.c_str());
+}
+
+TEST_F(BwtConstructTest, CsaWithoutSa)
+{
+    test_csa_without_sa<sdsl::csa_wt<sdsl::wt_huff<>, 8, 16> >(texts);
+}
+
+TEST_F(BwtConstructTest, CsaWithoutSaTextOrderSampling)
+{
+    test_csa_without_sa<sdsl::csa_wt<sdsl::wt_huff<>, 8, 16, 0, unsigned char, sdsl::text_order_sampling<> > >(texts);
+}
+
+}// end namespace
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
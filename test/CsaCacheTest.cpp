@@ -0,0 +1,3 @@
+// Runs the tests of CsaTest with cached SA and ISA values (see csa_cache_type).
+#define USE_CSA_CACHE
+#include "CsaTest.cpp"
@@ -0,0 +1,377 @@
+#include "sdsl/suffixarrays.hpp"
+#include "sdsl/csa_construct.hpp"
+#include "sdsl/wt_multiary.hpp"
+#include "sdsl/parallel.hpp"
+#include "sdsl/config.hpp" // for CMAKE_SOURCE_DIR
+#include "gtest/gtest.h"
+#include <vector>
+#include <string>
+#include <utility>
+#include <sstream>
+#include <cstdlib> // for rand()
+
+namespace
+{
+
+typedef sdsl::int_vector<>::size_type size_type;
+
+//! A task which compares the suffix array values of a csa with the expected values.
+template<class Csa>
+struct access_task {
+    const Csa* csa;
+    const std::vector<size_type>* sa;
+    size_type errors;
+    void operator()() {
+        errors = 0;
+        for (size_type round=0; round < 3; ++round) {
+            for (size_type j=0; j < sa->size(); ++j) {
+                if ((*csa)[j] != (*sa)[j])
+                    ++errors;
+            }
+        }
+    }
+};
+
+template<class T>
+class CsaTest : public ::testing::Test
+{
+    protected:
+
+        CsaTest() {}
+
+        virtual ~CsaTest() {}
+
+        virtual void SetUp() {
+            std::string test_cases_dir = std::string(SDSL_XSTR(CMAKE_SOURCE_DIR)) + "/test/test_cases";
+            const char* files[] = {"/crafted/100a.txt", "/crafted/abc_abc_abc.txt", "/crafted/example01.txt",
+                                   "/small/faust.txt"
+                                  };
+            for (size_t i=0; i < sizeof(files)/sizeof(files[0]); ++i) {
+                char* text = NULL;
+                uint64_t n = sdsl::file::read_text((test_cases_dir + files[i]).c_str(), text);
+                if (n > 1 and strlen(text)+1 == n) {
+                    texts.push_back(std::string(text, n-1));
+                }
+                delete [] text;
+            }
+            srand(17);
+            texts.push_back("b");
+            std::string s;
+            for (size_type i=0; i < 20000; ++i) s += (char)('a' + rand()%2);  // binary alphabet
+            texts.push_back(s);
+            s.clear();
+            for (size_type i=0; i < 20000; ++i) s += (char)(1 + rand()%254);  // large alphabet
+            texts.push_back(s);
+            s = "abracadabra";
+            while (s.size() < 20000) s += s.substr(0, s.size()/2 + 1);        // long repeats
+            texts.push_back(s);
+
+            std::string file = "csa_test.txt";
+            for (size_type i=0; i < texts.size(); ++i) {
+                sdsl::file::write_text(file.c_str(), texts[i].data(), texts[i].size());
+                csas.push_back(T());
+                sdsl::tMSS file_map;
+                ASSERT_TRUE(sdsl::construct_csa(file, csas.back(), file_map, true, "./", "csa_test"));
+                texts[i] += '\0'; // the csa contains the 0-byte at the end of the text
+            }
+            std::remove(file.c_str());
+        }
+
+        std::vector<std::string> texts;
+        std::vector<T> csas;
+};
+
+using testing::Types;
+
+typedef Types<
+sdsl::csa_wt<sdsl::wt_huff<>, 8, 8>,
+     sdsl::csa_wt<sdsl::wt_huff<>, 32, 64>,
+     sdsl::csa_wt<sdsl::wt_huff_rrr, 16, 5>,
+     sdsl::csa_sada<sdsl::enc_vector<>, 8, 8>,
+     sdsl::csa_wt<sdsl::wt_huff<>, 8, 8, 0, unsigned char, sdsl::text_order_sampling<> >,
+     sdsl::csa_wt<sdsl::wt_huff<>, 32, 64, 0, unsigned char, sdsl::text_order_sampling<sdsl::rrr_vector<> > >,
+     sdsl::csa_sada<sdsl::enc_vector<>, 16, 8, 0, sdsl::text_order_sampling<sdsl::bit_vector> >,
+     sdsl::csa_wt<sdsl::wt_huff<>, 16, 64, 0, unsigned char, sdsl::weighted_sampling<> >,
+     sdsl::csa_wt<sdsl::wt_huff<>, 32, 64, 0, unsigned char, sdsl::sa_order_sampling, sdsl::psi_sample_support<> >,
+     sdsl::csa_wt<sdsl::wt_huff_rrr, 8, 8, 0, unsigned char, sdsl::text_order_sampling<>, sdsl::psi_sample_support<4, sdsl::coder::fibonacci> >,
+     sdsl::csa_wt<sdsl::wt_multiary<>, 32, 64>,
+     sdsl::csa_wt<sdsl::wt_multiary<2>, 8, 8, 0, unsigned char, sdsl::text_order_sampling<> >
+     > Implementations;
+
+TYPED_TEST_CASE(CsaTest, Implementations);
+
+//! Test the extraction of substrings
+TYPED_TEST(CsaTest, Extract)
+{
+    for (size_type i=0; i < this->texts.size(); ++i) {
+        const std::string& text = this->texts[i];
+        size_type n = text.size();
+        ASSERT_EQ(n, this->csas[i].size());
+        std::vector<unsigned char> buf(n+1);
+        sdsl::algorithm::extract(this->csas[i], 0, n-1, &buf[0]);
+        for (size_type j=0; j < n; ++j) {
+            ASSERT_EQ((unsigned char)text[j], buf[j]) << " at position " << j << " of text " << i;
+        }
+        for (size_type k=0; k < 200; ++k) {
+            size_type begin = rand()%n, end = std::min(n-1, begin + rand()%100);
+            if (k == 0)
+                end = n-1;
+            ASSERT_EQ(text.substr(begin, end-begin+1), sdsl::algorithm::extract(this->csas[i], begin, end))
+                    << " for [" << begin << ".." << end << "] of text " << i;
+        }
+    }
+}
+
+//! Test the extraction of several substrings at once
+TYPED_TEST(CsaTest, ExtractMany)
+{
+    for (size_type i=0; i < this->texts.size(); ++i) {
+        const std::string& text = this->texts[i];
+        size_type n = text.size();
+        std::vector<std::pair<size_type, size_type> > snippets;
+        for (size_type k=0; k < 300; ++k) {
+            size_type begin = rand()%n, end = std::min(n-1, begin + rand()%(k%3 ? 10 : 300)); // close and overlapping snippets
+            snippets.push_back(std::make_pair(begin, end));
+        }
+        snippets.push_back(std::make_pair(n-1, n-1));
+        snippets.push_back(std::make_pair((size_type)0, n-1));
+        snippets.push_back(snippets[0]);
+        std::vector<std::string> result;
+        sdsl::algorithm::extract_many(this->csas[i], snippets, result);
+        ASSERT_EQ(snippets.size(), result.size());
+        for (size_type k=0; k < snippets.size(); ++k) {
+            ASSERT_EQ(text.substr(snippets[k].first, snippets[k].second-snippets[k].first+1), result[k])
+                    << " for snippet " << k << " [" << snippets[k].first << ".." << snippets[k].second << "] of text " << i;
+        }
+    }
+}
+
+//! Test that psi[j] is the suffix array position of the suffix SA[j]+1, also after storing and loading the csa
+TYPED_TEST(CsaTest, Psi)
+{
+    for (size_type i=0; i < this->texts.size(); ++i) {
+        const TypeParam& csa = this->csas[i];
+        size_type n = csa.size();
+        for (size_type j=0; j < n; ++j) {
+            ASSERT_EQ((csa[j]+1)%n, csa[csa.psi[j]]) << " for position " << j << " of text " << i;
+            ASSERT_EQ(j, csa.psi(csa.psi[j])) << " for position " << j << " of text " << i;
+        }
+        std::string file = "csa_psi_test.sdsl";
+        ASSERT_TRUE(sdsl::util::store_to_file(csa, file.c_str()));
+        TypeParam loaded;
+        ASSERT_TRUE(sdsl::util::load_from_file(loaded, file.c_str()));
+        std::remove(file.c_str());
+        for (size_type j=0; j < n; ++j) {
+            ASSERT_EQ(csa.psi[j], loaded.psi[j]) << " for position " << j << " of text " << i;
+        }
+    }
+}
+
+//! Test that locate reports the suffix array values of the interval of a pattern
+TYPED_TEST(CsaTest, Locate)
+{
+    for (size_type i=0; i < this->texts.size(); ++i) {
+        const std::string& text = this->texts[i];
+        size_type n = text.size();
+        for (size_type k=0; k < 100; ++k) {
+            size_type len = 1 + k%6, begin = rand()%n;
+            if (k == 0) // the pattern occurs in all positions except the last one for some texts
+                begin = n-2;
+            std::string pattern = text.substr(begin, std::min(len, n-1-begin));
+            if (pattern.empty())
+                continue;
+            std::vector<size_type> occ;
+            size_type occs = sdsl::algorithm::locate(this->csas[i], (const unsigned char*)pattern.c_str(), pattern.size(), occ);
+            ASSERT_EQ(occs, occ.size());
+            size_type l_res, r_res;
+            sdsl::algorithm::backward_search(this->csas[i], 0, n-1, (const unsigned char*)pattern.c_str(), pattern.size(), l_res, r_res);
+            ASSERT_EQ(r_res-l_res+1, occs);
+            for (size_type j=0; j < occs; ++j) {
+                ASSERT_EQ(this->csas[i][l_res+j], occ[j]) << " for occurrence " << j << " of pattern " << k << " in text " << i;
+                ASSERT_EQ(pattern, text.substr(occ[j], pattern.size()));
+            }
+        }
+    }
+}
+
+//! Test that count_many and locate_many agree with count and locate for each pattern
+TYPED_TEST(CsaTest, CountAndLocateMany)
+{
+    for (size_type i=0; i < this->texts.size(); ++i) {
+        const std::string& text = this->texts[i];
+        size_type n = text.size();
+        std::vector<std::string> patterns;
+        for (size_type k=0; k < 200; ++k) {
+            size_type len = 1 + rand()%8, begin = rand()%n;
+            std::string pattern = text.substr(begin, std::min(len, n-1-begin));
+            patterns.push_back(pattern);
+            if (k%4 == 0 and pattern.size() > 1) // patterns which share a suffix
+                patterns.push_back(pattern.substr(1));
+            if (k%5 == 0) // patterns which probably do not occur
+                patterns.push_back(pattern + (char)(1 + rand()%254) + pattern);
+        }
+        patterns.push_back("");
+        patterns.push_back(patterns[0]);
+        std::vector<size_type> counts;
+        sdsl::algorithm::count_many(this->csas[i], patterns, counts);
+        std::vector<std::vector<size_type> > occs;
+        sdsl::algorithm::locate_many(this->csas[i], patterns, occs);
+        ASSERT_EQ(patterns.size(), counts.size());
+        ASSERT_EQ(patterns.size(), occs.size());
+        for (size_type k=0; k < patterns.size(); ++k) {
+            std::vector<size_type> occ;
+            size_type cnt = sdsl::algorithm::locate(this->csas[i], (const unsigned char*)patterns[k].c_str(), patterns[k].size(), occ);
+            ASSERT_EQ(cnt, counts[k]) << " for pattern " << k << " of text " << i;
+            ASSERT_TRUE(occ == occs[k]) << " for pattern " << k << " of text " << i;
+        }
+    }
+}
+
+//! Returns true if csa and expected have the same SA and ISA values
+template<class Csa>
+bool same_values(const Csa& csa, const Csa& expected)
+{
+    if (csa.size() != expected.size())
+        return false;
+    for (size_type j=0; j < csa.size(); ++j) {
+        if (csa[j] != expected[j] or csa(j) != expected(j))
+            return false;
+    }
+    return true;
+}
+
+//! Test that copy, operator=, swap and load replace all values (including cached ones)
+TYPED_TEST(CsaTest, CopySwapAndLoad)
+{
+    for (size_type i=1; i < this->csas.size(); ++i) {
+        const TypeParam& prev = this->csas[i-1];
+        const TypeParam& cur = this->csas[i];
+        TypeParam a(prev), b(cur);
+        ASSERT_TRUE(same_values(a, prev)); // also fills the caches
+        ASSERT_TRUE(same_values(b, cur));
+        a.swap(b);
+        ASSERT_TRUE(same_values(a, cur)) << " after swap for text " << i;
+        ASSERT_TRUE(same_values(b, prev)) << " after swap for text " << i;
+        a = prev;
+        ASSERT_TRUE(same_values(a, prev)) << " after operator= for text " << i;
+        std::stringstream ss;
+        cur.serialize(ss);
+        a.load(ss);
+        ASSERT_TRUE(same_values(a, cur)) << " after load for text " << i;
+    }
+}
+
+//! Test count_many for patterns which are as long as the text (deep tries)
+TYPED_TEST(CsaTest, CountManyLongPatterns)
+{
+    for (size_type i=0; i < this->texts.size(); ++i) {
+        const std::string& text = this->texts[i];
+        size_type n = text.size();
+        std::vector<std::string> patterns;
+        for (size_type k=0; k < 8 and k+1 < n; ++k) {
+            patterns.push_back(text.substr(k, n-1-k)); // suffixes of the text without the sentinel
+            patterns.push_back(text.substr(0, n-1-k)); // prefixes of the text
+        }
+        std::vector<size_type> counts;
+        sdsl::algorithm::count_many(this->csas[i], patterns, counts);
+        ASSERT_EQ(patterns.size(), counts.size());
+        for (size_type k=0; k < patterns.size(); ++k) {
+            size_type l_res = 0, r_res = 0;
+            size_type cnt = sdsl::algorithm::backward_search(this->csas[i], 0, this->csas[i].size()-1,
+                            (const unsigned char*)patterns[k].c_str(), patterns[k].size(), l_res, r_res);
+            ASSERT_EQ(cnt, counts[k]) << " for pattern " << k << " of text " << i;
+        }
+    }
+}
+
+//! Test that several threads can query the same csa concurrently
+TYPED_TEST(CsaTest, ConcurrentAccess)
+{
+    for (size_type i=0; i < this->texts.size(); ++i) {
+        std::vector<size_type> sa(this->csas[i].size());
+        for (size_type j=0; j < sa.size(); ++j)
+            sa[j] = this->csas[i][j];
+        std::vector<access_task<TypeParam> > tasks(4);
+        for (size_type t=0; t < tasks.size(); ++t) {
+            tasks[t].csa = &this->csas[i];
+            tasks[t].sa = &sa;
+        }
+        sdsl::parallel::run(tasks);
+        for (size_type t=0; t < tasks.size(); ++t) {
+            ASSERT_EQ((size_type)0, tasks[t].errors) << " in thread " << t << " for text " << i;
+        }
+    }
+}
+
+//! Test that weighted_sampling samples the heavy text positions and stays within the budget
+TEST(CsaWeightedSamplingTest, HeavyPositions)
+{
+    typedef sdsl::csa_wt<sdsl::wt_huff<>, 16, 256, 0, unsigned char, sdsl::weighted_sampling<> > tCsa;
+    srand(17);
+    std::string text;
+    for (size_type i=0; i < 30000; ++i) text += (char)('a' + rand()%3);
+    size_type n = text.size()+1;
+    sdsl::int_vector<> sa(n, 0, sdsl::bit_magic::l1BP(n+1)+1);
+    sdsl::algorithm::calculate_sa((const unsigned char*)text.c_str(), n, sa);
+    sdsl::int_vector<> weights(n, 0);
+    for (size_type j=10000; j < 10200; ++j) weights[j] = 100; // heavy region
+    for (size_type k=0; k < 500; ++k) weights[rand()%n] = 1;   // light positions
+
+    std::string file = "csa_weighted_test.txt", weights_file = "csa_weighted_test_weights";
+    sdsl::file::write_text(file.c_str(), text.data(), text.size());
+    ASSERT_TRUE(sdsl::util::store_to_file(weights, weights_file.c_str()));
+    for (size_type t=0; t < 2; ++t) {
+        tCsa csa;
+        sdsl::tMSS file_map;
+        file_map["sample_weights"] = weights_file;
+        if (t == 0) {
+            ASSERT_TRUE(sdsl::construct_csa(file, csa, file_map, true, "./", "csa_weighted_test"));
+        } else {
+            ASSERT_TRUE(sdsl::construct_csa_without_sa(file, csa, file_map, true, "./", "csa_weighted_test"));
+        }
+        // the weights are an input of the caller and are not deleted with the temporary files
+        sdsl::int_vector<> stored_weights;
+        ASSERT_TRUE(sdsl::util::load_from_file(stored_weights, weights_file.c_str()));
+        ASSERT_EQ(weights, stored_weights);
+        ASSERT_EQ(weights_file, file_map["sample_weights"]);
+        ASSERT_EQ(n, csa.size());
+        ASSERT_GE((n+15)/16, csa.sa_sample.size());
+        for (size_type i=0; i < n; ++i) {
+            ASSERT_EQ(sa[i], csa[i]) << " at position " << i;
+            ASSERT_EQ(i, csa(sa[i])) << " at position " << i;
+        }
+        for (size_type j=10000; j < 10200; ++j) {
+            ASSERT_TRUE(csa.sa_sample.is_sampled(csa(j))) << " heavy position " << j << " is not sampled";
+        }
+        ASSERT_EQ(text.substr(10050, 30), sdsl::algorithm::extract(csa, 10050, 10079));
+    }
+    std::remove(file.c_str());
+    std::remove(weights_file.c_str());
+
+    sdsl::int_vector<> wrong(n/2, 1);
+    tCsa::sa_sample_type sample;
+    ASSERT_THROW(sample.init(n, &wrong), std::logic_error);
+}
+
+//! Test that samples of 32-bit width are rejected for suffix arrays with more than 2^32 entries
+TEST(CsaSamplingTest, IntWidth)
+{
+    size_type n = (1ULL<<32)+5;
+    sdsl::sa_order_sa_sample<32, sdsl::int_vector<32> > sample32;
+    ASSERT_THROW(sample32.init(n), std::length_error);
+    sample32.init(1000);
+    ASSERT_EQ((size_type)32, sample32.size());
+
+    sdsl::sa_order_sa_sample<1<<20, sdsl::int_vector<> > sample;
+    sample.init(n);
+    sample.add(1<<20, n-1);
+    ASSERT_EQ(n-1, sample.sa_value(1<<20));
+}
+
+}// end namespace
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
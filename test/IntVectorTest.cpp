@@ -1,10 +1,12 @@
 #include "sdsl/int_vector.hpp"
 #include "sdsl/bitmagic.hpp"
 #include "sdsl/util.hpp"
+#include "sdsl/parallel.hpp"
 #include "gtest/gtest.h"
 #include <vector>
 #include <cstdlib> // for rand()
 #include <string>
+#include <cstdio> // for remove
 
 namespace
 {
@@ -150,6 +152,164 @@ TEST_F(IntVectorTest, SerializeAndLoad)
         EXPECT_EQ(iv[i], iv2[i]);
 }
 
+template<class t_iv>
+void test_mmap_load(const t_iv& iv, const std::string& file_name, bool aligned)
+{
+    if (aligned) {
+        ASSERT_TRUE(sdsl::util::store_to_mmap_file(iv, file_name.c_str()));
+    } else {
+        ASSERT_TRUE(sdsl::util::store_to_file(iv, file_name.c_str()));
+    }
+    t_iv iv2;
+    ASSERT_TRUE(sdsl::util::load_from_mmap_file(iv2, file_name.c_str()));
+    ASSERT_EQ(iv.size(), iv2.size());
+    ASSERT_EQ(iv.get_int_width(), iv2.get_int_width());
+    if (aligned and iv.size() > 0) {
+        ASSERT_TRUE(sdsl::mm::in_region(iv2.data())); // payload is not copied
+    }
+    for (size_type i=0; i<iv.size(); ++i)
+        EXPECT_EQ(iv[i], iv2[i]);
+    if (iv2.size() > 0) { // modifications are private to the process
+        iv2[0] = 1-iv2[0];
+        t_iv iv3;
+        ASSERT_TRUE(sdsl::util::load_from_mmap_file(iv3, file_name.c_str()));
+        EXPECT_EQ(iv[0], iv3[0]);
+        EXPECT_NE(iv2[0], iv3[0]);
+    }
+    iv2.resize(iv2.size()+64); // copies the payload into malloced memory
+    ASSERT_FALSE(sdsl::mm::in_region(iv2.data()));
+    for (size_type i=1; i<iv.size(); ++i)
+        EXPECT_EQ(iv[i], iv2[i]);
+}
+
+TEST_F(IntVectorTest, MmapLoad)
+{
+    std::string file_name = "/tmp/int_vector_mmap";
+    for (size_type i=0; i < vec_sizes.size(); i+=7) {
+        sdsl::int_vector<> iv(vec_sizes[i], 0, 1 + i%64);
+        for (size_type j=0; j<iv.size(); ++j)
+            iv[j] = rand();
+        sdsl::bit_vector bv(vec_sizes[i]);
+        for (size_type j=0; j<bv.size(); ++j)
+            bv[j] = rand()%2;
+        sdsl::int_vector<64> iv64(vec_sizes[i]/8);
+        for (size_type j=0; j<iv64.size(); ++j)
+            iv64[j] = rand();
+        for (int aligned=0; aligned < 2; ++aligned) {
+            test_mmap_load(iv, file_name, aligned);
+            test_mmap_load(bv, file_name, aligned);
+            test_mmap_load(iv64, file_name, aligned);
+        }
+    }
+    std::remove(file_name.c_str());
+}
+
+//! Loads a mapped file and copies, resizes and destroys the loaded vectors.
+struct mmap_load_task {
+    std::string file_name;
+    const sdsl::int_vector<>* iv;
+    size_type errors;
+    mmap_load_task(const std::string& file_name, const sdsl::int_vector<>* iv):file_name(file_name), iv(iv), errors(0) {}
+    void operator()() {
+        for (size_type k=0; k < 200; ++k) {
+            sdsl::int_vector<> iv2;
+            if (!sdsl::util::load_from_mmap_file(iv2, file_name.c_str()) or !sdsl::mm::in_region(iv2.data()))
+                ++errors;
+            sdsl::int_vector<> iv3(iv2);
+            iv2.resize(iv2.size()+k);
+            for (size_type i=0; i < iv->size(); i += 97)
+                if ((*iv)[i] != iv2[i] or (*iv)[i] != iv3[i])
+                    ++errors;
+        }
+    }
+};
+
+//! Test that mappings can be loaded and released by several threads
+TEST_F(IntVectorTest, ConcurrentMmapLoad)
+{
+    std::string file_name = "/tmp/int_vector_mmap_concurrent";
+    sdsl::int_vector<> iv(100000, 0, 17);
+    for (size_type j=0; j<iv.size(); ++j)
+        iv[j] = rand();
+    ASSERT_TRUE(sdsl::util::store_to_mmap_file(iv, file_name.c_str()));
+    std::vector<mmap_load_task> tasks(4, mmap_load_task(file_name, &iv));
+    sdsl::parallel::run(tasks);
+    for (size_type t=0; t < tasks.size(); ++t)
+        ASSERT_EQ((size_type)0, tasks[t].errors) << " in thread " << t;
+    std::remove(file_name.c_str());
+}
+
+TEST_F(IntVectorTest, AllocationPolicies)
+{
+    sdsl::mm_policy_type policies[] = {sdsl::MM_HUGEPAGE, sdsl::MM_THP, sdsl::MM_NUMA_LOCAL, sdsl::MM_MALLOC};
+    sdsl::int_vector<> malloced(1000, 3);
+    for (size_type p=0; p < 4; ++p) {
+        sdsl::mm::set_policy(policies[p], 1<<22);
+        std::vector<sdsl::int_vector<> > vs(8);
+        for (size_type i=0; i < vec_sizes.size(); ++i) {
+            sdsl::int_vector<>& iv = vs[i%vs.size()];
+            size_type old_size = iv.size();
+            iv.resize(old_size + vec_sizes[i]%100000);
+            for (size_type j=old_size; j < iv.size(); ++j)
+                iv[j] = j;
+            for (size_type j=0; j < iv.size(); ++j)
+                ASSERT_EQ(j, iv[j]);
+            if (policies[p] == sdsl::MM_THP and iv.size() > 0) {  // anonymous mappings are always available
+                ASSERT_EQ(sdsl::MM_THP, sdsl::mm::region_kind(iv.data()));
+            }
+        }
+        sdsl::int_vector<> copy(vs[0]);
+        ASSERT_TRUE(copy == vs[0]);
+        malloced.swap(copy);
+        for (size_type j=0; j < malloced.size(); ++j)
+            ASSERT_EQ(j, malloced[j]);
+    }
+    ASSERT_EQ(sdsl::MM_MALLOC, sdsl::mm::policy());
+}
+
+struct two_vectors {
+    sdsl::int_vector<> a;
+    sdsl::bit_vector b;
+};
+
+TEST_F(IntVectorTest, HugepageStats)
+{
+    two_vectors s;
+    s.a = sdsl::int_vector<>(1<<20, 7);
+    s.b = sdsl::bit_vector(1<<24, 1);
+    sdsl::int_vector<> other(1000, 5);
+    sdsl::int_vector<> odd(1001, 5, 13); // bit_size%64 != 0, no padding word is allocated
+    ASSERT_TRUE(sdsl::mm::map_hp()); // falls back to transparent huge pages
+    ASSERT_TRUE(sdsl::mm::in_hp_region(odd.data()));
+    ASSERT_TRUE(sdsl::mm::in_hp_region(s.a.data()));
+    sdsl::mm_hp_stats stats = sdsl::mm::hugepage_stats(s);
+    EXPECT_EQ((size_type)2, stats.vectors);
+    EXPECT_EQ((s.a.capacity()+s.b.capacity())/8, stats.bytes);
+    std::vector<sdsl::mm_item_info> infos;
+    sdsl::mm::item_infos(infos);
+    EXPECT_LE(stats.vectors+1, infos.size());
+    size_type found = 0;
+    for (size_type i=0; i < infos.size(); ++i) {
+        if (infos[i].vector == &s.b) {
+            ++found;
+            EXPECT_EQ(s.b.data(), infos[i].data);
+            EXPECT_EQ(s.b.capacity()/8, infos[i].bytes);
+            EXPECT_EQ(sdsl::mm::region_kind(s.b.data()), infos[i].kind);
+        }
+    }
+    EXPECT_EQ((size_type)1, found);
+    // the kernel may back parts of the region by 4K pages, so full coverage is not guaranteed
+    EXPECT_LE(stats.hugepage_bytes, stats.bytes);
+    ASSERT_TRUE(sdsl::mm::unmap_hp());
+    ASSERT_FALSE(sdsl::mm::in_region(s.a.data()));
+    EXPECT_EQ((size_type)0, sdsl::mm::hugepage_stats(s).hugepage_bytes);
+    for (size_type i=0; i < s.a.size(); ++i)
+        ASSERT_EQ((size_type)7, s.a[i]);
+    ASSERT_EQ(s.b.size(), sdsl::util::get_one_bits(s.b));
+    for (size_type i=0; i < odd.size(); ++i)
+        ASSERT_EQ((size_type)5, odd[i]);
+}
+
 // Tests that the Foo::Bar() method does Abc.
 //TEST_F(FooTest, MethodBarDoesAbc) {
 //	const string input_filepath = "test_cases/100a.txt";
@@ -0,0 +1,212 @@
+#include "sdsl/int_vector.hpp"
+#include "sdsl/rank_support_v.hpp"
+#include "sdsl/rank_support_v5.hpp"
+#include "sdsl/select_support_mcl.hpp"
+#include "sdsl/rrr_vector.hpp"
+#include "sdsl/sd_vector.hpp"
+#include "sdsl/wt_huff.hpp"
+#include "sdsl/util.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdlib> // for rand()
+
+// The tests of this file check the data structures for inputs with more than 2^32
+// elements. They need about 2 GB of main memory and 5 GB of disk space and are
+// therefore disabled by default; `make large_test` runs them.
+
+namespace
+{
+
+typedef sdsl::int_vector<>::size_type size_type;
+typedef sdsl::bit_vector bit_vector;
+
+const size_type N = (1ULL<<32) + 1000003;     // not a multiple of 64
+const size_type N_BITS = 3*(1ULL<<31) + 1000003; // more than 2^32 1-bits in fill_mod3
+
+//! Positions around 2^31 and 2^32 and random positions in [0..n].
+std::vector<size_type> query_positions(size_type n)
+{
+    size_type fixed[] = {0, 1, 63, 64, (1ULL<<31)-1, 1ULL<<31, (1ULL<<32)-1, 1ULL<<32, (1ULL<<32)+1, (1ULL<<32)+64, 3*(1ULL<<31), n-1, n};
+    std::vector<size_type> pos;
+    for (size_type i=0; i < sizeof(fixed)/sizeof(fixed[0]); ++i)
+        if (fixed[i] <= n)
+            pos.push_back(fixed[i]);
+    srand(17);
+    for (size_type i=0; i < 2000; ++i) {
+        pos.push_back(((((size_type)rand())<<31) | rand()) % (n+1));
+    }
+    return pos;
+}
+
+//! Bit i is set iff i is not divisible by 3, so rank and select have a closed form.
+void fill_mod3(bit_vector& bv)
+{
+    uint64_t w[3] = {0, 0, 0}; // w[r] is the word which starts at a position p with p%3 == r
+    for (size_type r=0; r < 3; ++r)
+        for (size_type j=0; j < 64; ++j)
+            if ((r+j)%3 != 0)
+                w[r] |= 1ULL<<j;
+    for (size_type k=0; k+64 <= bv.size(); k += 64)
+        bv.set_int(k, w[k%3], 64);
+    for (size_type k=bv.size()/64*64; k < bv.size(); ++k)
+        bv[k] = (k%3 != 0);
+}
+
+size_type rank1_mod3(size_type i)
+{
+    return i - (i+2)/3;
+}
+
+size_type select1_mod3(size_type k)
+{
+    return 3*((k-1)/2) + 1 + (k-1)%2;
+}
+
+//! Test rank and select on a bit_vector with more than 2^32 1-bits
+TEST(LargeTest, DISABLED_RankAndSelect)
+{
+    bit_vector bv(N_BITS);
+    fill_mod3(bv);
+    std::vector<size_type> pos = query_positions(N_BITS);
+    size_type ones = rank1_mod3(N_BITS), zeros = N_BITS-ones;
+    ASSERT_GT(ones, 1ULL<<32);
+    {
+        sdsl::rank_support_v<> rank(&bv);
+        sdsl::rank_support_v5<> rank5(&bv);
+        for (size_type k=0; k < pos.size(); ++k) {
+            ASSERT_EQ(rank1_mod3(pos[k]), rank(pos[k])) << " at position " << pos[k];
+            ASSERT_EQ(rank1_mod3(pos[k]), rank5(pos[k])) << " at position " << pos[k];
+        }
+    }
+    {
+        sdsl::select_support_mcl<1> select1(&bv);
+        sdsl::select_support_mcl<0> select0(&bv);
+        for (size_type k=0; k < pos.size(); ++k) {
+            size_type i = pos[k]%ones + 1, j = pos[k]%zeros + 1;
+            ASSERT_EQ(select1_mod3(i), select1(i)) << " for the " << i << "-th 1-bit";
+            ASSERT_EQ(3*(j-1), select0(j)) << " for the " << j << "-th 0-bit";
+        }
+        ASSERT_EQ(select1_mod3(ones), select1(ones));
+    }
+    {
+        sdsl::rrr_vector<> rrr(bv);
+        sdsl::rrr_vector<>::rank_1_type rank(&rrr);
+        sdsl::rrr_vector<>::select_1_type select(&rrr);
+        for (size_type k=0; k < pos.size(); ++k) {
+            ASSERT_EQ(rank1_mod3(pos[k]), rank(pos[k])) << " at position " << pos[k];
+            size_type i = pos[k]%ones + 1;
+            ASSERT_EQ(select1_mod3(i), select(i)) << " for the " << i << "-th 1-bit";
+        }
+    }
+    {
+        // a sparse vector with a 1-bit at each multiple of 1000 in a universe of more than 2^32
+        sdsl::util::set_zero_bits(bv);
+        for (size_type i=0; i < N_BITS; i += 1000)
+            bv[i] = 1;
+        sdsl::sd_vector<> sd(bv);
+        sdsl::util::clear(bv);
+        sdsl::sd_vector<>::rank_1_type rank(&sd);
+        sdsl::sd_vector<>::select_1_type select(&sd);
+        ASSERT_EQ(N_BITS, sd.size());
+        for (size_type k=0; k < pos.size(); ++k) {
+            ASSERT_EQ((pos[k]+999)/1000, rank(pos[k])) << " at position " << pos[k];
+            size_type i = pos[k]%((N_BITS+999)/1000) + 1;
+            ASSERT_EQ((i-1)*1000, select(i)) << " for the " << i << "-th 1-bit";
+        }
+    }
+}
+
+//! The text of the wavelet tree test: character i is "aaabc"[i%5].
+const char text_period[] = "aaabc";
+
+//! Number of occurrences of c in the prefix [0..i-1] of the text.
+size_type text_rank(size_type i, char c)
+{
+    size_type per_period = 0, in_prefix = 0;
+    for (size_type r=0; r < 5; ++r) {
+        if (text_period[r] == c) {
+            ++per_period;
+            if (r < i%5)
+                ++in_prefix;
+        }
+    }
+    return (i/5)*per_period + in_prefix;
+}
+
+//! Position of the k-th occurrence of c in the text.
+size_type text_select(size_type k, char c)
+{
+    std::vector<size_type> rs;
+    for (size_type r=0; r < 5; ++r)
+        if (text_period[r] == c)
+            rs.push_back(r);
+    return 5*((k-1)/rs.size()) + rs[(k-1)%rs.size()];
+}
+
+//! Test int_vector_file_buffer and wt_huff for a text with more than 2^32 characters
+TEST(LargeTest, DISABLED_WtHuffFromFileBuffer)
+{
+    std::string file = "tmp_large_test_" + sdsl::util::to_string(sdsl::util::get_pid());
+    {
+        // write the text as int_vector<8> in blocks, as it does not fit into main memory twice
+        std::ofstream out(file.c_str(), std::ios::binary | std::ios::trunc);
+        uint64_t bit_size = N*8;
+        out.write((char*)&bit_size, sizeof(bit_size));
+        std::vector<char> block(5*(1<<20));
+        for (size_type j=0; j < block.size(); ++j)
+            block[j] = text_period[j%5];
+        size_type written = 0, bytes = ((N+7)/8)*8; // the payload consists of 64-bit words
+        while (written < bytes) {
+            size_type len = std::min((size_type)block.size(), bytes-written);
+            out.write(&block[0], len);
+            written += len;
+        }
+        ASSERT_TRUE(out.good());
+    }
+    {
+        sdsl::int_vector_file_buffer<8> buf(file.c_str(), 1000003); // the blocks do not start at word boundaries
+        ASSERT_EQ(N, buf.int_vector_size);
+        size_type errors = 0;
+        for (size_type i=0, r_sum=0, r=buf.load_next_block(); r_sum < N;) {
+            for (; i < r_sum+r; ++i)
+                if (buf[i-r_sum] != (unsigned char)text_period[i%5])
+                    ++errors;
+            r_sum += r; r = buf.load_next_block();
+        }
+        ASSERT_EQ((size_type)0, errors);
+    }
+    sdsl::wt_huff<> wt;
+    {
+        sdsl::int_vector_file_buffer<8> buf(file.c_str());
+        wt.construct(buf, N);
+    }
+    std::remove(file.c_str());
+    ASSERT_EQ(N, wt.size());
+    std::vector<size_type> pos = query_positions(N);
+    for (size_type k=0; k < pos.size(); ++k) {
+        size_type i = pos[k];
+        if (i < N) {
+            ASSERT_EQ((unsigned char)text_period[i%5], wt[i]) << " at position " << i;
+            unsigned char c;
+            size_type r = wt.rank_ith_symbol(i, c);
+            ASSERT_EQ(text_rank(i, c), r) << " at position " << i;
+        }
+        for (size_type j=0; j < 3; ++j) {
+            char c = "abc"[j];
+            ASSERT_EQ(text_rank(i, c), wt.rank(i, c)) << " at position " << i << " for " << c;
+            size_type occ = text_rank(N, c);
+            size_type kk = i%occ + 1;
+            ASSERT_EQ(text_select(kk, c), wt.select(kk, c)) << " for the " << kk << "-th " << c;
+        }
+    }
+}
+
+}// end namespace
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
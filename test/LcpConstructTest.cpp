@@ -5,6 +5,7 @@
 #include "gtest/gtest.h"
 #include <vector>
 #include <string>
+#include <cstdlib> // for rand()
 
 namespace
 {
@@ -12,6 +13,11 @@ namespace
 typedef sdsl::int_vector<>::size_type size_type;
 typedef std::map<std::string, bool (*)(sdsl::tMSS&, const std::string&, const std::string&)> tMSFP;
 
+bool construct_lcp_PHI_parallel_3(sdsl::tMSS& file_map, const std::string& dir, const std::string& id)
+{
+    return sdsl::construct_lcp_PHI_parallel(file_map, dir, id, 3);
+}
+
 
 // The fixture for testing class int_vector.
 class LcpConstructTest : public ::testing::Test
@@ -48,6 +54,7 @@ class LcpConstructTest : public ::testing::Test
 			lcp_function["construct_lcp_go2"] = &sdsl::construct_lcp_go2;
 			lcp_function["construct_lcp_bwt_based"] = &sdsl::construct_lcp_bwt_based;
 			lcp_function["construct_lcp_bwt_based2"] = &sdsl::construct_lcp_bwt_based2;
+			lcp_function["construct_lcp_PHI_parallel"] = &construct_lcp_PHI_parallel_3;
 
 
 			string dir = "";
@@ -163,6 +170,50 @@ TEST_F(LcpConstructTest, construct_lcp)
 	}
 }
 
+//! Test that the multi-threaded PHI algorithm produces the same lcp array as the sequential one
+TEST(LcpConstructParallelTest, construct_lcp_PHI_parallel)
+{
+    std::vector<std::string> texts;
+    srand(17);
+    texts.push_back(std::string(1, '\0'));
+    texts.push_back(std::string(100000, 'a') + '\0');                 // large lcp-values at the part borders
+    std::string s;
+    for (size_type i=0; i < 200000; ++i) s += (char)('a' + rand()%2);  // binary alphabet
+    texts.push_back(s + '\0');
+    s = "abracadabra";
+    while (s.size() < 300000) s += s.substr(0, s.size()/2 + 1);        // long repeats
+    texts.push_back(s + '\0');
+
+    std::string dir = "./", id = "lcp_construct_parallel_test";
+    for (size_type i=0; i < texts.size(); ++i) {
+        const unsigned char* text = (const unsigned char*)texts[i].data();
+        size_type n = texts[i].size();
+        sdsl::int_vector<> sa(n, 0, sdsl::bit_magic::l1BP(n+1)+1);
+        sdsl::algorithm::calculate_sa(text, n, sa);
+        sdsl::tMSS file_map;
+        ASSERT_TRUE(sdsl::util::store_to_file(sdsl::char_array_serialize_wrapper<>((unsigned char*)text, n), (dir+"text_"+id).c_str()));
+        file_map["text"] = dir+"text_"+id;
+        ASSERT_TRUE(sdsl::util::store_to_file(sa, (dir+"sa_"+id).c_str()));
+        file_map["sa"] = dir+"sa_"+id;
+        ASSERT_TRUE(sdsl::construct_lcp_PHI(file_map, dir, id));
+        sdsl::int_vector<> lcp;
+        ASSERT_TRUE(sdsl::util::load_from_file(lcp, file_map["lcp"].c_str()));
+        uint32_t threads[] = {2, 3, 8};
+        for (size_type t=0; t < 3; ++t) {
+            ASSERT_TRUE(sdsl::construct_lcp_PHI_parallel(file_map, dir, id+"_p", threads[t]));
+            sdsl::int_vector<> plcp;
+            ASSERT_TRUE(sdsl::util::load_from_file(plcp, file_map["lcp"].c_str()));
+            ASSERT_EQ(lcp.get_int_width(), plcp.get_int_width());
+            ASSERT_EQ(lcp.size(), plcp.size());
+            for (size_type j=0; j < n; ++j) {
+                ASSERT_EQ(lcp[j], plcp[j]) << " at position " << j << " of text " << i << " with " << threads[t] << " threads";
+            }
+        }
+        std::remove((dir+"lcp_"+id).c_str());
+        sdsl::util::delete_all_files(file_map);
+    }
+}
+
 }  // namespace
 
 int main(int argc, char** argv)
@@ -1,6 +1,6 @@
 CC=g++
 CC_FLAGS=-Wall -g -O3 -I@CMAKE_INSTALL_PREFIX@/include -L@CMAKE_INSTALL_PREFIX@/lib -DNDEBUG -funroll-loops 
-CCLIB=-lsdsl -ldivsufsort -ldivsufsort64 -lgtest 
+CCLIB=-lsdsl -ldivsufsort -ldivsufsort64 -lgtest -lpthread
 SOURCES=$(wildcard *Test.cpp)
 EXECS=$(SOURCES:.cpp=)
 EXEC_LIST=$(patsubst %,./%;,$(EXECS))                # list of executables
@@ -24,3 +24,7 @@ test:
 vtest:
 	./test_cases/small/get_corpus.sh
 	$(EXEC_LIST_VAL)
+
+# runs the disabled tests for inputs with more than 2^32 elements
+large_test: LargeTest
+	./LargeTest --gtest_also_run_disabled_tests
@@ -0,0 +1,137 @@
+#include "sdsl/fast_cache.hpp"
+#include "sdsl/parallel.hpp"
+#include "gtest/gtest.h"
+#include <vector>
+
+namespace
+{
+
+typedef sdsl::int_vector<>::size_type size_type;
+
+//! The answer which is cached for request i.
+size_type answer(size_type i)
+{
+    return 3*i+1;
+}
+
+//! A task which writes and reads the answers of random requests.
+template<class Cache>
+struct cache_task {
+    Cache* cache;
+    size_type seed, hits, errors;
+    void operator()() {
+        hits = errors = 0;
+        uint64_t x = seed;
+        for (size_type k=0; k < 2000000; ++k) {
+            x = x*6364136223846793005ULL + 1442695040888963407ULL;
+            size_type i = (x >> 33) % 5000, a = 0;
+            if (cache->exists(i, a)) {
+                ++hits;
+                if (a != answer(i))
+                    ++errors;
+            } else {
+                cache->write(i, answer(i));
+            }
+        }
+    }
+};
+
+template<class T>
+class QueryCacheTest : public ::testing::Test { };
+
+using testing::Types;
+
+typedef Types<
+sdsl::fast_cache,
+     sdsl::query_cache<4, 4, sdsl::cache_replace_lru, true>,
+     sdsl::query_cache<8, 2, sdsl::cache_replace_fifo, true>,
+     sdsl::query_cache<12, 4, sdsl::cache_replace_lru>
+     > Implementations;
+
+TYPED_TEST_CASE(QueryCacheTest, Implementations);
+
+//! Test that a written answer is found
+TYPED_TEST(QueryCacheTest, WriteAndExists)
+{
+    TypeParam cache;
+    size_type a = 0;
+    ASSERT_FALSE(cache.exists(17, a));
+    cache.write(17, answer(17));
+    ASSERT_TRUE(cache.exists(17, a));
+    ASSERT_EQ(answer(17), a);
+    cache.write(17, answer(18)); // overwrites the answer
+    ASSERT_TRUE(cache.exists(17, a));
+    ASSERT_EQ(answer(18), a);
+    for (size_type i=0; i < TypeParam::capacity(); ++i) // fills the cache
+        cache.write(i, answer(i));
+    for (size_type i=0; i < TypeParam::capacity(); ++i) {
+        ASSERT_TRUE(cache.exists(i, a)) << " for request " << i;
+        ASSERT_EQ(answer(i), a);
+    }
+}
+
+//! Test that concurrent readers never see a mixed entry
+TYPED_TEST(QueryCacheTest, Concurrent)
+{
+    TypeParam cache;
+    std::vector<cache_task<TypeParam> > tasks(8);
+    for (size_type t=0; t < tasks.size(); ++t) {
+        tasks[t].cache = &cache;
+        tasks[t].seed = t+1;
+    }
+    sdsl::parallel::run(tasks);
+    for (size_type t=0; t < tasks.size(); ++t) {
+        ASSERT_EQ((size_type)0, tasks[t].errors) << " in thread " << t;
+        ASSERT_LT((size_type)0, tasks[t].hits);
+    }
+}
+
+//! Test the replacement policies and the counters on a cache with one set of two entries
+TEST(QueryCacheTest, Replacement)
+{
+    size_type a = 0;
+    sdsl::query_cache<0, 2, sdsl::cache_replace_lru, true> lru;
+    lru.write(1, answer(1));
+    lru.write(2, answer(2));
+    ASSERT_TRUE(lru.exists(1, a));
+    lru.write(3, answer(3)); // replaces 2, which was used least recently
+    ASSERT_TRUE(lru.exists(1, a));
+    ASSERT_FALSE(lru.exists(2, a));
+    ASSERT_TRUE(lru.exists(3, a));
+    ASSERT_EQ((size_type)3, lru.hits());
+    ASSERT_EQ((size_type)1, lru.misses());
+    lru.reset_counters();
+    ASSERT_EQ((size_type)0, lru.hits() + lru.misses());
+
+    sdsl::query_cache<0, 2, sdsl::cache_replace_fifo, true> fifo;
+    fifo.write(1, answer(1));
+    fifo.write(2, answer(2));
+    ASSERT_TRUE(fifo.exists(1, a));
+    fifo.write(3, answer(3)); // replaces 1, which was written first
+    ASSERT_FALSE(fifo.exists(1, a));
+    ASSERT_TRUE(fifo.exists(2, a));
+    ASSERT_TRUE(fifo.exists(3, a));
+    ASSERT_EQ((size_type)3, fifo.hits());
+    ASSERT_EQ((size_type)1, fifo.misses());
+}
+
+//! Test that fast_cache is direct mapped, i.e. a request replaces the entry of its slot
+TEST(QueryCacheTest, FastCacheReplacement)
+{
+    sdsl::fast_cache cache;
+    size_type a = 0;
+    cache.write(17, answer(17));
+    ASSERT_TRUE(cache.exists(17, a));
+    cache.write(17 + 0x400, answer(17 + 0x400)); // replaces the entry of 17
+    ASSERT_FALSE(cache.exists(17, a));
+    ASSERT_TRUE(cache.exists(17 + 0x400, a));
+    ASSERT_EQ(answer(17 + 0x400), a);
+}
+
+}// end namespace
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -131,6 +131,86 @@ TYPED_TEST(RankSupportTest, RankMethod)
     }
 }
 
+template<class T>
+class RankSupportBatchTest : public RankSupportTest<T> { };
+
+typedef Types<
+sdsl::rank_support_v<>,
+     sdsl::rank_support_v5<>,
+     sdsl::rank_support_v<0>,
+     sdsl::rank_support_v5<10,2>,
+     sdsl::rrr_rank_support<>,
+     sdsl::rrr_rank_support<1, 63>,
+     sdsl::rrr_rank_support<1, 15>
+     > BatchImplementations;
+
+TYPED_TEST_CASE(RankSupportBatchTest, BatchImplementations);
+
+//! Test the batched rank method against the scalar one
+TYPED_TEST(RankSupportBatchTest, BatchRankMethod)
+{
+    for (size_type i=0; i<this->n; ++i) {
+        typename TypeParam::bit_vector_type bv(this->bs[i]);
+        TypeParam rs(&bv);
+        std::vector<size_type> idx(1000), out(1000);
+        for (size_type j=0; j < idx.size(); ++j) {
+            idx[j] = rand() % (this->bs[i].size()+1);
+        }
+        for (size_type len=0; len <= idx.size(); len = 2*len+1) {
+            rs.rank(&idx[0], len, &out[0]);
+            for (size_type j=0; j < len; ++j) {
+                ASSERT_EQ(rs.rank(idx[j]), out[j]) << " at index "<< idx[j]
+                                                   <<" of vector "<<i<<" in batch of length "<<len;
+            }
+        }
+    }
+}
+
+template<class T>
+class RankSupportParallelTest : public ::testing::Test
+{
+    protected:
+        virtual void SetUp() {
+            srand(13);
+            size_type sizes[] = {1000000, 4194304, 8*4194304+333};
+            for (size_type i=0; i < 3; ++i) {
+                bs.push_back(bit_vector(sizes[i]));
+                sdsl::util::set_random_bits(bs.back(), 17+i);
+            }
+            bs.push_back(bit_vector(sizes[2], 0)); // sparse vector
+            for (size_type i=0; i < 1000; ++i) {
+                bs.back()[rand()%sizes[2]] = 1;
+            }
+        }
+
+        std::vector<bit_vector> bs;
+};
+
+typedef Types<
+sdsl::rank_support_v<>,
+     sdsl::rank_support_v<0>,
+     sdsl::rank_support_v<10,2>
+     > ParallelImplementations;
+
+TYPED_TEST_CASE(RankSupportParallelTest, ParallelImplementations);
+
+//! Test that the multi-threaded initialization equals the sequential one
+TYPED_TEST(RankSupportParallelTest, ParallelInit)
+{
+    for (size_type i=0; i < this->bs.size(); ++i) {
+        TypeParam rs(&this->bs[i]);
+        uint32_t threads[] = {2, 3, 8};
+        for (size_type t=0; t < 3; ++t) {
+            TypeParam prs;
+            sdsl::util::init_support(prs, &this->bs[i], threads[t]);
+            ASSERT_TRUE(rs == prs) << " for vector "<<i<<" with "<<threads[t]<<" threads";
+            for (size_type j=0; j <= this->bs[i].size(); j += 1+rand()%1000) {
+                ASSERT_EQ(rs.rank(j), prs.rank(j)) << " at index "<<j<<" of vector "<<i;
+            }
+        }
+    }
+}
+
 }// end namespace
 
 int main(int argc, char** argv)
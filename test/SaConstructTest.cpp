@@ -0,0 +1,114 @@
+#include "sdsl/int_vector.hpp"
+#include "sdsl/algorithms.hpp" // for algorithm::calculate_sa
+#include "sdsl/sa_construct.hpp"
+#include "sdsl/util.hpp"
+#include "sdsl/config.hpp" // for CMAKE_SOURCE_DIR
+#include "gtest/gtest.h"
+#include <vector>
+#include <string>
+#include <cstdlib> // for rand()
+
+namespace
+{
+
+typedef sdsl::int_vector<>::size_type size_type;
+
+class SaConstructTest : public ::testing::Test
+{
+    protected:
+
+        SaConstructTest() {}
+
+        virtual ~SaConstructTest() {}
+
+        virtual void SetUp() {
+            std::string test_cases_dir = std::string(SDSL_XSTR(CMAKE_SOURCE_DIR)) + "/test/test_cases";
+            const char* files[] = {"/crafted/100a.txt", "/crafted/abc_abc_abc.txt", "/crafted/abc_abc_abc2.txt",
+                                   "/crafted/empty.txt", "/crafted/example01.txt", "/small/faust.txt"
+                                  };
+            for (size_t i=0; i < sizeof(files)/sizeof(files[0]); ++i) {
+                char* text = NULL;
+                uint64_t n = sdsl::file::read_text((test_cases_dir + files[i]).c_str(), text);
+                if (n > 0) { // read_text appends a 0-byte
+                    texts.push_back(std::string(text, n));
+                    delete [] text;
+                }
+            }
+            srand(17);
+            texts.push_back(std::string(1, '\0'));
+            texts.push_back(std::string("b") + '\0');
+            texts.push_back(std::string(100000, 'a') + '\0');                 // one large group in every round
+            std::string s;
+            for (size_type i=0; i < 200000; ++i) s += (char)('a' + rand()%2);  // binary alphabet
+            texts.push_back(s + '\0');
+            s.clear();
+            for (size_type i=0; i < 100000; ++i) s += (char)(1 + rand()%254); // largest alphabet
+            texts.push_back(s + '\0');
+            s = "abracadabra";
+            while (s.size() < 300000) s += s.substr(0, s.size()/2 + 1);        // long repeats
+            texts.push_back(s + '\0');
+        }
+
+        std::vector<std::string> texts;
+};
+
+//! Test that the parallel suffix array construction produces the same suffix array as the sequential one
+TEST_F(SaConstructTest, ParallelConstruction)
+{
+    for (size_type i=0; i < texts.size(); ++i) {
+        const unsigned char* text = (const unsigned char*)texts[i].data();
+        size_type n = texts[i].size();
+        sdsl::int_vector<> sa(n, 0, sdsl::bit_magic::l1BP(n+1)+1);
+        sdsl::algorithm::calculate_sa(text, n, sa);
+        uint32_t threads[] = {2, 3, 8};
+        for (size_type t=0; t < 3; ++t) {
+            sdsl::int_vector<> psa(n, 0, sdsl::bit_magic::l1BP(n+1)+1);
+            sdsl::algorithm::calculate_sa(text, n, psa, threads[t]);
+            ASSERT_EQ(sa.size(), psa.size());
+            for (size_type j=0; j < n; ++j) {
+                ASSERT_EQ(sa[j], psa[j]) << " at position " << j << " of text " << i
+                                         << " of length " << n << " with " << threads[t] << " threads";
+            }
+        }
+    }
+}
+
+//! Test that the external memory construction produces the same suffix array and BWT as the in-memory one
+TEST_F(SaConstructTest, ExternalConstruction)
+{
+    for (size_type i=0; i < texts.size(); ++i) {
+        const unsigned char* text = (const unsigned char*)texts[i].data();
+        size_type n = texts[i].size();
+        sdsl::int_vector<> sa(n, 0, sdsl::bit_magic::l1BP(n+1)+1);
+        sdsl::algorithm::calculate_sa(text, n, sa);
+
+        sdsl::tMSS file_map;
+        std::string dir = "./", id = "sa_construct_test";
+        ASSERT_TRUE(sdsl::util::store_to_file(sdsl::char_array_serialize_wrapper<>((unsigned char*)text, n), (dir+"text_"+id).c_str()));
+        file_map["text"] = dir+"text_"+id;
+        // the smallest budget of 1 MB splits the tuples of the larger texts into several runs
+        ASSERT_TRUE(sdsl::construct_sa_extern(file_map, dir, id, 0));
+        sdsl::int_vector<> esa;
+        ASSERT_TRUE(sdsl::util::load_from_file(esa, file_map["sa"].c_str()));
+        ASSERT_EQ(sa.size(), esa.size());
+        for (size_type j=0; j < n; ++j) {
+            ASSERT_EQ(sa[j], esa[j]) << " at position " << j << " of text " << i << " of length " << n;
+        }
+        ASSERT_TRUE(sdsl::construct_bwt_extern(file_map, dir, id, 0));
+        sdsl::int_vector<8> bwt;
+        ASSERT_TRUE(sdsl::util::load_from_file(bwt, file_map["bwt"].c_str()));
+        ASSERT_EQ(n, bwt.size());
+        for (size_type j=0; j < n; ++j) {
+            ASSERT_EQ(text[(sa[j]+n-1)%n], bwt[j]) << " at position " << j << " of text " << i << " of length " << n;
+        }
+        sdsl::util::delete_all_files(file_map);
+    }
+}
+
+}// end namespace
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
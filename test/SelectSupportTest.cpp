@@ -8,6 +8,7 @@
 #include "sdsl/bitmagic.hpp"
 #include "gtest/gtest.h"
 #include <vector>
+#include <sstream>
 #include <cstdlib> // for rand()
 
 namespace
@@ -122,6 +123,88 @@ TYPED_TEST(SelectSupportTest, SelectMethod)
     }
 }
 
+template<class T>
+class SelectSupportBatchTest : public SelectSupportTest<T> { };
+
+TYPED_TEST_CASE(SelectSupportBatchTest, Types<sdsl::select_support_mcl<> >);
+
+//! Test the batched select method against the scalar one
+TYPED_TEST(SelectSupportBatchTest, BatchSelectMethod)
+{
+    for (size_type i=0; i<this->n; ++i) {
+        typename TypeParam::bit_vector_type bv(this->bs[i]);
+        TypeParam ss(&bv);
+        size_type ones = 0;
+        for (size_type j=0; j < bv.size(); ++j) {
+            ones += bv[j];
+        }
+        if (ones == 0)
+            continue;
+        std::vector<size_type> args(1000), out(1000);
+        for (size_type j=0; j < args.size(); ++j) {
+            args[j] = 1 + rand() % ones;
+        }
+        for (size_type len=0; len <= args.size(); len = 2*len+1) {
+            ss.select(&args[0], len, &out[0]);
+            for (size_type j=0; j < len; ++j) {
+                ASSERT_EQ(ss.select(args[j]), out[j]) << " at query "<<args[j]
+                                                      <<" of vector "<<i<<" in batch of length "<<len;
+            }
+        }
+    }
+}
+
+template<class T>
+class SelectSupportParallelTest : public ::testing::Test
+{
+    protected:
+        virtual void SetUp() {
+            srand(13);
+            size_type sizes[] = {1000000, 3*4194304+777, 8*4194304+333};
+            for (size_type i=0; i < 3; ++i) {
+                bs.push_back(bit_vector(sizes[i]));
+                sdsl::util::set_random_bits(bs.back(), 17+i);
+            }
+            bs.push_back(bit_vector(sizes[2], 0)); // sparse vector, i.e. long superblocks
+            for (size_type i=0; i < 100000; ++i) {
+                bs.back()[rand()%sizes[2]] = 1;
+            }
+            bs.push_back(bit_vector(sizes[2], 0)); // mix of sparse and dense regions
+            for (size_type i=0; i < 3000; ++i) {
+                size_type x = rand()%sizes[2], len = rand()%10000;
+                for (size_type j=x; j < x+len and j < sizes[2]; ++j) {
+                    bs.back()[j] = 1;
+                }
+            }
+        }
+
+        std::vector<bit_vector> bs;
+};
+
+typedef Types<sdsl::select_support_mcl<>,
+        sdsl::select_support_mcl<0>
+        > ParallelImplementations;
+
+TYPED_TEST_CASE(SelectSupportParallelTest, ParallelImplementations);
+
+//! Test that the multi-threaded initialization equals the sequential one
+TYPED_TEST(SelectSupportParallelTest, ParallelInit)
+{
+    for (size_type i=0; i < this->bs.size(); ++i) {
+        TypeParam ss(&this->bs[i]);
+        std::stringstream expected;
+        ss.serialize(expected);
+        uint32_t threads[] = {2, 3, 8};
+        for (size_type t=0; t < 3; ++t) {
+            TypeParam pss;
+            sdsl::util::init_support(pss, &this->bs[i], threads[t]);
+            std::stringstream result;
+            pss.serialize(result);
+            ASSERT_TRUE(expected.str() == result.str()) << " for vector "<<i<<" with "<<threads[t]<<" threads";
+        }
+    }
+}
+
 }// end namespace
 
 int main(int argc, char** argv)
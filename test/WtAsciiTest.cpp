@@ -1,4 +1,6 @@
+#include "sdsl/wt.hpp"
 #include "sdsl/wt_huff.hpp"
+#include "sdsl/wt_multiary.hpp"
 #include "sdsl/wt_rlg.hpp"
 #include "sdsl/wt_rlg8.hpp"
 #include "sdsl/wt_rlmn.hpp"
@@ -13,6 +15,7 @@
 #include <cstdlib> // for rand()
 #include <string>
 #include <algorithm> // for std::min
+#include <utility>
 
 namespace
 {
@@ -78,6 +81,8 @@ sdsl::wt<unsigned char*, sdsl::rrr_vector<63> >,
      sdsl::wt_huff<sdsl::bit_vector, sdsl::rank_support_v<> >,
      sdsl::wt_huff<sdsl::bit_vector, sdsl::rank_support_v5<> >,
      sdsl::wt_huff<sdsl::rrr_vector<63> >,
+     sdsl::wt_multiary<>,
+     sdsl::wt_multiary<2>,
      sdsl::wt_rlmn<>,
      sdsl::wt_rlmn<sdsl::bit_vector>,
      sdsl::wt_rlg<>,
@@ -175,6 +180,26 @@ TYPED_TEST(WtAsciiTest, Rank)
 }
 
 
+//! Test inverse_select, which returns the rank and the symbol at position i
+TYPED_TEST(WtAsciiTest, InverseSelect)
+{
+    for (size_t i=0; i< this->test_cases.size(); ++i) {
+        TypeParam wt;
+        ASSERT_EQ(this->load_wt(wt, i), true);
+        unsigned char* text = NULL;
+        size_type n = sdsl::file::read_text((this->test_cases[i]).c_str(), (char*&)text)-1;
+        ASSERT_EQ(n, wt.size());
+        std::vector<size_type> cnt(256, 0);
+        for (size_type j=0; j < n; ++j) {
+            std::pair<size_type, typename TypeParam::value_type> rc = sdsl::inverse_select(wt, j);
+            ASSERT_EQ(cnt[text[j]], rc.first)<<" j="<<j;
+            ASSERT_EQ((typename TypeParam::value_type)text[j], rc.second)<<" j="<<j;
+            cnt[text[j]]++;
+        }
+        delete [] text;
+    }
+}
+
 //! Test select methods
 TYPED_TEST(WtAsciiTest, Select)
 {
@@ -237,6 +262,151 @@ TYPED_TEST(WtAsciiTest, DeleteTest)
     }
 }
 
+//! A text over a skewed alphabet of size 40 for the range query tests
+sdsl::int_vector<8> range_test_text(size_type n)
+{
+    sdsl::int_vector<8> text(n);
+    srand(17);
+    for (size_type i=0; i < n; ++i)
+        text[i] = 'A' + (rand()%40) * (rand()%40) / 40;
+    return text;
+}
+
+//! Checks range_top_k on [lb..rb] against counting the symbols of text[lb..rb]
+template<class Wt>
+void check_range_top_k(const Wt& wt, const sdsl::int_vector<8>& text)
+{
+    for (size_type k=0; k < 200; ++k) {
+        size_type lb = rand()%text.size(), rb = std::min(text.size()-1, lb + rand()%3000);
+        std::vector<size_type> cnt(256, 0);
+        for (size_type i=lb; i <= rb; ++i)
+            ++cnt[text[i]];
+        size_type distinct = 256 - std::count(cnt.begin(), cnt.end(), (size_type)0);
+        size_type kk = 1 + rand()%45;
+        std::vector<std::pair<unsigned char, size_type> > res;
+        wt.range_top_k(lb, rb, kk, res);
+        ASSERT_EQ(std::min(kk, distinct), res.size());
+        for (size_type j=0; j < res.size(); ++j) {
+            ASSERT_EQ(cnt[res[j].first], res[j].second) << "symbol " << res[j].first;
+            if (j > 0) {
+                ASSERT_LE(res[j].second, res[j-1].second);
+            }
+            cnt[res[j].first] = 0; // reported symbols are removed
+        }
+        ASSERT_LE(*std::max_element(cnt.begin(), cnt.end()), res.back().second);
+    }
+}
+
+//! Test range_quantile and range_top_k of wt
+TEST(WtAsciiRangeTest, Wt)
+{
+    sdsl::int_vector<8> text = range_test_text(20000);
+    sdsl::wt<unsigned char*, sdsl::rrr_vector<63> > wt((unsigned char*)text.data(), text.size());
+    for (size_type k=0; k < 200; ++k) {
+        size_type lb = rand()%text.size(), rb = std::min(text.size()-1, lb + rand()%3000);
+        std::vector<unsigned char> sorted(text.begin()+lb, text.begin()+rb+1);
+        std::sort(sorted.begin(), sorted.end());
+        for (size_type j=0; j < 10; ++j) {
+            size_type q = rand()%(rb-lb+1);
+            std::pair<unsigned char, size_type> res = wt.range_quantile(lb, rb, q);
+            ASSERT_EQ(sorted[q], res.first) << "q=" << q << " in [" << lb << ".." << rb << "]";
+            size_type freq = std::upper_bound(sorted.begin(), sorted.end(), sorted[q])
+                             - std::lower_bound(sorted.begin(), sorted.end(), sorted[q]);
+            ASSERT_EQ(freq, res.second);
+        }
+    }
+    check_range_top_k(wt, text);
+}
+
+//! Test range_count_2d and range_search_2d of wt
+TEST(WtAsciiRangeTest, WtRangeSearch2d)
+{
+    sdsl::int_vector<8> text = range_test_text(20000);
+    sdsl::wt<unsigned char*, sdsl::rrr_vector<63> > wt((unsigned char*)text.data(), text.size());
+    for (size_type k=0; k < 200; ++k) {
+        size_type lb = rand()%text.size(), rb = std::min(text.size()-1, lb + rand()%3000);
+        unsigned char c1 = 'A' + rand()%45, c2 = c1 + rand()%(k%2 ? 3 : 45); // includes symbols which do not occur
+        std::vector<std::pair<unsigned char, size_type> > expected;
+        for (size_type i=lb; i <= rb; ++i)
+            if (text[i] >= c1 and text[i] <= c2)
+                expected.push_back(std::make_pair(text[i], i));
+        std::sort(expected.begin(), expected.end());
+        ASSERT_EQ(expected.size(), wt.range_count_2d(lb, rb, c1, c2)) << "[" << lb << ".." << rb << "]x[" << c1 << ".." << c2 << "]";
+        size_type max_results = rand()%(expected.size()+2);
+        std::vector<size_type> idx;
+        ASSERT_EQ(std::min(max_results, expected.size()), wt.range_search_2d(lb, rb, c1, c2, idx, max_results));
+        ASSERT_EQ(std::min(max_results, expected.size()), idx.size());
+        for (size_type j=0; j < idx.size(); ++j)
+            ASSERT_EQ(expected[j].second, idx[j]);
+    }
+}
+
+//! Test range_top_k of wt_huff
+TEST(WtAsciiRangeTest, WtHuff)
+{
+    sdsl::int_vector<8> text = range_test_text(20000);
+    sdsl::wt_huff<> wt(text);
+    check_range_top_k(wt, text);
+    sdsl::wt_huff<sdsl::rrr_vector<63> > wt_rrr(text);
+    check_range_top_k(wt_rrr, text);
+}
+
+//! Checks access, rank, select and the batched rank_ith_symbol of wt against text
+template<class Wt>
+void check_wt_on_text(const Wt& wt, const sdsl::int_vector<8>& text)
+{
+    ASSERT_EQ(text.size(), wt.size());
+    std::vector<size_type> cnt(256, 0);
+    std::vector<size_type> idx(text.size()), rank(text.size());
+    std::vector<unsigned char> c(text.size());
+    for (size_type j=0; j < text.size(); ++j) {
+        unsigned char x;
+        ASSERT_EQ((unsigned char)text[j], wt[j]) << " j=" << j;
+        ASSERT_EQ(cnt[text[j]], wt.rank_ith_symbol(j, x)) << " j=" << j;
+        ASSERT_EQ((unsigned char)text[j], x);
+        ASSERT_EQ(cnt[text[j]], wt.rank(j, text[j])) << " j=" << j;
+        ++cnt[text[j]];
+        ASSERT_EQ(j, wt.select(cnt[text[j]], text[j])) << " j=" << j;
+        idx[j] = (j*7919)%text.size();
+    }
+    for (size_type x=0; x < 256; ++x)
+        ASSERT_EQ(cnt[x], wt.rank(wt.size(), (unsigned char)x)) << " x=" << x;
+    wt.rank_ith_symbol(&idx[0], idx.size(), &rank[0], &c[0]);
+    for (size_type j=0; j < idx.size(); ++j) {
+        unsigned char x;
+        ASSERT_EQ(wt.rank_ith_symbol(idx[j], x), rank[j]);
+        ASSERT_EQ(x, c[j]);
+    }
+}
+
+//! Test wt_multiary for all digit widths on texts of different alphabet sizes
+TEST(WtMultiaryTest, AccessRankSelect)
+{
+    size_type sigmas[] = {1, 2, 5, 40, 256};
+    for (size_type s=0; s < sizeof(sigmas)/sizeof(sigmas[0]); ++s) {
+        sdsl::int_vector<8> text(100000);
+        srand(17);
+        for (size_type i=0; i < text.size(); ++i)
+            text[i] = sigmas[s] == 256 ? rand()%256 : 'A' + rand()%sigmas[s];
+        {
+            sdsl::wt_multiary<1> wt(text);
+            check_wt_on_text(wt, text);
+        }
+        {
+            sdsl::wt_multiary<2> wt(text);
+            check_wt_on_text(wt, text);
+        }
+        {
+            sdsl::wt_multiary<4> wt(text);
+            check_wt_on_text(wt, text);
+        }
+        {
+            sdsl::wt_multiary<8> wt(text);
+            check_wt_on_text(wt, text);
+        }
+    }
+}
+
 }  // namespace
 
 int main(int argc, char** argv)
@@ -0,0 +1,131 @@
+#include "sdsl/wt_huff.hpp"
+#include "sdsl/wt_int.hpp"
+#include "sdsl/rrr_vector.hpp"
+#include "sdsl/util.hpp"
+#include "sdsl/config.hpp" // for CMAKE_SOURCE_DIR
+#include "gtest/gtest.h"
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cstdlib> // for rand()
+
+namespace
+{
+
+typedef sdsl::int_vector<>::size_type size_type;
+
+//! Returns the serialization of a data structure, which is used to check bit-identity.
+template<class T>
+std::string serialized(const T& t)
+{
+    std::stringstream ss;
+    t.serialize(ss);
+    return ss.str();
+}
+
+class WtConstructTest : public ::testing::Test
+{
+    protected:
+
+        WtConstructTest() {}
+
+        virtual ~WtConstructTest() {}
+
+        virtual void SetUp() {
+            std::string test_cases_dir = std::string(SDSL_XSTR(CMAKE_SOURCE_DIR)) + "/test/test_cases";
+            const char* files[] = {"/crafted/100a.txt", "/small/faust.txt", "/small/zarathustra.txt"};
+            for (size_t i=0; i < sizeof(files)/sizeof(files[0]); ++i) {
+                char* text = NULL;
+                uint64_t n = sdsl::file::read_text((test_cases_dir + files[i]).c_str(), text);
+                if (n > 1) {
+                    texts.push_back(std::string(text, n-1));
+                }
+                delete [] text;
+            }
+            srand(17);
+            texts.push_back(std::string(200000, 'a'));                             // only one symbol
+            std::string s;
+            for (size_type i=0; i < 300000; ++i) s += (char)('a' + (rand()%64)*(rand()%64)/63); // skewed distribution
+            texts.push_back(s);
+            s.clear();
+            for (size_type i=0; i < 300000; ++i) s += (char)(1 + rand()%255);      // largest alphabet
+            texts.push_back(s);
+            tmp_file = "tmp_wt_construct_test_" + sdsl::util::to_string(sdsl::util::get_pid());
+        }
+
+        std::vector<std::string> texts;
+        std::string tmp_file;
+};
+
+//! Test that the parallel construction of wt_huff produces the same structure as the sequential one
+template<class Wt>
+void test_wt_huff_parallel(const std::vector<std::string>& texts, const std::string& tmp_file)
+{
+    for (size_type i=0; i < texts.size(); ++i) {
+        size_type n = texts[i].size();
+        sdsl::int_vector<8> text(n);
+        for (size_type j=0; j < n; ++j)
+            text[j] = (unsigned char)texts[i][j];
+        ASSERT_TRUE(sdsl::util::store_to_file(text, tmp_file.c_str()));
+        Wt wt(text, n);
+        std::string expected = serialized(wt);
+        uint32_t threads[] = {2, 3, 8};
+        for (size_type t=0; t < 3; ++t) {
+            Wt pwt(text, n, threads[t]);
+            ASSERT_TRUE(expected == serialized(pwt)) << " for text " << i << " with " << threads[t] << " threads";
+            sdsl::int_vector_file_buffer<8> buf(tmp_file.c_str(), 1000);
+            Wt bwt(buf, n, threads[t]);
+            ASSERT_TRUE(expected == serialized(bwt)) << " for buffered text " << i << " with " << threads[t] << " threads";
+            ASSERT_EQ((size_type)1000, buf.buffersize()) << " the buffer size of the caller was changed";
+        }
+    }
+    std::remove(tmp_file.c_str());
+}
+
+TEST_F(WtConstructTest, WtHuffParallel)
+{
+    test_wt_huff_parallel<sdsl::wt_huff<> >(texts, tmp_file);
+}
+
+TEST_F(WtConstructTest, WtHuffRrrParallel)
+{
+    test_wt_huff_parallel<sdsl::wt_huff_rrr>(texts, tmp_file);
+}
+
+//! Test that the parallel construction of wt_int produces the same structure as the sequential one
+TEST_F(WtConstructTest, WtIntParallel)
+{
+    typedef sdsl::wt_int<> tWt;
+    uint8_t widths[] = {1, 4, 13, 18, 40};
+    for (size_type w=0; w < sizeof(widths)/sizeof(widths[0]); ++w) {
+        sdsl::int_vector<> iv(400000, 0, widths[w]);
+        sdsl::util::set_random_bits(iv, 17);
+        for (size_type j=0; j < iv.size()/2; ++j) // a large node in each level
+            iv[j] = iv[j] & 1;
+        ASSERT_TRUE(sdsl::util::store_to_file(iv, tmp_file.c_str()));
+        std::string expected;
+        {
+            sdsl::int_vector_file_buffer<> buf(tmp_file.c_str());
+            tWt wt(buf);
+            expected = serialized(wt);
+            ASSERT_TRUE(expected == serialized(tWt(iv))) << " for width " << (int)widths[w];
+        }
+        uint32_t threads[] = {2, 3, 8};
+        for (size_type t=0; t < 3; ++t) {
+            tWt pwt(iv, 0, threads[t]);
+            ASSERT_TRUE(expected == serialized(pwt)) << " for width " << (int)widths[w] << " with " << threads[t] << " threads";
+            sdsl::int_vector_file_buffer<> buf(tmp_file.c_str());
+            tWt bwt(buf, 0, "./", threads[t]);
+            ASSERT_TRUE(expected == serialized(bwt)) << " for buffered width " << (int)widths[w] << " with " << threads[t] << " threads";
+        }
+    }
+    std::remove(tmp_file.c_str());
+}
+
+}// end namespace
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,4 +1,5 @@
 #include "sdsl/wt_int.hpp"
+#include "sdsl/wt_matrix.hpp"
 #include "sdsl/util.hpp"
 #include "sdsl/rrr_vector.hpp"
 #include "sdsl/sd_vector.hpp"
@@ -6,6 +7,8 @@
 #include <vector>
 #include <cstdlib> // for rand()
 #include <string>
+#include <algorithm>
+#include <utility>
 
 namespace
 {
@@ -46,7 +49,9 @@ using testing::Types;
 typedef Types<
 sdsl::wt_int<>,
      sdsl::wt_int<sdsl::int_vector<>, sdsl::rrr_vector<15> >,
-     sdsl::wt_int<sdsl::int_vector<>, sdsl::rrr_vector<63> >
+     sdsl::wt_int<sdsl::int_vector<>, sdsl::rrr_vector<63> >,
+     sdsl::wt_matrix<>,
+     sdsl::wt_matrix<sdsl::int_vector<>, sdsl::rrr_vector<63> >
      > Implementations;
 
 TYPED_TEST_CASE(WtIntTest, Implementations);
@@ -75,6 +80,207 @@ TYPED_TEST(WtIntTest, Constructor)
     std::remove((this->tmp_file+suffix).c_str());
 }
 
+//! Test rank and select on a sequence over an alphabet which does not fill [0..2^logn-1]
+TYPED_TEST(WtIntTest, RankAndSelect)
+{
+    sdsl::int_vector<> iv(100000, 0, 10);
+    srand(17);
+    for (size_type i=0; i < iv.size(); ++i)
+        iv[i] = (rand()%3 == 0) ? 1000 : rand()%700;
+    TypeParam wt(iv);
+    ASSERT_EQ(iv.size(), wt.size());
+    std::vector<size_type> cnt(1024, 0);
+    for (size_type i=0; i < iv.size(); ++i) {
+        ASSERT_EQ(iv[i], wt[i]) << i;
+        ASSERT_EQ(cnt[iv[i]], wt.rank(i, iv[i])) << i;
+        std::pair<size_type, typename TypeParam::value_type> rc = wt.inverse_select(i);
+        ASSERT_EQ(cnt[iv[i]], rc.first) << i;
+        ASSERT_EQ(iv[i], rc.second) << i;
+        ASSERT_TRUE(rc == sdsl::inverse_select(wt, i)) << i;
+        ++cnt[iv[i]];
+        ASSERT_EQ(i, wt.select(cnt[iv[i]], iv[i])) << i;
+        if (i % 101 == 0) {
+            size_type c = rand()%1024;
+            ASSERT_EQ(cnt[c], wt.rank(i+1, c)) << i << " " << c;
+        }
+    }
+    for (size_type c=0; c < cnt.size(); ++c) {
+        ASSERT_EQ(cnt[c], wt.rank(wt.size(), c)) << c;
+    }
+}
+
+//! Test range_search_2d against a scan of the index interval
+TYPED_TEST(WtIntTest, RangeSearch2d)
+{
+    sdsl::int_vector<> iv(20000, 0, 12);
+    sdsl::util::set_random_bits(iv, 17);
+    TypeParam wt(iv);
+    srand(17);
+    for (size_type k=0; k < 200; ++k) {
+        size_type lb = rand()%iv.size(), rb = std::min(iv.size()-1, lb + rand()%3000);
+        size_type vlb = rand()%4096, vrb = std::min((size_type)4095, vlb + rand()%(k%2 ? 100 : 4096));
+        std::vector<std::pair<size_type, size_type> > expected;
+        for (size_type i=lb; i <= rb; ++i) {
+            if (iv[i] >= vlb and iv[i] <= vrb)
+                expected.push_back(std::make_pair(i, iv[i]));
+        }
+        std::vector<size_type> idx, val;
+        ASSERT_EQ(expected.size(), wt.range_search_2d(lb, rb, vlb, vrb, &idx, &val));
+        ASSERT_EQ(expected.size(), idx.size());
+        ASSERT_EQ(expected.size(), val.size());
+        std::vector<std::pair<size_type, size_type> > result;
+        for (size_type j=0; j < idx.size(); ++j)
+            result.push_back(std::make_pair(idx[j], val[j]));
+        std::sort(result.begin(), result.end());
+        ASSERT_TRUE(expected == result) << "[" << lb << ".." << rb << "]x[" << vlb << ".." << vrb << "]";
+    }
+}
+
+//! A reporter for range_report_2d which sums up the indices and values
+struct sum_report {
+    size_type idx_sum, val_sum;
+    sum_report():idx_sum(0), val_sum(0) {}
+    void operator()(size_type i, size_type v) {
+        idx_sum += i; val_sum += v;
+    }
+};
+
+//! Test range_count_2d, the bounded range_search_2d, and range_report_2d against a scan of the index interval
+TYPED_TEST(WtIntTest, RangeCountAndReport2d)
+{
+    sdsl::int_vector<> iv(20000, 0, 12);
+    sdsl::util::set_random_bits(iv, 17);
+    TypeParam wt(iv);
+    srand(17);
+    for (size_type k=0; k < 200; ++k) {
+        size_type lb = rand()%iv.size(), rb = std::min(iv.size()-1, lb + rand()%3000);
+        size_type vlb = rand()%4096, vrb = std::min((size_type)4095, vlb + rand()%(k%2 ? 100 : 4096));
+        std::vector<std::pair<size_type, size_type> > expected; // sorted by value, then index
+        size_type idx_sum = 0, val_sum = 0;
+        for (size_type i=lb; i <= rb; ++i) {
+            if (iv[i] >= vlb and iv[i] <= vrb) {
+                expected.push_back(std::make_pair(iv[i], i));
+                idx_sum += i; val_sum += iv[i];
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+        ASSERT_EQ(expected.size(), wt.range_count_2d(lb, rb, vlb, vrb)) << "[" << lb << ".." << rb << "]x[" << vlb << ".." << vrb << "]";
+        ASSERT_EQ(expected.size(), wt.range_search_2d(lb, rb, vlb, vrb));
+
+        size_type max_results = rand()%(expected.size()+2);
+        std::vector<size_type> idx, val;
+        ASSERT_EQ(std::min(max_results, expected.size()), wt.range_search_2d(lb, rb, vlb, vrb, &idx, &val, max_results));
+        ASSERT_EQ(std::min(max_results, expected.size()), idx.size());
+        for (size_type j=0; j < idx.size(); ++j) {
+            ASSERT_EQ(expected[j].second, idx[j]);
+            ASSERT_EQ(expected[j].first, val[j]);
+        }
+        val.clear();
+        ASSERT_EQ(std::min(max_results, expected.size()), wt.range_search_2d(lb, rb, vlb, vrb, NULL, &val, max_results));
+        for (size_type j=0; j < val.size(); ++j)
+            ASSERT_EQ(expected[j].first, val[j]);
+
+        sum_report report;
+        ASSERT_EQ(expected.size(), wt.range_report_2d(lb, rb, vlb, vrb, report));
+        ASSERT_EQ(idx_sum, report.idx_sum);
+        ASSERT_EQ(val_sum, report.val_sum);
+    }
+}
+
+//! Test range_quantile against sorting the index interval
+TYPED_TEST(WtIntTest, RangeQuantile)
+{
+    sdsl::int_vector<> iv(20000, 0, 8);
+    sdsl::util::set_random_bits(iv, 17);
+    TypeParam wt(iv);
+    srand(17);
+    for (size_type k=0; k < 200; ++k) {
+        size_type lb = rand()%iv.size(), rb = std::min(iv.size()-1, lb + rand()%3000);
+        std::vector<size_type> sorted(iv.begin()+lb, iv.begin()+rb+1);
+        std::sort(sorted.begin(), sorted.end());
+        for (size_type j=0; j < 10; ++j) {
+            size_type q = rand()%(rb-lb+1);
+            std::pair<size_type, size_type> res = wt.range_quantile(lb, rb, q);
+            ASSERT_EQ(sorted[q], res.first) << "q=" << q << " in [" << lb << ".." << rb << "]";
+            size_type freq = std::upper_bound(sorted.begin(), sorted.end(), sorted[q])
+                             - std::lower_bound(sorted.begin(), sorted.end(), sorted[q]);
+            ASSERT_EQ(freq, res.second);
+        }
+    }
+}
+
+//! Test range_top_k against counting the values of the index interval
+TYPED_TEST(WtIntTest, RangeTopK)
+{
+    sdsl::int_vector<> iv(20000, 0, 6);
+    srand(17);
+    for (size_type i=0; i < iv.size(); ++i)
+        iv[i] = (rand()%64) * (rand()%64) / 64; // skewed distribution
+    TypeParam wt(iv);
+    for (size_type k=0; k < 200; ++k) {
+        size_type lb = rand()%iv.size(), rb = std::min(iv.size()-1, lb + rand()%3000);
+        std::vector<size_type> cnt(64, 0);
+        for (size_type i=lb; i <= rb; ++i)
+            ++cnt[iv[i]];
+        size_type distinct = 64 - std::count(cnt.begin(), cnt.end(), (size_type)0);
+        size_type kk = 1 + rand()%70;
+        std::vector<std::pair<size_type, size_type> > res;
+        wt.range_top_k(lb, rb, kk, res);
+        ASSERT_EQ(std::min(kk, distinct), res.size());
+        for (size_type j=0; j < res.size(); ++j) {
+            ASSERT_EQ(cnt[res[j].first], res[j].second) << "value " << res[j].first;
+            if (j > 0) {
+                ASSERT_LE(res[j].second, res[j-1].second);
+            }
+            cnt[res[j].first] = 0; // reported values are removed
+        }
+        if (!res.empty()) {  // no value which was not reported is more frequent than the last result
+            ASSERT_LE(*std::max_element(cnt.begin(), cnt.end()), res.back().second);
+        }
+    }
+}
+
+//! Test range_next_value against a scan of the index interval
+TYPED_TEST(WtIntTest, RangeNextValue)
+{
+    sdsl::int_vector<> iv(20000, 0, 12);
+    sdsl::util::set_random_bits(iv, 17);
+    TypeParam wt(iv);
+    srand(17);
+    for (size_type k=0; k < 500; ++k) {
+        size_type lb = rand()%iv.size(), rb = std::min(iv.size()-1, lb + rand()%(k%2 ? 10 : 1000));
+        size_type x = rand()%4200, expected = 4096;
+        for (size_type i=lb; i <= rb; ++i)
+            if (iv[i] >= x and iv[i] < expected)
+                expected = iv[i];
+        size_type y = 0;
+        bool found = wt.range_next_value(lb, rb, x, y);
+        ASSERT_EQ(expected < 4096, found) << "x=" << x << " in [" << lb << ".." << rb << "]";
+        if (found) {
+            ASSERT_EQ(expected, y) << "x=" << x << " in [" << lb << ".." << rb << "]";
+        }
+    }
+}
+
+//! Test that storing and loading preserves the structure
+TYPED_TEST(WtIntTest, StoreAndLoad)
+{
+    sdsl::int_vector<> iv(10000, 0, 20);
+    sdsl::util::set_random_bits(iv, 17);
+    TypeParam wt(iv);
+    std::string file = this->tmp_file + "store";
+    ASSERT_TRUE(sdsl::util::store_to_file(wt, file.c_str()));
+    TypeParam wt2;
+    ASSERT_TRUE(sdsl::util::load_from_file(wt2, file.c_str()));
+    std::remove(file.c_str());
+    ASSERT_EQ(wt.size(), wt2.size());
+    ASSERT_EQ(wt.sigma, wt2.sigma);
+    for (size_type i=0; i < iv.size(); ++i) {
+        ASSERT_EQ(iv[i], wt2[i]) << i;
+        ASSERT_EQ(i, wt2.select(wt2.rank(i+1, iv[i]), iv[i])) << i;
+    }
+}
+
 }  // namespace
 
 int main(int argc, char** argv)